@@ -0,0 +1,105 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : BIST PRBS generator and checker
+//  File name   : bist_prbs.v
+//  Note        : PRBS31 (x^31 + x^28 + 1), 32 bits per clock, bit 0 first.
+//                The generator advances on tx_en. The checker predicts
+//                every received data Dword from the previous one, so it
+//                needs no seed and locks on whatever the far end returns;
+//                primitives (rx_charisk) are skipped. After 32 good Dwords
+//                in a row the checker is locked and from then on every
+//                mismatching Dword is counted in err_count.
+//  Design ref. : SATA3 Specification, BIST Activate FIS
+//  Dependencies   : Nil
+//////////////////////////////////////////////////////////////////////////////
+
+module bist_prbs (
+    input              clk,
+    input              rst,
+    input              tx_en,          // advance the transmit pattern
+    output reg [31:0]  tx_data,        // current transmit Dword
+    input              rx_en,          // checker enabled, clearing it clears the counters
+    input      [31:0]  rx_data,
+    input              rx_charisk,
+    output reg [31:0]  word_count,     // Dwords checked while locked
+    output reg [31:0]  err_count,      // mismatching Dwords while locked
+    output reg         locked
+    );
+
+  reg  [31:0]  rx_prev;
+  reg          rx_prev_vld;
+  reg   [5:0]  good_run;
+
+  wire         rx_vld;
+  wire         rx_good;
+
+  function [31:0] prbs31_next;
+    input [31:0] cur;
+    integer      i;
+    reg   [63:0] s;
+    begin
+      s = {32'h0, cur};
+      for (i = 32; i < 64; i = i + 1) begin
+        s[i] = s[i-31] ^ s[i-28];
+      end
+      prbs31_next = s[63:32];
+    end
+  endfunction
+
+  //transmit
+  always @(posedge clk, posedge rst)
+  begin
+    if (rst) begin
+      tx_data <= 32'hFFFF_FFFF;
+    end
+    else if (tx_en) begin
+      tx_data <= prbs31_next(tx_data);
+    end
+  end
+
+  //receive
+  assign rx_vld  = rx_en && !rx_charisk;
+  assign rx_good = (rx_data == prbs31_next(rx_prev));
+
+  always @(posedge clk, posedge rst)
+  begin
+    if (rst) begin
+      rx_prev     <= 32'h0;
+      rx_prev_vld <= 1'b0;
+      good_run    <= 6'h0;
+      locked      <= 1'b0;
+      word_count  <= 32'h0;
+      err_count   <= 32'h0;
+    end
+    else if (!rx_en) begin
+      rx_prev_vld <= 1'b0;
+      good_run    <= 6'h0;
+      locked      <= 1'b0;
+      word_count  <= 32'h0;
+      err_count   <= 32'h0;
+    end
+    else if (rx_vld) begin
+      rx_prev     <= rx_data;
+      rx_prev_vld <= 1'b1;
+      if (rx_prev_vld) begin
+        if (locked) begin
+          word_count <= word_count + 1;
+          if (!rx_good) begin
+            err_count <= err_count + 1;
+          end
+        end
+        else if (!rx_good) begin
+          good_run <= 6'h0;
+        end
+        else if (good_run == 6'd31) begin
+          locked   <= 1'b1;
+        end
+        else begin
+          good_run <= good_run + 1;
+        end
+      end
+    end
+  end
+
+endmodule
@@ -86,4 +86,6 @@
    
    `define L_InsertAlign1 6'h 21
    `define L_InsertAlign2 6'h 22
+   
+   `define L_BIST         6'h 23
    
\ No newline at end of file
@@ -76,7 +76,11 @@ module link_layer#(
     output reg         R_OK_SENT_T,     // R_OK sent to PHY
     output reg         data_in_rd_en_t, // read enable to transport layer                   
     output reg         X_RDY_SENT_T,    // activate after sending X_RDY primitive.
-    output reg         DMA_TERMINATED   // DMA Terminated
+    output reg         DMA_TERMINATED,  // DMA Terminated
+    input              BIST_ACTIVE,     // BIST Activate FIS accepted by the device, send PRBS31 and check the returned stream
+    output     [31:0]  BIST_WORDS,      // Dwords checked by the BIST checker
+    output     [31:0]  BIST_ERRORS,     // mismatching Dwords
+    output             BIST_LOCK        // BIST checker locked to the returned pattern
     );
 
 
@@ -114,10 +118,16 @@ module link_layer#(
   reg         data_out_vld_t_int;
   reg  [31:0] data_out_p_int;
   reg   [7:0] count_for_align;
-  reg   [3:0] align_inserted_cnt;
-  reg  [32:0] data_out_p_pipe1;
-  reg  [32:0] data_out_p_pipe2;
-  reg  [32:0] data_out_p_pipe3;
+  reg   [5:0] tx_state_d1;
+  reg         tx_in_drop;
+  reg  [32:0] skid0;
+  reg  [32:0] skid1;
+  reg  [32:0] skid2;
+  reg   [1:0] skid_cnt;
+  wire        align_slot;
+  wire [32:0] tx_in;
+  wire        fsm_hold;
+  wire        fsm_prim;
   reg         cntrl_char_int;
   reg         data_in_rd_last_word;
   reg         minimum_send_two_sync;
@@ -139,6 +149,8 @@ module link_layer#(
   wire        data_vld_temp;
   reg         data_out_vld_t_int_d1;
   reg [1:0]   data_valid_state;
+  wire [31:0] bist_tx_data;
+  wire        bist_tx_en;
   
   localparam   FIRST_STATE  = 2'b00;
   localparam   SECOND_STATE = 2'b01;
@@ -166,92 +178,82 @@ module link_layer#(
     end    
   end
   
-  //data piping for ALIGN primitive after every 256 non ALING DWords
-  always @(posedge clk, posedge rst)                                                      
-  begin                                                                                   
-    if (rst) begin
-      data_out_p_pipe1 <= 33'h0;
-      data_out_p_pipe2 <= 33'h0;
-      data_out_p_pipe3 <= 33'h0;
-    end      
+  //Elastic output stage for the ALIGN pair sent after every 256 Dwords.
+  //The FSM output goes to the PHY through this one register; only the
+  //Dwords produced while the ALIGN pair is on the wire are queued in a
+  //three entry skid buffer. While the buffer is in use a Dword the FSM
+  //did not advance on is not queued : the hold at count 00/01 of
+  //L_SendData, L_RcvrHold, L_SendHold and L_BIST, or a primitive repeated
+  //by a state that stayed put. The buffer so drains on the FSM hold and no
+  //latency is left once the ALIGN pair is out. SOF, frame data, CRC, EOF
+  //and BIST Dwords are always queued, whatever their value.
+  assign align_slot = (count_for_align == 8'hFE) || (count_for_align == 8'hFF);
+  assign tx_in      = {cntrl_char_int, data_out_p_int};
+  assign fsm_hold   = ((count_for_align == 8'h00) || (count_for_align == 8'h01)) &&
+                      ((state == `L_SendData) || (state == `L_RcvrHold) || (state == `L_SendHold) || (state == `L_BIST));
+  assign fsm_prim   = (state != `L_SendSOF) && (state != `L_SendData) && (state != `L_SendCRC) &&
+                      (state != `L_SendEOF) && (state != `L_BIST);
+
+  //tx_in_drop is set with the FSM output it refers to
+  always @(posedge clk, posedge rst)
+  begin
+    if (rst) begin
+      tx_state_d1 <= 6'h0;
+      tx_in_drop  <= 0;
+    end
     else begin
-      data_out_p_pipe1 <= {cntrl_char_int, data_out_p_int[31:0]};
-      data_out_p_pipe2 <= data_out_p_pipe1;
-      data_out_p_pipe3 <= data_out_p_pipe2;
-    end    
+      tx_state_d1 <= state;
+      tx_in_drop  <= fsm_hold || (fsm_prim && (state == tx_state_d1));
+    end
   end
-  
-  
-  //Shameer: Inseritng ALIGN primitive after every 256 non ALIGN DWords
-  always @(posedge clk, posedge rst)
-  begin                                                                                   
-    if (rst) begin
-      data_out_p         <= 32'h0;
-      cntrl_char         <= 0;
-      align_inserted_cnt <= 4'h 0;
-    end      
+
+  always @(posedge clk, posedge rst)
+  begin
+    if (rst) begin
+      data_out_p <= 32'h0;
+      cntrl_char <= 0;
+      skid0      <= 33'h0;
+      skid1      <= 33'h0;
+      skid2      <= 33'h0;
+      skid_cnt   <= 2'd0;
+    end
     else begin
-      if (count_for_align == 8'h FE) begin
-        data_out_p         <= `ALIGN;
-        cntrl_char         <= 1;
-        align_inserted_cnt <= align_inserted_cnt + 1;
+      if (align_slot) begin
+        data_out_p <= `ALIGN;
+        cntrl_char <= 1;
+        if (!tx_in_drop) begin
+          case (skid_cnt)
+            2'd0   : begin skid0 <= tx_in; skid_cnt <= 2'd1; end
+            2'd1   : begin skid1 <= tx_in; skid_cnt <= 2'd2; end
+            2'd2   : begin skid2 <= tx_in; skid_cnt <= 2'd3; end
+            default: begin skid_cnt <= skid_cnt; end
+          endcase
+        end
       end
-      else if (count_for_align == 8'h FF) begin
-        data_out_p         <= `ALIGN;
-        cntrl_char         <= 1;
-        align_inserted_cnt <= align_inserted_cnt + 1;
+      else if (skid_cnt == 2'd0) begin
+        data_out_p <= data_out_p_int;
+        cntrl_char <= cntrl_char_int;
       end
       else begin
-        case (align_inserted_cnt)
-          8'h00: begin
-            data_out_p <= data_out_p_int;
-            cntrl_char <= cntrl_char_int;
-          end
-          8'h01: begin
-            if (data_out_p_pipe2 == data_out_p_pipe1) begin
-              data_out_p         <= data_out_p_int;
-              cntrl_char         <= cntrl_char_int;
-              align_inserted_cnt <= align_inserted_cnt - 1;
-            end
-            else begin
-              data_out_p         <= data_out_p_pipe1[31:0];
-              cntrl_char         <= data_out_p_pipe1[32];
-              align_inserted_cnt <= align_inserted_cnt;
-            end
-          end
-          8'h02: begin
-            if ((data_out_p_pipe3 == data_out_p_pipe2) && (data_out_p_pipe2 == data_out_p_pipe1)) begin
-              data_out_p         <= data_out_p_int;
-              cntrl_char         <= cntrl_char_int;
-              align_inserted_cnt <= align_inserted_cnt - 2;
-            end
-            else if (data_out_p_pipe3 == data_out_p_pipe2 && data_out_p_pipe2[32] == 1) begin
-              data_out_p         <= data_out_p_pipe2[31:0];
-              cntrl_char         <= data_out_p_pipe2[32];
-              align_inserted_cnt <= align_inserted_cnt;
-            end
-            else if (data_out_p_pipe3 == data_out_p_pipe2 && data_out_p_pipe2[32] == 0) begin
-              data_out_p         <= data_out_p_pipe1[31:0];
-              cntrl_char         <= data_out_p_pipe1[32];
-              align_inserted_cnt <= align_inserted_cnt - 1;
-            end
-            else begin
-              data_out_p         <= data_out_p_pipe2[31:0];
-              cntrl_char         <= data_out_p_pipe2[32];
-              align_inserted_cnt <= align_inserted_cnt;
-            end
-          end
-        default: begin
-          align_inserted_cnt <= 4'h2;
-          data_out_p         <= data_out_p_pipe3[31:0];
-          cntrl_char         <= data_out_p_pipe3[32];
-        end  
-        endcase
+        data_out_p <= skid0[31:0];
+        cntrl_char <= skid0[32];
+        skid0      <= skid1;
+        skid1      <= skid2;
+        if (tx_in_drop) begin
+          skid_cnt <= skid_cnt - 1'b1;
+        end
+        else begin
+          case (skid_cnt)
+            2'd1   : skid0 <= tx_in;
+            2'd2   : skid1 <= tx_in;
+            default: skid2 <= tx_in;
+          endcase
+        end
       end
-    end    
+    end
   end
-  
-
+  
+
   //Shameer: to handle CONTp Primitive 
 //  always @(posedge clk, posedge rst)                                                      
 //  begin                                                                                   
@@ -385,6 +387,10 @@ module link_layer#(
             state                 <= `L_IDLE;
             minimum_send_two_sync <= 1;
           end
+          else if (BIST_ACTIVE) begin
+            state <= `L_BIST;
+            minimum_send_two_sync <= 0;
+          end
           else if (rx_charisk_in_int && (data_in_p_int == `X_RDY)) begin
             state <= `L_RcvWaitFifo;
             minimum_send_two_sync <= 0;
@@ -1766,9 +1772,42 @@ module link_layer#(
           state     <= `L_NoCommErr;
         end
       end                   // state : L_BadEnd
+
+      /******************************* end L_BadEnd *************************/
+
+      /******************************* start L_BIST *************************/
+
+      // BIST : PRBS31 data Dwords until the T-layer leaves BIST (COMRESET),
+      // held like frame data after the ALIGN pair
+      `L_BIST:
+      begin
+        if (bist_tx_en) begin
+          data_out_p_int <= bist_tx_data;
+          cntrl_char_int <= 1'b 0;
+        end
+        
+        data_in_rd_en_t <= 0;
+        R_OK_T          <= 0;
+        R_ERR_T         <= 0;
+        rx_fail_T       <= 0;
+        tx_crc_en       <= 0;
+        crc_tx_rst      <= 0;
+        X_RDY_SENT_T    <= 0;
+        illegal_state_t <= 0;
+        
+        if (!PHYRDY) begin
+          state <= `L_NoCommErr;
+        end
+        else if (!BIST_ACTIVE) begin
+          state <= `L_IDLE;
+        end
+        else begin
+          state <= `L_BIST;
+        end
+      end                   // state : L_BIST
       endcase
        
-  /********************************* end L_BadEnd ***********************/
+  /********************************* end L_BIST *************************/
 
   /**********************************************************************/
   /****************************** END RECIEVE ***************************/
@@ -1822,6 +1861,21 @@ module link_layer#(
             .crc_out   (data_crc_out_rx),                           
             .CRC_cal_ip(               )                                 
                                        );   
+
+  assign bist_tx_en = (state == `L_BIST) && count_for_align != 8'h00 && count_for_align != 8'h01;
+
+  bist_prbs bist_prbs_i (
+            .clk        (clk               ),
+            .rst        (rst               ),
+            .tx_en      (bist_tx_en        ),
+            .tx_data    (bist_tx_data      ),
+            .rx_en      (state == `L_BIST  ),
+            .rx_data    (data_in_p_int     ),
+            .rx_charisk (rx_charisk_in_int ),
+            .word_count (BIST_WORDS        ),
+            .err_count  (BIST_ERRORS       ),
+            .locked     (BIST_LOCK         )
+                                       );
                                   
   always @(posedge clk, posedge rst)                                                      
   begin                                                                                   
@@ -220,7 +220,11 @@ module sata_link #(
     .R_OK_SENT_T      (R_OK_SENT_T),
     .data_in_rd_en_t  (DATA_IN_RD_EN_T),
     .X_RDY_SENT_T     (X_RDY_SENT_T),
-    .DMA_TERMINATED   (DMA_TERMINATED)
+    .DMA_TERMINATED   (DMA_TERMINATED),
+    .BIST_ACTIVE      (1'b0),
+    .BIST_WORDS       (),
+    .BIST_ERRORS      (),
+    .BIST_LOCK        ()
   );
   
 endmodule
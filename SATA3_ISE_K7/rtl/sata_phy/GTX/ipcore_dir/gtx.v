@@ -89,6 +89,8 @@
     input           GT0_DRPEN_IN,
     output          GT0_DRPRDY_OUT,
     input           GT0_DRPWE_IN,
+    //------------------------------- Loopback Ports -----------------------------
+    input   [2:0]   GT0_LOOPBACK_IN,
     //----------------------------- Clocking Ports -----------------------------
     input   [1:0]   GT0_TXSYSCLKSEL_IN,
     //--------------------------- PCI Express Ports ----------------------------
@@ -247,6 +249,8 @@
         .DRPEN_IN                       (GT0_DRPEN_IN),
         .DRPRDY_OUT                     (GT0_DRPRDY_OUT),
         .DRPWE_IN                       (GT0_DRPWE_IN),
+        //------------------------------- Loopback Ports -----------------------------
+        .LOOPBACK_IN                    (GT0_LOOPBACK_IN),
         //----------------------------- Clocking Ports -----------------------------
         .QPLLCLK_IN                     (gt0_qpllclk_i),
         .QPLLREFCLK_IN                  (gt0_qpllrefclk_i),
@@ -61,7 +61,9 @@ module OOB_control (
   rx_eof_det_out,       // End Of Frame primitive detected
   gt0_rxresetdone_i,    // rx fsm reaet done
   gt0_txresetdone_i,    // tx fsm reset done
-  gtx_rx_reset_out      // rx reset out
+  gtx_rx_reset_out,     // rx reset out
+  loopback,             // near-end loopback, skip COMRESET/COMWAKE
+  hotplug_en            // re-run OOB from link_ready on COMINIT / hot unplug
 );
 
   input             clk;
@@ -79,6 +81,8 @@ module OOB_control (
   input      [1:0]  gen;
   input             gt0_rxresetdone_i;
   input             gt0_txresetdone_i;
+  input             loopback;
+  input             hotplug_en;
 
   output            txcominit;
   output            txcomwake;
@@ -161,7 +165,7 @@ module OOB_control (
   end
 
 always @ (CurrentState or count or cominitdet or comwakedet or rxelecidle or rx_locked or align_det or sync_det or gen 
-          or gt0_txresetdone_i or gt0_rxresetdone_i or gtxreset_cnt_400)
+          or gt0_txresetdone_i or gt0_rxresetdone_i or gtxreset_cnt_400 or loopback or hotplug_en or sync_stable)
 begin : SM_mux
   count_en          = 1'b0;
   NextState         = host_comreset;//gtx_reset;
@@ -178,7 +182,11 @@ begin : SM_mux
     
     
     host_comreset : begin
-      if (rx_locked && gt0_txresetdone_i && gt0_rxresetdone_i) begin 
+      if (rx_locked && gt0_txresetdone_i && gt0_rxresetdone_i && loopback) begin
+        // no OOB signalling through the loopback path, go to speed setting
+        NextState   = host_d10_2;
+      end
+      else if (rx_locked && gt0_txresetdone_i && gt0_rxresetdone_i) begin 
         if ((gen == 2'b10 && count == 18'h00144) || (gen == 2'b01 && count == 18'h000A2) || (gen == 2'b00 && count == 18'h00051)) begin
           txcominit_r = 1'b0; 
           NextState   = wait_dev_cominit;
@@ -323,15 +331,29 @@ begin : SM_mux
     begin
       txelecidle_r = 1'b0;
       gtx_rx_reset_out = 1'b0;
-      if (sync_stable) //rxelecidle
+      if (hotplug_en && cominitdet)
+      begin
+        // device initiated COMINIT (device reset or hot plug), answer with
+        // COMWAKE at the current speed, the GTX and user clocks stay up
+        NextState = host_comwake;
+      end
+      else if (hotplug_en && !loopback && rxelecidle && count == 18'h01000)
+      begin
+        // RX idle for ~27 us at GEN3 (~110 us at GEN1) : device removed,
+        // keep sending COMRESET until a device answers
+        NextState = host_comreset;
+      end
+      else if (sync_stable) //rxelecidle
       begin
         NextState = link_ready;
         linkup_r  = 1'b1;
+        count_en  = hotplug_en && rxelecidle;
       end
       else
       begin
         NextState        = link_ready; //link_ready2;
         linkup_r         = 1'b0;
+        count_en         = hotplug_en && rxelecidle;
       end
     end
    
@@ -376,6 +398,11 @@ begin : count_sync_primitve
     count_sync  <= 8'b0;
     sync_stable <= 1'b0;
   end 
+  else if(CurrentState != host_send_align && CurrentState != link_ready) begin
+    // OOB restarted, linkup is qualified again after the next SYNC run
+    count_sync  <= 8'b0;
+    sync_stable <= 1'b0;
+  end
   else if(count_sync > 8'h32) begin  //8'd50
     sync_stable <= 1'b1;
   end
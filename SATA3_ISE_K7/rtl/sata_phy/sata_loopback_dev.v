@@ -0,0 +1,210 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : Loopback device responder
+//  File name   : sata_loopback_dev.v
+//  Note        : Minimal device side link for the PHY near-end loopback
+//                mode. It watches the host stream coming back from the GTX
+//                and produces the stream a device would send, which
+//                sata_phy feeds to OOB_control instead of the GTX receive
+//                data :
+//                  ALIGN until the host sends ALIGN, then SYNC,
+//                  X_RDY -> R_RDY, SOF -> R_IP (HOLDA on HOLD),
+//                  EOF -> R_OK / R_ERR until the host returns to SYNC.
+//                Frame data is descrambled and the CRC (last Dword of the
+//                frame) is checked, so host writes complete with good
+//                status at line rate and no drive attached. Device to host
+//                frames are never sent.
+//                A good BIST Activate FIS with the L or F bit set switches
+//                the responder to echo the host stream back, so the PRBS
+//                checker of the link layer sees its own pattern. Echo is
+//                left on reset only.
+//  Design ref. : SATA3 Specification, Link layer device FSM
+//  Dependencies   : scrambler.v, crc.v
+//////////////////////////////////////////////////////////////////////////////
+
+`include "../sata_link/defines.h"
+
+module sata_loopback_dev (
+    input              clk,
+    input              reset,
+    input      [31:0]  host_data,        // host stream from the GTX receiver
+    input      [3:0]   host_charisk,
+    output reg [31:0]  dev_data,         // device stream to OOB_control
+    output reg [3:0]   dev_charisk,
+    output reg [31:0]  frame_count,      // frames received with good CRC
+    output reg [31:0]  crc_err_count     // frames received with bad CRC
+    );
+
+  parameter [2:0]
+  D_ALIGN   = 3'h0,
+  D_IDLE    = 3'h1,
+  D_RDY     = 3'h2,
+  D_RCV     = 3'h3,
+  D_STATUS  = 3'h4,
+  D_ECHO    = 3'h5;
+
+  reg   [2:0]  state;
+  reg  [31:0]  prev_dword;        // last descrambled Dword, the CRC at EOF
+  reg          prev_vld;
+  reg  [31:0]  fis_dw0;
+  reg          first_dword;
+  reg          crc_rst;
+  reg          crc_good;
+  reg          bist_loop;
+
+  wire         prim;
+  wire         data_vld;
+  wire [31:0]  descr_data;
+  wire [31:0]  crc_calc;
+
+  assign prim     = host_charisk[0];
+  assign data_vld = (state == D_RCV) && !prim;
+
+  //******** device primitive / echo output ****
+  always @(posedge clk, posedge reset)
+  begin
+    if (reset) begin
+      dev_data    <= `ALIGN;
+      dev_charisk <= 4'b0001;
+    end
+    else begin
+      case (state)
+        D_ALIGN : begin
+          dev_data    <= `ALIGN;
+          dev_charisk <= 4'b0001;
+        end
+        D_RDY : begin
+          dev_data    <= `R_RDY;
+          dev_charisk <= 4'b0001;
+        end
+        D_RCV : begin
+          dev_data    <= (prim && host_data == `HOLD) ? `HOLDA : `R_IP;
+          dev_charisk <= 4'b0001;
+        end
+        D_STATUS : begin
+          dev_data    <= crc_good ? `R_OK : `R_ERR;
+          dev_charisk <= 4'b0001;
+        end
+        D_ECHO : begin
+          dev_data    <= host_data;
+          dev_charisk <= host_charisk;
+        end
+        default : begin
+          dev_data    <= `SYNC;
+          dev_charisk <= 4'b0001;
+        end
+      endcase
+    end
+  end
+
+  //******** device link FSM ****
+  always @(posedge clk, posedge reset)
+  begin
+    if (reset) begin
+      state         <= D_ALIGN;
+      prev_dword    <= 32'h0;
+      prev_vld      <= 1'b0;
+      fis_dw0       <= 32'h0;
+      first_dword   <= 1'b0;
+      crc_rst       <= 1'b0;
+      crc_good      <= 1'b0;
+      bist_loop     <= 1'b0;
+      frame_count   <= 32'h0;
+      crc_err_count <= 32'h0;
+    end
+    else begin
+      crc_rst <= 1'b0;
+      case (state)
+        D_ALIGN : begin
+          if (prim && host_data == `ALIGN) begin
+            state <= D_IDLE;
+          end
+        end
+
+        D_IDLE : begin
+          if (bist_loop) begin
+            state <= D_ECHO;
+          end
+          else if (prim && host_data == `X_RDY) begin
+            state <= D_RDY;
+          end
+        end
+
+        D_RDY : begin
+          if (prim && host_data == `SOF) begin
+            prev_vld    <= 1'b0;
+            first_dword <= 1'b1;
+            crc_rst     <= 1'b1;
+            state       <= D_RCV;
+          end
+          else if (prim && host_data == `SYNC) begin
+            state <= D_IDLE;
+          end
+        end
+
+        D_RCV : begin
+          if (data_vld) begin
+            prev_dword  <= descr_data;
+            prev_vld    <= 1'b1;
+            first_dword <= 1'b0;
+            if (first_dword) begin
+              fis_dw0 <= descr_data;
+            end
+          end
+          else if (prim && host_data == `EOF) begin
+            crc_good <= prev_vld && (prev_dword == crc_calc);
+            if (prev_vld && (prev_dword == crc_calc)) begin
+              frame_count <= frame_count + 1;
+              // BIST Activate FIS, far end retimed (L) or analog (F) loopback
+              if (fis_dw0[7:0] == 8'h58 && (fis_dw0[20] || fis_dw0[19])) begin
+                bist_loop <= 1'b1;
+              end
+            end
+            else begin
+              crc_err_count <= crc_err_count + 1;
+            end
+            state <= D_STATUS;
+          end
+          else if (prim && host_data == `SYNC) begin
+            state <= D_IDLE;
+          end
+        end
+
+        D_STATUS : begin
+          if (prim && host_data == `SYNC) begin
+            state <= D_IDLE;
+          end
+        end
+
+        D_ECHO : begin
+          state <= D_ECHO;
+        end
+
+        default : begin
+          state <= D_ALIGN;
+        end
+      endcase
+    end
+  end
+
+  //******** descrambler and CRC check ****
+  scrambler descrambler_i (
+            .data_in   (host_data                   ),
+            .scram_en  (data_vld                    ),
+            .scram_rst (prim && host_data == `SOF   ),
+            .rst       (reset                       ),
+            .clk       (clk                         ),
+            .data_c    (descr_data                  )
+                                                    );
+
+  crc crc_i (
+            .data_in   (prev_dword                  ),
+            .crc_en    (data_vld && prev_vld        ),
+            .rst       (reset || crc_rst            ),
+            .clk       (clk                         ),
+            .crc_out   (crc_calc                    ),
+            .CRC_cal_ip(                            )
+                                                    );
+
+endmodule
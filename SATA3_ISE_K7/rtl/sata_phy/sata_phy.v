@@ -5,7 +5,8 @@ module sata_phy #
     parameter  WRAPPER_SIM_GTRESET_SPEEDUP    =   "FALSE",   // Set to "true" to speed up sim reset
     parameter  SIM_VERSION                    =   "4.0",     
     parameter  EQ_MODE                        =   "DFE",     // Rx Equalization Mode - Set to DFE or LPM
-    parameter  EXAMPLE_SIMULATION             =    0 
+    parameter  EXAMPLE_SIMULATION             =    0,
+    parameter  FIXED_GEN                      =    0          // 0 : negotiate, 1 / 2 / 3 : GEN1 / GEN2 / GEN3 only
   )
 
   (
@@ -29,7 +30,17 @@ module sata_phy #
     logic_reset,
     OOB_reset_IN,
     RX_FSM_reset_IN,
-		TX_FSM_reset_IN
+		TX_FSM_reset_IN,
+    LOOPBACK_MODE,
+    LB_FRAME_COUNT,
+    LB_CRC_ERR_COUNT,
+    GEN_HINT_EN,
+    GEN_HINT,
+    HOTPLUG_EN,
+    SPEED_POLICY_EN,
+    CRC_ERR_IN,
+    R_ERR_IN,
+    RATE_LOG
   );
 
   input           TILE0_REFCLK_PAD_P_IN;      // GTP reference clock input
@@ -42,6 +53,13 @@ module sata_phy #
   input           OOB_reset_IN;
   input           RX_FSM_reset_IN;	
   input           TX_FSM_reset_IN;	
+  input  [1:0]    LOOPBACK_MODE;              // 00 normal, 01 near-end PCS, 10 near-end PMA loopback
+  input           GEN_HINT_EN;                // first link attempt at GEN_HINT instead of GEN3
+  input  [1:0]    GEN_HINT;
+  input           HOTPLUG_EN;                 // COMINIT / hot plug re-link without a GTX reset
+  input           SPEED_POLICY_EN;            // downshift on link errors, see speed_policy
+  input           CRC_ERR_IN;                 // link layer CRC error (logic_clk)
+  input           R_ERR_IN;                   // R_ERR received (logic_clk)
   
   output          DCMLOCKED_OUT;              // MMCM locked 
   output          TILE0_PLLLKDET_OUT;         // QPLL Lock Detect
@@ -53,6 +71,9 @@ module sata_phy #
   output [31:0]   rx_data_out;
   output [3:0]    rx_charisk_out;
   output          logic_reset;
+  output [31:0]   LB_FRAME_COUNT;             // loopback responder, frames with good CRC
+  output [31:0]   LB_CRC_ERR_COUNT;           // loopback responder, frames with bad CRC
+  output [31:0]   RATE_LOG;                   // link rate changes, see speed_policy
 
 //***********************************Parameter Declarations********************
 
@@ -150,6 +171,15 @@ module sata_phy #
   wire           gt0_rx_fsm_reset_done_out;
   wire           gt0_tx_fsm_reset_done_out;
   wire           rxreset;
+  wire           loopback;
+  wire   [2:0]   gt0_loopback_i;
+  wire   [31:0]  lb_dev_data;
+  wire   [3:0]   lb_dev_charisk;
+  wire   [31:0]  oob_rxdata;
+  wire   [3:0]   oob_rxcharisk;
+  wire   [1:0]   policy_gen_max;
+  wire           policy_reneg;
+  wire           dec_err;
           
   reg            rst_1;  
   reg            rst_2;
@@ -201,6 +231,15 @@ module sata_phy #
   assign  CLKFB_IN                  = CLKFB_OUT;
   assign  gt0_txusrclk_i            = usrclk;
   
+  // near-end loopback : the GTX returns the host stream and the
+  // loopback responder answers it in place of a drive
+  assign  loopback                  = (LOOPBACK_MODE != 2'b00);
+  assign  gt0_loopback_i            = (LOOPBACK_MODE == 2'b01) ? 3'b001 :
+                                      (LOOPBACK_MODE == 2'b10) ? 3'b010 : 3'b000;
+  assign  oob_rxdata                = loopback ? lb_dev_data    : rxdata;
+  assign  oob_rxcharisk             = loopback ? lb_dev_charisk : rxcharisk;
+  assign  dec_err                   = linkup && ((|gt0_rxdisperr_o) || (|gt0_rxnotintable_o));
+  
 
   always @(posedge q3_clk0_refclk_bufg)
   begin
@@ -303,8 +342,8 @@ module sata_phy #
     .tx_chariskin       (tx_charisk_in),
     .tx_dataout         (txdata),           // outgoing GTP data
     .tx_charisk_out     (tx_charisk),          
-    .rx_charisk         (rxcharisk),                             
-    .rx_datain          (rxdata),           // incoming GTP data 
+    .rx_charisk         (oob_rxcharisk),                             
+    .rx_datain          (oob_rxdata),       // incoming GTP data 
     .rx_dataout         (rxdataout),        // User dataout port
     .rx_charisk_out	    (rx_charisk_out),   // User charisk port 
     .linkup             (linkup),
@@ -316,7 +355,7 @@ module sata_phy #
     .comwakedet         (rxcomwakedet),
     .rxelecidle         (rxelecidle),
     .txelecidle         (txelecidle),
-    .rxbyteisaligned    (rxbyteisaligned), 
+    .rxbyteisaligned    (rxbyteisaligned || loopback), 
     .CurrentState_out   (CurrentState_out),
     .align_det_out      (align_det_out),
     .sync_det_out       (sync_det_out),
@@ -324,10 +363,27 @@ module sata_phy #
     .rx_eof_det_out     (rx_eof_det_out),
     .gt0_rxresetdone_i  (gt0_rx_fsm_reset_done_out),
     .gt0_txresetdone_i  (gt0_tx_fsm_reset_done_out),
-    .gtx_rx_reset_out   (oob_gtrx_reset_out)
-  );
+    .gtx_rx_reset_out   (oob_gtrx_reset_out),
+    .loopback           (loopback),
+    .hotplug_en         (HOTPLUG_EN)
+  );
+
+  sata_loopback_dev lb_dev
+  (
+    .clk                (logic_clk),
+    .reset              (gtx_reset || OOB_reset || !loopback),
+    .host_data          (rxdata),
+    .host_charisk       (rxcharisk),
+    .dev_data           (lb_dev_data),
+    .dev_charisk        (lb_dev_charisk),
+    .frame_count        (LB_FRAME_COUNT),
+    .crc_err_count      (LB_CRC_ERR_COUNT)
+  );
 
-  speed_neg_control snc(
+  speed_neg_control #(
+    .FIXED_GEN          (FIXED_GEN)
+    )
+  snc(
     .clk                (mmcm_clk_in),
     .reset              (system_reset),
     .mgt_reset          (speed_neg_rst),
@@ -342,7 +398,28 @@ module sata_phy #
     .state_out          (state_out), 
     .gen_value          (GEN),
     .gt0_txresetdone_i  (gt0_tx_fsm_reset_done_out),
-    .gt0_rxresetdone_i  (gt0_rx_fsm_reset_done_out)
+    .gt0_rxresetdone_i  (gt0_rx_fsm_reset_done_out),
+    .gen_hint_en        (GEN_HINT_EN),
+    .gen_hint           (GEN_HINT),
+    .fast_relink        (HOTPLUG_EN),
+    .gen_max            (policy_gen_max),
+    .reneg              (policy_reneg)
+  );
+
+  speed_policy policy
+  (
+    .clk                (logic_clk),
+    .reset              (system_reset),
+    .enable             (SPEED_POLICY_EN),
+    .linkup             (linkup),
+    .gen                (GEN),
+    .crc_err            (CRC_ERR_IN),
+    .r_err              (R_ERR_IN),
+    .dec_err            (dec_err),
+    .gen_max            (policy_gen_max),
+    .reneg              (policy_reneg),
+    .err_count          (),
+    .rate_log           (RATE_LOG)
   );
 
 
@@ -364,6 +441,7 @@ module sata_phy #
     .GT0_DRPEN_IN             (gt0_drpen_i),
     .GT0_DRPRDY_OUT           (gt0_drprdy_o),
     .GT0_DRPWE_IN             (gt0_drpwe_i),
+    .GT0_LOOPBACK_IN          (gt0_loopback_i),
     .GT0_TXSYSCLKSEL_IN       (gt0_txsysclksel_i),
     .GT0_RXVALID_OUT          (),
     .GT0_RXUSERRDY_IN         (gt0_rxuserrdy_i),
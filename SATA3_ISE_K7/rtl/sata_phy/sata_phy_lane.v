@@ -0,0 +1,320 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : SATA PHY lane
+//  File name   : sata_phy_lane.v
+//  Note        : Per lane part of sata_phy for the multi port build. One
+//                GTX channel with its own OOB control, speed negotiation,
+//                TX/RX startup FSMs and GEN dependent user clock mux. The
+//                reference clock, QPLL (GTXE2_COMMON), user clock MMCM and
+//                the reset synchronisers live in sata_phy_quad and are
+//                shared by all lanes, so a speed negotiation reset of one
+//                lane only resets that lane's GTX channel and logic.
+//  Design ref. : SATA3 Specification, UG476
+//  Dependencies   : OOB_control, speed_neg_control, GTX_GT,
+//                   TX_STARTUP_FSM, RX_STARTUP_FSM
+//////////////////////////////////////////////////////////////////////////////
+
+module sata_phy_lane #
+  (
+    parameter  WRAPPER_SIM_GTRESET_SPEEDUP    =   "FALSE",   // Set to "true" to speed up sim reset
+    parameter  SIM_VERSION                    =   "4.0",
+    parameter  EQ_MODE                        =   "DFE",     // Rx Equalization Mode - Set to DFE or LPM
+    parameter  EXAMPLE_SIMULATION             =    0,
+    parameter  STABLE_CLOCK_PERIOD            =    6,
+    parameter  FIXED_GEN                      =    0          // 0 : negotiate, 1 / 2 / 3 : GEN1 / GEN2 / GEN3 only
+  )
+  (
+    input   wire          stable_clk,         // reference clock BUFG, also DRP clock
+    input   wire          system_reset,       // synchronised main reset
+    input   wire          OOB_reset,          // synchronised OOB reset
+    input   wire          RX_FSM_reset,       // synchronised RX FSM reset
+    input   wire          TX_FSM_reset,       // synchronised TX FSM reset
+
+    input   wire          qpllclk,            // from GTXE2_COMMON
+    input   wire          qpllrefclk,
+    input   wire          qplllock,
+    input   wire          qpllrefclklost,
+    input   wire          mmcm_locked,
+    input   wire          CLK_OUT_150,        // shared user clock MMCM outputs
+    input   wire          CLK_OUT_75,
+    input   wire          CLK_OUT_37,
+
+    output  wire          TXP_OUT,
+    output  wire          TXN_OUT,
+    input   wire          RXP_IN,
+    input   wire          RXN_IN,
+
+    output  wire          LINKUP,
+    output  wire          logic_clk,
+    output  wire  [1:0]   GEN,
+    input   wire  [31:0]  tx_data_in,
+    input   wire          tx_charisk_in,
+    output  wire  [31:0]  rx_data_out,
+    output  wire  [3:0]   rx_charisk_out,
+    output  wire          logic_reset
+  );
+
+  wire           tied_to_ground_i;
+  wire           tied_to_vcc_i;
+  wire           gt0_txresetdone_o;
+  wire           gt0_rxresetdone_o;
+  wire           gt0_gttxreset_i;
+  wire           gt0_gtrxreset_i;
+  wire           gt0_txuserrdy_i;
+  wire           gt0_rxuserrdy_i;
+  wire   [7:0]   gt0_drpaddr_i;
+  wire   [15:0]  gt0_drpdi_i;
+  wire   [15:0]  gt0_drpdo_o;
+  wire           gt0_drpen_i;
+  wire           gt0_drpwe_i;
+  wire           gt0_drprdy_o;
+  wire           gt0_txusrclk_i;
+  wire           gt0_rxcdrlock_o;
+  wire           gt0_rx_fsm_reset_done_out;
+  wire           gt0_tx_fsm_reset_done_out;
+  wire   [3:0]   rxcharisk;
+  wire   [31:0]  txdata, rxdata;
+  wire           tx_charisk;
+  wire           txelecidle, rxelecidle;
+  wire           rxbyteisaligned;
+  wire           rxcomwakedet;
+  wire           rxcominitdet;
+  wire           txcominit;
+  wire           txcomwake;
+  wire           txcomfinish;
+  wire           oob_gtrx_reset_out;
+  wire           linkup;
+  wire           usrclk;
+  wire           clk_out_bufgmux1;
+  wire           speed_neg_rst;
+  wire           gtx_reset;
+  wire   [5:0]   snc_state;
+
+  assign  tied_to_ground_i   = 1'b0;
+  assign  tied_to_vcc_i      = 1'b1;
+  assign  gtx_reset          = system_reset || speed_neg_rst;
+  assign  logic_reset        = gtx_reset;
+  assign  logic_clk          = usrclk;
+  assign  gt0_txusrclk_i     = usrclk;
+  assign  LINKUP             = linkup;
+
+  BUFGMUX usrclk_bufgmux_1
+  (
+    .O  (clk_out_bufgmux1),
+    .I0 (CLK_OUT_37),
+    .I1 (CLK_OUT_75),
+    .S  (GEN[0])
+  );
+
+  BUFGMUX usrclk_bufgmux_2
+  (
+    .O  (usrclk),
+    .I0 (clk_out_bufgmux1),
+    .I1 (CLK_OUT_150),
+    .S  (GEN[1])
+  );
+
+  OOB_control OOB_control_i
+  (
+    .clk                (logic_clk),
+    .reset              (gtx_reset || OOB_reset),
+    .link_reset         (1'b0),
+    .rx_locked          (qplllock),
+    .tx_datain          (tx_data_in),
+    .tx_chariskin       (tx_charisk_in),
+    .tx_dataout         (txdata),
+    .tx_charisk_out     (tx_charisk),
+    .rx_charisk         (rxcharisk),
+    .rx_datain          (rxdata),
+    .rx_dataout         (rx_data_out),
+    .rx_charisk_out     (rx_charisk_out),
+    .linkup             (linkup),
+    .gen                (GEN),
+    .rxreset            (),
+    .txcominit          (txcominit),
+    .txcomwake          (txcomwake),
+    .cominitdet         (rxcominitdet),
+    .comwakedet         (rxcomwakedet),
+    .rxelecidle         (rxelecidle),
+    .txelecidle         (txelecidle),
+    .rxbyteisaligned    (rxbyteisaligned),
+    .CurrentState_out   (),
+    .align_det_out      (),
+    .sync_det_out       (),
+    .rx_sof_det_out     (),
+    .rx_eof_det_out     (),
+    .gt0_rxresetdone_i  (gt0_rx_fsm_reset_done_out),
+    .gt0_txresetdone_i  (gt0_tx_fsm_reset_done_out),
+    .gtx_rx_reset_out   (oob_gtrx_reset_out),
+    .loopback           (1'b0),
+    .hotplug_en         (1'b0)
+  );
+
+  speed_neg_control #(
+    .FIXED_GEN          (FIXED_GEN)
+    )
+  snc(
+    .clk                (stable_clk),
+    .reset              (system_reset),
+    .mgt_reset          (speed_neg_rst),
+    .linkup             (linkup),
+    .daddr              (gt0_drpaddr_i),
+    .den                (gt0_drpen_i),
+    .di                 (gt0_drpdi_i),
+    .do                 (gt0_drpdo_o),
+    .drdy               (gt0_drprdy_o),
+    .dwe                (gt0_drpwe_i),
+    .gtx_lock           (qplllock),
+    .state_out          (snc_state),
+    .gen_value          (GEN),
+    .gt0_txresetdone_i  (gt0_tx_fsm_reset_done_out),
+    .gt0_rxresetdone_i  (gt0_rx_fsm_reset_done_out),
+    .gen_hint_en        (1'b0),
+    .gen_hint           (2'b10),
+    .fast_relink        (1'b0),
+    .gen_max            (2'b10),
+    .reneg              (1'b0)
+  );
+
+  GTX_GT #
+  (
+    .GT_SIM_GTRESET_SPEEDUP   (WRAPPER_SIM_GTRESET_SPEEDUP),
+    .SIM_VERSION              (SIM_VERSION),
+    .RX_DFE_KL_CFG2_IN        (32'h3010D90C),
+    .PCS_RSVD_ATTR_IN         (48'h000000000100),
+    .PMA_RSV_IN               (32'h00018480)
+  )
+  gtx_i
+  (
+    .DRPADDR_IN               ({1'b0,gt0_drpaddr_i}),
+    .DRPCLK_IN                (stable_clk),
+    .DRPDI_IN                 (gt0_drpdi_i),
+    .DRPDO_OUT                (gt0_drpdo_o),
+    .DRPEN_IN                 (gt0_drpen_i),
+    .DRPRDY_OUT               (gt0_drprdy_o),
+    .DRPWE_IN                 (gt0_drpwe_i),
+    .LOOPBACK_IN              (3'b000),
+    .QPLLCLK_IN               (qpllclk),
+    .QPLLREFCLK_IN            (qpllrefclk),
+    .TXSYSCLKSEL_IN           (2'b11),
+    .RXVALID_OUT              (),
+    .RXUSERRDY_IN             (gt0_rxuserrdy_i),
+    .EYESCANDATAERROR_OUT     (),
+    .RXCDRHOLD_IN             (1'b0),
+    .RXCDRLOCK_OUT            (gt0_rxcdrlock_o),
+    .RXCLKCORCNT_OUT          (),
+    .RXUSRCLK_IN              (gt0_txusrclk_i),
+    .RXUSRCLK2_IN             (gt0_txusrclk_i),
+    .RXDATA_OUT               (rxdata),
+    .RXDISPERR_OUT            (),
+    .RXNOTINTABLE_OUT         (),
+    .GTXRXP_IN                (RXP_IN),
+    .GTXRXN_IN                (RXN_IN),
+    .RXBYTEISALIGNED_OUT      (rxbyteisaligned),
+    .RXDFEAGCHOLD_IN          (tied_to_ground_i),
+    .RXDFELPMRESET_IN         (tied_to_ground_i),
+    .RXMONITOROUT_OUT         (),
+    .RXMONITORSEL_IN          (2'b00),
+    .RXOUTCLK_OUT             (),
+    .GTRXRESET_IN             (gt0_gtrxreset_i),
+    .RXPMARESET_IN            (tied_to_ground_i),
+    .RXCOMWAKEDET_OUT         (rxcomwakedet),
+    .RXCOMINITDET_OUT         (rxcominitdet),
+    .RXELECIDLE_OUT           (rxelecidle),
+    .RXCHARISK_OUT            (rxcharisk),
+    .RXRESETDONE_OUT          (gt0_rxresetdone_o),
+    .GTTXRESET_IN             (gt0_gttxreset_i),
+    .TXUSERRDY_IN             (gt0_txuserrdy_i),
+    .TXUSRCLK_IN              (gt0_txusrclk_i),
+    .TXUSRCLK2_IN             (gt0_txusrclk_i),
+    .TXELECIDLE_IN            (txelecidle),
+    .TXDATA_IN                (txdata),
+    .GTXTXN_OUT               (TXN_OUT),
+    .GTXTXP_OUT               (TXP_OUT),
+    .TXOUTCLK_OUT             (),
+    .TXOUTCLKFABRIC_OUT       (),
+    .TXOUTCLKPCS_OUT          (),
+    .TXCHARISK_IN             ({3'b000, tx_charisk}),
+    .TXRESETDONE_OUT          (gt0_txresetdone_o),
+    .TXCOMFINISH_OUT          (txcomfinish),
+    .TXCOMINIT_IN             (txcominit),
+    .TXCOMWAKE_IN             (txcomwake)
+  );
+
+  // QPLL_RESET / MMCM_RESET of the lane FSMs are not used, the shared
+  // QPLL and MMCM are reset by sata_phy_quad; the FSMs only wait for lock
+  TX_STARTUP_FSM #
+  (
+    .GT_TYPE                  ("GTX"),
+    .STABLE_CLOCK_PERIOD      (STABLE_CLOCK_PERIOD),
+    .RETRY_COUNTER_BITWIDTH   (8),
+    .TX_QPLL_USED             ("TRUE"),
+    .RX_QPLL_USED             ("TRUE"),
+    .PHASE_ALIGNMENT_MANUAL   ("FALSE")
+   )
+  txresetfsm_i
+  (
+    .STABLE_CLOCK             (stable_clk),
+    .TXUSERCLK                (gt0_txusrclk_i),
+    .SOFT_RESET               (gtx_reset || TX_FSM_reset),
+    .QPLLREFCLKLOST           (qpllrefclklost),
+    .CPLLREFCLKLOST           (tied_to_ground_i),
+    .QPLLLOCK                 (qplllock),
+    .CPLLLOCK                 (tied_to_vcc_i),
+    .TXRESETDONE              (gt0_txresetdone_o),
+    .MMCM_LOCK                (mmcm_locked),
+    .GTTXRESET                (gt0_gttxreset_i),
+    .MMCM_RESET               (),
+    .QPLL_RESET               (),
+    .CPLL_RESET               (),
+    .TX_FSM_RESET_DONE        (gt0_tx_fsm_reset_done_out),
+    .TXUSERRDY                (gt0_txuserrdy_i),
+    .RUN_PHALIGNMENT          (),
+    .RESET_PHALIGNMENT        (),
+    .PHALIGNMENT_DONE         (tied_to_vcc_i),
+    .RETRY_COUNTER            ()
+  );
+
+  RX_STARTUP_FSM  #
+  (
+    .EXAMPLE_SIMULATION       (EXAMPLE_SIMULATION),
+    .GT_TYPE                  ("GTX"),
+    .EQ_MODE                  (EQ_MODE),
+    .STABLE_CLOCK_PERIOD      (STABLE_CLOCK_PERIOD),
+    .RETRY_COUNTER_BITWIDTH   (8),
+    .TX_QPLL_USED             ("TRUE"),
+    .RX_QPLL_USED             ("TRUE"),
+    .PHASE_ALIGNMENT_MANUAL   ("FALSE")
+   )
+  rxresetfsm_i
+   (
+    .STABLE_CLOCK             (stable_clk),
+    .RXUSERCLK                (gt0_txusrclk_i),
+    .SOFT_RESET               (gtx_reset || RX_FSM_reset || oob_gtrx_reset_out),
+    .QPLLREFCLKLOST           (qpllrefclklost),
+    .CPLLREFCLKLOST           (tied_to_ground_i),
+    .QPLLLOCK                 (qplllock),
+    .CPLLLOCK                 (),
+    .RXRESETDONE              (gt0_rxresetdone_o),
+    .MMCM_LOCK                (mmcm_locked),
+    .RECCLK_STABLE            (gt0_rxcdrlock_o),
+    .RECCLK_MONITOR_RESTART   (tied_to_ground_i),
+    .DATA_VALID               (1'b1),
+    .TXUSERRDY                (gt0_txuserrdy_i),
+    .GTRXRESET                (gt0_gtrxreset_i),
+    .MMCM_RESET               (),
+    .QPLL_RESET               (),
+    .CPLL_RESET               (),
+    .RX_FSM_RESET_DONE        (gt0_rx_fsm_reset_done_out),
+    .RXUSERRDY                (gt0_rxuserrdy_i),
+    .RUN_PHALIGNMENT          (),
+    .RESET_PHALIGNMENT        (),
+    .PHALIGNMENT_DONE         (tied_to_vcc_i),
+    .RXDFELFHOLD              (),
+    .RXLPMLFHOLD              (),
+    .RXLPMHFHOLD              (),
+    .RXDFEAGCHOLD             (),
+    .RETRY_COUNTER            ()
+  );
+
+endmodule
@@ -0,0 +1,271 @@
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : Multi port SATA PHY
+//  File name   : sata_phy_quad.v
+//  Note        : Up to four SATA PHY lanes on one GTX quad. The reference
+//                clock buffer, the QPLL (GTXE2_COMMON), the user clock MMCM
+//                and the reset synchronisers are shared; OOB, speed
+//                negotiation and the GEN clock mux are per lane
+//                (sata_phy_lane). The MMCM is fed from the reference clock
+//                BUFG instead of lane 0 TXOUTCLK (both 150MHz) so a lane
+//                reset can not disturb the user clocks of the other lanes.
+//                Port vectors are indexed by lane.
+//  Design ref. : SATA3 Specification, UG476
+//  Dependencies   : sata_phy_lane, MMCM_usrclk
+//////////////////////////////////////////////////////////////////////////////
+
+module sata_phy_quad #
+  (
+    parameter  NUM_PORTS                      =    4,         // 1 to 4
+    parameter  WRAPPER_SIM_GTRESET_SPEEDUP    =   "FALSE",
+    parameter  SIM_VERSION                    =   "4.0",
+    parameter  EQ_MODE                        =   "DFE",
+    parameter  EXAMPLE_SIMULATION             =    0,
+    parameter  FIXED_GEN                      =    0          // 0 : negotiate, 1 / 2 / 3 : GEN1 / GEN2 / GEN3 only
+  )
+  (
+    input   wire                     TILE0_REFCLK_PAD_P_IN,   // MGTCLK of the quad, 150MHz
+    input   wire                     TILE0_REFCLK_PAD_N_IN,
+    input   wire                     GTXRESET_IN,             // main reset, all lanes
+    output  wire                     TILE0_PLLLKDET_OUT,      // QPLL lock
+    output  wire                     DCMLOCKED_OUT,           // MMCM lock
+    input   wire                     OOB_reset_IN,
+    input   wire                     RX_FSM_reset_IN,
+    input   wire                     TX_FSM_reset_IN,
+
+    output  wire  [NUM_PORTS-1:0]    TXP_OUT,
+    output  wire  [NUM_PORTS-1:0]    TXN_OUT,
+    input   wire  [NUM_PORTS-1:0]    RXP_IN,
+    input   wire  [NUM_PORTS-1:0]    RXN_IN,
+
+    output  wire  [NUM_PORTS-1:0]    LINKUP,
+    output  wire  [NUM_PORTS-1:0]    logic_clk,
+    output  wire  [NUM_PORTS*2-1:0]  GEN,
+    input   wire  [NUM_PORTS*32-1:0] tx_data_in,
+    input   wire  [NUM_PORTS-1:0]    tx_charisk_in,
+    output  wire  [NUM_PORTS*32-1:0] rx_data_out,
+    output  wire  [NUM_PORTS*4-1:0]  rx_charisk_out,
+    output  wire  [NUM_PORTS-1:0]    logic_reset
+  );
+
+  parameter STABLE_CLOCK_PERIOD  = 6;
+
+  wire           tied_to_ground_i;
+  wire           tied_to_vcc_i;
+  wire           q3_clk0_refclk_i;
+  wire           q3_clk0_refclk_bufg;
+  wire           qplloutclk;
+  wire           qplloutrefclk;
+  wire           qplllock;
+  wire           qpllrefclklost;
+  wire           CLK_OUT_150, CLK_OUT_75, CLK_OUT_37;
+  wire           CLKFB_OUT;
+  wire           MMCM_LOCKED;
+  wire           rst_debounce;
+  wire           OOB_reset;
+  wire           RX_FSM_reset;
+  wire           TX_FSM_reset;
+
+  reg            GTPRESET_IN_1, GTPRESET_IN_2;
+  reg            rst_1, rst_2, rst_3;
+  reg            OOB_reset_IN_1, OOB_reset_IN_2;
+  reg            OOB_reset_1, OOB_reset_2, OOB_reset_3;
+  reg            RX_FSM_reset_IN_1, RX_FSM_reset_IN_2;
+  reg            RX_FSM_reset_1, RX_FSM_reset_2, RX_FSM_reset_3;
+  reg            TX_FSM_reset_IN_1, TX_FSM_reset_IN_2;
+  reg            TX_FSM_reset_1, TX_FSM_reset_2, TX_FSM_reset_3;
+  reg    [7:0]   qpll_reset_cnt;
+  reg            qpll_reset;
+
+  assign  tied_to_ground_i     = 1'b0;
+  assign  tied_to_vcc_i        = 1'b1;
+  assign  TILE0_PLLLKDET_OUT   = qplllock;
+  assign  DCMLOCKED_OUT        = MMCM_LOCKED;
+
+  //******************************* shared reset synchronisers *******************************
+  always @(posedge q3_clk0_refclk_bufg)
+  begin
+   GTPRESET_IN_1     <= GTXRESET_IN;
+   GTPRESET_IN_2     <= GTPRESET_IN_1;
+   rst_1             <= GTPRESET_IN_2;
+   rst_2             <= rst_1;
+   rst_3             <= rst_2;
+   OOB_reset_IN_1    <= OOB_reset_IN;
+   OOB_reset_IN_2    <= OOB_reset_IN_1;
+   OOB_reset_1       <= OOB_reset_IN_2;
+   OOB_reset_2       <= OOB_reset_1;
+   OOB_reset_3       <= OOB_reset_2;
+   RX_FSM_reset_IN_1 <= RX_FSM_reset_IN;
+   RX_FSM_reset_IN_2 <= RX_FSM_reset_IN_1;
+   RX_FSM_reset_1    <= RX_FSM_reset_IN_2;
+   RX_FSM_reset_2    <= RX_FSM_reset_1;
+   RX_FSM_reset_3    <= RX_FSM_reset_2;
+   TX_FSM_reset_IN_1 <= TX_FSM_reset_IN;
+   TX_FSM_reset_IN_2 <= TX_FSM_reset_IN_1;
+   TX_FSM_reset_1    <= TX_FSM_reset_IN_2;
+   TX_FSM_reset_2    <= TX_FSM_reset_1;
+   TX_FSM_reset_3    <= TX_FSM_reset_2;
+  end
+
+  assign  rst_debounce  = (rst_1 & rst_2 & rst_3);
+  assign  OOB_reset     = (OOB_reset_1 & OOB_reset_2 & OOB_reset_3);
+  assign  RX_FSM_reset  = (RX_FSM_reset_1 & RX_FSM_reset_2 & RX_FSM_reset_3);
+  assign  TX_FSM_reset  = (TX_FSM_reset_1 & TX_FSM_reset_2 & TX_FSM_reset_3);
+
+  // QPLL reset pulse after the main reset, only the main reset touches the QPLL
+  always @(posedge q3_clk0_refclk_bufg)
+  begin
+    if(rst_debounce) begin
+      qpll_reset_cnt <= 8'd0;
+      qpll_reset     <= 1'b1;
+    end
+    else if(qpll_reset_cnt != 8'hFF) begin
+      qpll_reset_cnt <= qpll_reset_cnt + 1'b1;
+      qpll_reset     <= 1'b1;
+    end
+    else begin
+      qpll_reset     <= 1'b0;
+    end
+  end
+
+  //******************************* shared clocking ******************************************
+  IBUFDS_GTE2 #
+  (
+    .CLKRCV_TRST  (1),
+    .CLKCM_CFG    (1),
+    .CLKSWING_CFG (2'b11)
+  )
+  ibufds_instQ3_CLK1
+  (
+    .O      (q3_clk0_refclk_i),
+    .ODIV2  (),
+    .CEB    (tied_to_ground_i),
+    .I      (TILE0_REFCLK_PAD_P_IN),
+    .IB     (TILE0_REFCLK_PAD_N_IN)
+  );
+
+  BUFG q3_clk0_refclk_i_bufg
+  (
+    .I  (q3_clk0_refclk_i),
+    .O  (q3_clk0_refclk_bufg)
+  );
+
+  MMCM_usrclk TX_RX_usrclk
+  (
+    .CLK_IN1    (q3_clk0_refclk_bufg),
+    .CLKFB_IN   (CLKFB_OUT),
+    .CLK_OUT1   (CLK_OUT_150),
+    .CLK_OUT2   (CLK_OUT_75),
+    .CLK_OUT3   (CLK_OUT_37),
+    .CLKFB_OUT  (CLKFB_OUT),
+    .RESET      (rst_debounce),
+    .LOCKED     (MMCM_LOCKED)
+  );
+
+  // same QPLL settings as the single port GTX wrapper (QPLL_FBDIV 40)
+  GTXE2_COMMON #
+  (
+    .SIM_RESET_SPEEDUP                      (WRAPPER_SIM_GTRESET_SPEEDUP),
+    .SIM_QPLLREFCLK_SEL                     (3'b001),
+    .SIM_VERSION                            (SIM_VERSION),
+    .BIAS_CFG                               (64'h0000040000001000),
+    .COMMON_CFG                             (32'h00000000),
+    .QPLL_CFG                               (27'h06801C1),
+    .QPLL_CLKOUT_CFG                        (4'b0000),
+    .QPLL_COARSE_FREQ_OVRD                  (6'b010000),
+    .QPLL_COARSE_FREQ_OVRD_EN               (1'b0),
+    .QPLL_CP                                (10'b0000011111),
+    .QPLL_CP_MONITOR_EN                     (1'b0),
+    .QPLL_DMONITOR_SEL                      (1'b0),
+    .QPLL_FBDIV                             (10'b0010000000),
+    .QPLL_FBDIV_MONITOR_EN                  (1'b0),
+    .QPLL_FBDIV_RATIO                       (1'b1),
+    .QPLL_INIT_CFG                          (24'h000006),
+    .QPLL_LOCK_CFG                          (16'h21E8),
+    .QPLL_LPF                               (4'b1111),
+    .QPLL_REFCLK_DIV                        (1)
+  )
+  gtxe2_common_i
+  (
+    .DRPADDR                        (8'd0),
+    .DRPCLK                         (tied_to_ground_i),
+    .DRPDI                          (16'd0),
+    .DRPDO                          (),
+    .DRPEN                          (tied_to_ground_i),
+    .DRPRDY                         (),
+    .DRPWE                          (tied_to_ground_i),
+    .GTGREFCLK                      (tied_to_ground_i),
+    .GTNORTHREFCLK0                 (tied_to_ground_i),
+    .GTNORTHREFCLK1                 (tied_to_ground_i),
+    .GTREFCLK0                      (q3_clk0_refclk_i),
+    .GTREFCLK1                      (tied_to_ground_i),
+    .GTSOUTHREFCLK0                 (tied_to_ground_i),
+    .GTSOUTHREFCLK1                 (tied_to_ground_i),
+    .QPLLDMONITOR                   (),
+    .QPLLOUTCLK                     (qplloutclk),
+    .QPLLOUTREFCLK                  (qplloutrefclk),
+    .REFCLKOUTMONITOR               (),
+    .QPLLFBCLKLOST                  (),
+    .QPLLLOCK                       (qplllock),
+    .QPLLLOCKDETCLK                 (q3_clk0_refclk_bufg),
+    .QPLLLOCKEN                     (tied_to_vcc_i),
+    .QPLLOUTRESET                   (tied_to_ground_i),
+    .QPLLPD                         (tied_to_ground_i),
+    .QPLLREFCLKLOST                 (qpllrefclklost),
+    .QPLLREFCLKSEL                  (3'b001),
+    .QPLLRESET                      (qpll_reset),
+    .QPLLRSVD1                      (16'b0000000000000000),
+    .QPLLRSVD2                      (5'b11111),
+    .BGBYPASSB                      (tied_to_vcc_i),
+    .BGMONITORENB                   (tied_to_vcc_i),
+    .BGPDB                          (tied_to_vcc_i),
+    .BGRCALOVRD                     (5'b00000),
+    .PMARSVD                        (8'b00000000),
+    .RCALENB                        (tied_to_vcc_i)
+  );
+
+  //******************************* lanes ****************************************************
+  genvar i;
+  generate
+    for(i = 0; i < NUM_PORTS; i = i + 1) begin : lane
+      sata_phy_lane #
+      (
+        .WRAPPER_SIM_GTRESET_SPEEDUP  (WRAPPER_SIM_GTRESET_SPEEDUP),
+        .SIM_VERSION                  (SIM_VERSION),
+        .EQ_MODE                      (EQ_MODE),
+        .EXAMPLE_SIMULATION           (EXAMPLE_SIMULATION),
+        .STABLE_CLOCK_PERIOD          (STABLE_CLOCK_PERIOD),
+        .FIXED_GEN                    (FIXED_GEN)
+      )
+      phy_lane_i
+      (
+        .stable_clk       (q3_clk0_refclk_bufg),
+        .system_reset     (rst_debounce),
+        .OOB_reset        (OOB_reset),
+        .RX_FSM_reset     (RX_FSM_reset),
+        .TX_FSM_reset     (TX_FSM_reset),
+        .qpllclk          (qplloutclk),
+        .qpllrefclk       (qplloutrefclk),
+        .qplllock         (qplllock),
+        .qpllrefclklost   (qpllrefclklost),
+        .mmcm_locked      (MMCM_LOCKED),
+        .CLK_OUT_150      (CLK_OUT_150),
+        .CLK_OUT_75       (CLK_OUT_75),
+        .CLK_OUT_37       (CLK_OUT_37),
+        .TXP_OUT          (TXP_OUT[i]),
+        .TXN_OUT          (TXN_OUT[i]),
+        .RXP_IN           (RXP_IN[i]),
+        .RXN_IN           (RXN_IN[i]),
+        .LINKUP           (LINKUP[i]),
+        .logic_clk        (logic_clk[i]),
+        .GEN              (GEN[i*2+1:i*2]),
+        .tx_data_in       (tx_data_in[i*32+31:i*32]),
+        .tx_charisk_in    (tx_charisk_in[i]),
+        .rx_data_out      (rx_data_out[i*32+31:i*32]),
+        .rx_charisk_out   (rx_charisk_out[i*4+3:i*4]),
+        .logic_reset      (logic_reset[i])
+      );
+    end
+  endgenerate
+
+endmodule
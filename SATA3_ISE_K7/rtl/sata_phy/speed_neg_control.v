@@ -1,5 +1,7 @@
 
-module speed_neg_control 
+module speed_neg_control #(
+    parameter integer FIXED_GEN = 0     // 0 : negotiate GEN3 -> GEN2 -> GEN1, 1 / 2 / 3 : GEN1 / GEN2 / GEN3 only
+    )
   (
     input   wire          clk,          // clock
     input   wire          reset,        // reset
@@ -15,7 +17,12 @@ module speed_neg_control
     output  wire  [5:0]   state_out,
     output  reg   [1:0]   gen_value,
     input   wire          gt0_txresetdone_i,
-    input   wire          gt0_rxresetdone_i
+    input   wire          gt0_rxresetdone_i,
+    input   wire          gen_hint_en,  // start negotiation at gen_hint
+    input   wire  [1:0]   gen_hint,     // e.g. the GEN saved from a previous power cycle
+    input   wire          fast_relink,  // on link loss let OOB_control re-link before a GTX reset
+    input   wire  [1:0]   gen_max,      // highest generation to use (speed_policy, logic_clk domain)
+    input   wire          reneg         // renegotiate at gen_max (speed_policy, logic_clk domain)
     
   );
 
@@ -76,8 +83,54 @@ module speed_neg_control
   reg [15:0]     drp_reg;
   reg [15:0]     reset_cnt;
   reg [3:0]      pause_cnt;
+  reg [1:0]      good_gen;      // last known good generation, kept over GTX resets
+  reg            good_gen_vld;
+  
+  reg [1:0]      gen_max_s1, gen_max_s2;
+  reg            reneg_s1, reneg_s2;
+  
+  wire [1:0]     hint_gen;
+  wire [1:0]     start_gen;
+  wire [5:0]     start_state;
+  wire [1:0]     cap_gen;
+  wire [5:0]     cap_state;
+  wire [5:0]     retry_state;
 
   assign  state_out = state;
+  
+  // fast path : a re-link starts at the generation of the last link, a cold
+  // start at the hint, and only then walks down GEN3 -> GEN2 -> GEN1
+  assign  hint_gen    = good_gen_vld ? good_gen :
+                        gen_hint_en  ? (gen_hint[1] ? 2'b10 : gen_hint) : 2'b10;
+  assign  start_gen   = (FIXED_GEN != 0)     ? FIXED_GEN - 1 :
+                        (hint_gen > cap_gen) ? cap_gen : hint_gen;
+  assign  start_state = (start_gen == 2'b00) ? READ_GEN1 :
+                        (start_gen == 2'b01) ? READ_GEN2 : READ_GEN3;
+  
+  // speed_policy cap, the walk restarts here after GEN1
+  assign  cap_gen     = gen_max_s2[1] ? 2'b10 : gen_max_s2;
+  assign  cap_state   = (cap_gen == 2'b00) ? READ_GEN1 :
+                        (cap_gen == 2'b01) ? READ_GEN2 : READ_GEN3;
+  
+  // fixed generation build : the rate is programmed once from IDLE, every
+  // later attempt only resets the GTX and stays at that rate
+  assign  retry_state = (start_gen == 2'b00) ? RESET_GEN1 :
+                        (start_gen == 2'b01) ? RESET_GEN2 : RESET_GEN3;
+
+always @ (posedge clk or posedge reset) begin
+  if(reset) begin
+    gen_max_s1 <= 2'b10;
+    gen_max_s2 <= 2'b10;
+    reneg_s1   <= 1'b0;
+    reneg_s2   <= 1'b0;
+  end
+  else begin
+    gen_max_s1 <= gen_max;
+    gen_max_s2 <= gen_max_s1;
+    reneg_s1   <= reneg;
+    reneg_s2   <= reneg_s1;
+  end
+end
 
 always @ (posedge clk or posedge reset) begin
   if(reset) begin
@@ -92,6 +145,8 @@ always @ (posedge clk or posedge reset) begin
     reset_cnt  <= 16'b0000000000000000;
     mgt_reset  <= 1'b0;
     pause_cnt  <= 4'b0000;
+    good_gen     <= 2'b10;
+    good_gen_vld <= 1'b0;
   end
   else begin
     case(state)
@@ -100,8 +155,8 @@ always @ (posedge clk or posedge reset) begin
         if(gtx_lock && gt0_txresetdone_i && gt0_rxresetdone_i) begin
           daddr     <= 8'h88;
           den       <= 1'b1;
-          gen_value <= 2'b10; //GEN3
-          state     <= READ_GEN3;
+          gen_value <= start_gen;
+          state     <= start_state;
         end
         else begin
           state <= IDLE;
@@ -287,10 +342,15 @@ always @ (posedge clk or posedge reset) begin
           `endif 
             begin
               linkup_cnt <= 32'h0;
-              daddr      <= 8'h88;
-              den        <= 1'b1;
-              gen_value  <= 2'b01; //this is Gen2
-              state      <= READ_GEN2;
+              if (FIXED_GEN != 0) begin
+                state      <= retry_state;
+              end
+              else begin
+                daddr      <= 8'h88;
+                den        <= 1'b1;
+                gen_value  <= 2'b01; //this is Gen2
+                state      <= READ_GEN2;
+              end
               //state <= WAIT_GEN2;  //MD don't switch back and forth to see if this improves the linkup situation
             end
             else begin
@@ -482,10 +542,15 @@ always @ (posedge clk or posedge reset) begin
             `endif 
             begin
               linkup_cnt <= 32'h0;
-              daddr <= 8'h88;
-              den   <= 1'b1;
-              gen_value <= 2'b 00; //this is Gen1
-              state <= READ_GEN1;   
+              if (FIXED_GEN != 0) begin
+                state <= retry_state;
+              end
+              else begin
+                daddr <= 8'h88;
+                den   <= 1'b1;
+                gen_value <= 2'b 00; //this is Gen1
+                state <= READ_GEN1;   
+              end
             end
             else  begin
               linkup_cnt <= linkup_cnt + 1'b1;
@@ -689,10 +754,15 @@ always @ (posedge clk or posedge reset) begin
             `endif 
             begin
               linkup_cnt <= 32'h0;
-              daddr      <= 8'h88;
-              den        <= 1'b1;
-              gen_value  <= 2'b10; //GEN3
-              state      <= READ_GEN3; // after elapsed time the linkup resumes to Gen3
+              if (FIXED_GEN != 0) begin
+                state      <= retry_state;
+              end
+              else begin
+                daddr      <= 8'h88;
+                den        <= 1'b1;
+                gen_value  <= cap_gen; //GEN3 unless capped
+                state      <= cap_state; // after elapsed time the linkup resumes to Gen3
+              end
             end
             else begin
               linkup_cnt <= linkup_cnt + 1'b1;
@@ -705,14 +775,40 @@ always @ (posedge clk or posedge reset) begin
         end
       end
       LINKUP: begin
-        if (linkup)
-          state <= LINKUP;
+        if (reneg_s2 && FIXED_GEN == 0) begin
+          // rate change requested by speed_policy
+          linkup_cnt   <= 32'h0;
+          daddr        <= 8'h88;
+          den          <= 1'b1;
+          gen_value    <= cap_gen;
+          state        <= cap_state;
+        end
+        else if (linkup) begin
+          good_gen     <= gen_value;
+          good_gen_vld <= 1'b1;
+          linkup_cnt   <= 32'h0;
+          state        <= LINKUP;
+        end
+      `ifdef SIM
+        else if (fast_relink && linkup_cnt != 32'h000007FF) begin
+      `else
+        else if (fast_relink && linkup_cnt != 32'h00080EB4) begin
+      `endif
+          // OOB_control is re-running COMRESET/COMWAKE at the current
+          // speed, give it the same time as a speed attempt
+          linkup_cnt   <= linkup_cnt + 1'b1;
+          state        <= LINKUP;
+        end
+        else if (FIXED_GEN != 0) begin
+          linkup_cnt <= 32'h0;
+          state      <= retry_state; // fixed rate, the DRP settings are still in place
+        end
         else begin
           linkup_cnt <= 32'h0;
           daddr      <= 8'h88;
           den        <= 1'b1;
-          gen_value  <= 2'b10; //GEN3
-          state      <= READ_GEN3; // after elapsed time the linkup resumes to Gen3
+          gen_value  <= start_gen;
+          state      <= start_state; // re-link at the last good generation first
         end
       end 
       default: begin
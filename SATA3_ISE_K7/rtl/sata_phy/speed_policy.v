@@ -0,0 +1,145 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : Link speed policy
+//  File name   : speed_policy.v
+//  Note        : Counts link errors (CRC error, R_ERR and 8b/10b decode /
+//                disparity errors) over a window of WINDOW GEN3 clocks; the
+//                window is scaled with the user clock so it always covers
+//                the same time. When ERR_THRESHOLD errors are seen within
+//                one window the generation cap gen_max is lowered to one
+//                below the current generation and reneg asks
+//                speed_neg_control to negotiate again (DRP rate change and
+//                user clock switch on the BUFGMUX tree behind MMCM_usrclk).
+//                With PROBE_WINDOWS != 0 the cap is raised again by one
+//                generation after PROBE_WINDOWS clean windows in a row; if
+//                the probe fails the normal walk ends one generation lower.
+//                reneg is held until linkup drops.
+//                Every rate change is logged in rate_log :
+//                  [31:24] number of logged changes
+//                  [23:0]  last six entries {cause[1:0], gen[1:0]}, newest
+//                          in [3:0], cause 00 link up, 01 downshift,
+//                          10 upshift probe
+//                Must be reset with the PHY power-on reset only, the GTX
+//                resets of a renegotiation would otherwise clear the cap.
+//  Design ref. : SATA3 Specification
+//  Dependencies   : Nil
+//////////////////////////////////////////////////////////////////////////////
+
+module speed_policy #(
+    parameter        WINDOW         = 32'd15_000_000,   // 100 ms of GEN3 user clock
+    parameter        ERR_THRESHOLD  = 16'd64,           // errors per window that force a downshift
+    parameter        PROBE_WINDOWS  = 16'd0             // clean windows before an upshift probe, 0 = never
+    )
+    (
+    input              clk,              // logic_clk
+    input              reset,
+    input              enable,
+    input              linkup,
+    input      [1:0]   gen,              // current generation
+    input              crc_err,          // link layer CRC error
+    input              r_err,            // R_ERR received
+    input              dec_err,          // decode or disparity error, one clock per error
+    output reg [1:0]   gen_max,          // highest generation speed_neg_control may use
+    output reg         reneg,            // renegotiate at gen_max
+    output reg [15:0]  err_count,        // errors in the current window
+    output reg [31:0]  rate_log
+    );
+
+  parameter  [1:0]  CAUSE_LINK = 2'b00;
+  parameter  [1:0]  CAUSE_DOWN = 2'b01;
+  parameter  [1:0]  CAUSE_UP   = 2'b10;
+
+  reg          linkup_r;
+  reg          crc_err_r;
+  reg          r_err_r;
+  reg  [31:0]  win_cnt;
+  reg  [15:0]  clean_cnt;
+  reg   [1:0]  cause;
+  reg   [1:0]  last_gen;
+
+  wire         err_inc;
+  wire [31:0]  win_len;
+
+  assign err_inc = (crc_err && !crc_err_r) || (r_err && !r_err_r) || dec_err;
+  assign win_len = (gen == 2'b00) ? {2'b00, WINDOW[31:2]} :
+                   (gen == 2'b01) ? {1'b0,  WINDOW[31:1]} : WINDOW;
+
+  always @(posedge clk, posedge reset)
+  begin
+    if (reset) begin
+      linkup_r  <= 1'b0;
+      crc_err_r <= 1'b0;
+      r_err_r   <= 1'b0;
+    end
+    else begin
+      linkup_r  <= linkup;
+      crc_err_r <= crc_err;
+      r_err_r   <= r_err;
+    end
+  end
+
+  always @(posedge clk, posedge reset)
+  begin
+    if (reset) begin
+      gen_max   <= 2'b10;
+      reneg     <= 1'b0;
+      err_count <= 16'h0;
+      rate_log  <= 32'h0;
+      win_cnt   <= 32'h0;
+      clean_cnt <= 16'h0;
+      cause     <= CAUSE_LINK;
+      last_gen  <= 2'b10;
+    end
+    else if (!linkup) begin
+      reneg     <= 1'b0;
+      err_count <= 16'h0;
+      win_cnt   <= 32'h0;
+      clean_cnt <= 16'h0;
+    end
+    else if (!linkup_r) begin
+      // new link, log it when the rate changed or the policy caused it
+      if (cause != CAUSE_LINK || gen != last_gen || rate_log[31:24] == 8'h0) begin
+        rate_log  <= {rate_log[31:24] + 1'b1, rate_log[19:0], cause, gen};
+      end
+      last_gen  <= gen;
+      cause     <= CAUSE_LINK;
+    end
+    else if (!enable) begin
+      gen_max   <= 2'b10;
+      err_count <= 16'h0;
+      win_cnt   <= 32'h0;
+      clean_cnt <= 16'h0;
+    end
+    else if (!reneg) begin
+      if (err_inc && err_count != 16'hFFFF) begin
+        err_count <= err_count + 1'b1;
+      end
+      if (err_count + err_inc >= ERR_THRESHOLD && gen != 2'b00) begin
+        gen_max   <= gen - 1'b1;
+        cause     <= CAUSE_DOWN;
+        reneg     <= 1'b1;
+      end
+      else if (win_cnt >= win_len) begin
+        win_cnt   <= 32'h0;
+        err_count <= 16'h0;
+        if (err_count != 16'h0 || gen_max == 2'b10 || PROBE_WINDOWS == 16'd0) begin
+          clean_cnt <= 16'h0;
+        end
+        else if (clean_cnt + 1'b1 >= PROBE_WINDOWS) begin
+          clean_cnt <= 16'h0;
+          gen_max   <= gen_max + 1'b1;
+          cause     <= CAUSE_UP;
+          reneg     <= 1'b1;
+        end
+        else begin
+          clean_cnt <= clean_cnt + 1'b1;
+        end
+      end
+      else begin
+        win_cnt   <= win_cnt + 1'b1;
+      end
+    end
+  end
+
+endmodule
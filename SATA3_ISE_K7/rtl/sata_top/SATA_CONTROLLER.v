@@ -10,7 +10,12 @@
 //////////////////////////////////////////////////////////////////////////////
 
 module SATA_CONTROLLER#(
-    parameter integer CHIPSCOPE = 0
+    parameter integer CHIPSCOPE = 0,
+    parameter integer DMA_ONLY  = 0,                 // 1 : transport without PIO data out, PIO in kept for SATA_IDENTIFY
+    parameter integer FIXED_GEN = 0,                 // 0 : negotiate, 1 / 2 / 3 : GEN1 / GEN2 / GEN3 only
+    parameter integer FIFO_AWIDTH = 11,              // host TX / RX FIFO depth 2**FIFO_AWIDTH Dwords
+    parameter integer SHARED_FIFO = 0,               // 1 : host TX / RX FIFOs in one paged RAM, see BUF_RX_ALLOC
+    parameter integer POOL_AWIDTH = 11               // SHARED_FIFO pool depth 2**POOL_AWIDTH Dwords
     )
     (
     input           TILE0_REFCLK_PAD_P_IN,       // Input differential clock pin P 150MHZ 
@@ -50,10 +55,21 @@ module SATA_CONTROLLER#(
     output          ILLEGAL_STATE,               // set 1 when illegal_state transition detected
     input           RX_FIFO_RESET,               // reset signal for Receive data fifo
     input           TX_FIFO_RESET,               // reset signal for Transmit data fifo
+    input   [15:0]  TX_PROG_FULL,                // WRITE_HOLD_U threshold in Dwords, 0 : build default
+    input   [15:0]  RX_PROG_FULL,                // RX FIFO level at which the link sends HOLD, 0 : build default
+    input           BUF_RX_ALLOC,                // SHARED_FIFO : 1 read, 0 write command next, taken at FIFO reset
     output          DMA_DATA_RCV_ERROR,           // indicates error during DMA data receive operation
     input           OOB_reset_IN,
     input           RX_FSM_reset_IN,
-    input           TX_FSM_reset_IN    
+    input           TX_FSM_reset_IN,
+    input  [1:0]    LOOPBACK_MODE,               // PHY near-end loopback self-test, 00 normal, 01 PCS, 10 PMA
+    output [31:0]   LB_FRAME_COUNT,              // frames accepted by the loopback responder
+    output [31:0]   LB_CRC_ERR_COUNT,            // frames rejected by the loopback responder (bad CRC)
+    input           GEN_HINT_EN,                 // start speed negotiation at GEN_HINT (e.g. GEN saved from the last link)
+    input  [1:0]    GEN_HINT,                    // same coding as GEN
+    input           HOTPLUG_EN,                  // re-run OOB on COMINIT / device removal, keeps clocks and transport state
+    input           SPEED_POLICY_EN,             // renegotiate one generation down when the link error rate is too high
+    output [31:0]   RATE_LOG                     // {count[7:0], six {cause[1:0], gen[1:0]} entries}, newest in [3:0]
     
     );
 
@@ -111,6 +127,11 @@ module SATA_CONTROLLER#(
   wire          data_in_rd_en_t;
   wire          x_rdy_sent_t;
   wire          tx_rdy_t;
+  
+  wire          bist_active;
+  wire  [31:0]  bist_words;
+  wire  [31:0]  bist_errors;
+  wire          bist_lock;
  
 
 
@@ -120,7 +141,10 @@ module SATA_CONTROLLER#(
   assign R_ERR         = r_err_t;
   assign ILLEGAL_STATE = illegal_state_t;
   
-  sata_phy PHY 
+  sata_phy #(
+    .FIXED_GEN              (FIXED_GEN)
+    )
+  PHY
   (
     .TILE0_REFCLK_PAD_P_IN  (TILE0_REFCLK_PAD_P_IN),
     .TILE0_REFCLK_PAD_N_IN  (TILE0_REFCLK_PAD_N_IN),
@@ -141,7 +165,17 @@ module SATA_CONTROLLER#(
     .logic_reset            (logic_reset),
     .OOB_reset_IN           (OOB_reset_IN),
     .RX_FSM_reset_IN        (RX_FSM_reset_IN),
-		.TX_FSM_reset_IN        (TX_FSM_reset_IN)    
+		.TX_FSM_reset_IN        (TX_FSM_reset_IN),
+    .LOOPBACK_MODE          (LOOPBACK_MODE),
+    .LB_FRAME_COUNT         (LB_FRAME_COUNT),
+    .LB_CRC_ERR_COUNT       (LB_CRC_ERR_COUNT),
+    .GEN_HINT_EN            (GEN_HINT_EN),
+    .GEN_HINT               (GEN_HINT),
+    .HOTPLUG_EN             (HOTPLUG_EN),
+    .SPEED_POLICY_EN        (SPEED_POLICY_EN),
+    .CRC_ERR_IN             (crc_err_t),
+    .R_ERR_IN               (r_err_t),
+    .RATE_LOG               (RATE_LOG)
     
 	);
   
@@ -189,12 +223,22 @@ module SATA_CONTROLLER#(
     .R_OK_SENT_T      (r_ok_sent_t),
     .data_in_rd_en_t  (data_in_rd_en_t),
     .X_RDY_SENT_T     (x_rdy_sent_t),
-    .DMA_TERMINATED   ()
+    .DMA_TERMINATED   (),
+    .BIST_ACTIVE      (bist_active),
+    .BIST_WORDS       (bist_words),
+    .BIST_ERRORS      (bist_errors),
+    .BIST_LOCK        (bist_lock)
   );
   
   assign DMA_TERMINATED = tx_termn_t_o;  
 
-  sata_transport TRANSPORT (
+  sata_transport #(
+    .DMA_ONLY         (DMA_ONLY),
+    .FIFO_AWIDTH      (FIFO_AWIDTH),
+    .SHARED_FIFO      (SHARED_FIFO),
+    .POOL_AWIDTH      (POOL_AWIDTH)
+    )
+  TRANSPORT (
     .clk                      (clk), 
     .reset                    (logic_reset), 
     .DMA_RQST                 (DMA_RQST), 
@@ -241,7 +285,14 @@ module SATA_CONTROLLER#(
     .CE                       (CE),
     .RX_FIFO_RESET            (RX_FIFO_RESET),
     .TX_FIFO_RESET            (TX_FIFO_RESET),
-    .DMA_data_rcv_error       (DMA_DATA_RCV_ERROR)
+    .TX_PROG_FULL_IN          (TX_PROG_FULL),
+    .RX_PROG_FULL_IN          (RX_PROG_FULL),
+    .BUF_RX_ALLOC             (BUF_RX_ALLOC),
+    .DMA_data_rcv_error       (DMA_DATA_RCV_ERROR),
+    .BIST_ACTIVE              (bist_active),
+    .BIST_WORDS               (bist_words),
+    .BIST_ERRORS              (bist_errors),
+    .BIST_LOCK                (bist_lock)
     );
 
 endmodule
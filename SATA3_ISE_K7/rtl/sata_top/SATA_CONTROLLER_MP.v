@@ -0,0 +1,271 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : Multi port SATA Host Controller TOP Module
+//  File name   : SATA_CONTROLLER_MP.v
+//  Note        : NUM_PORTS (1 to 4) independent SATA channels on the lanes
+//                of one GTX quad. Reference clock, QPLL, user clock MMCM and
+//                reset sequencing are shared (sata_phy_quad); every port has
+//                its own OOB / speed negotiation, link and transport layer
+//                and the same shadow register / PIO / DMA interface as
+//                SATA_CONTROLLER. Per port signals are packed in vectors,
+//                port n uses bit n, bits [2n+1:2n] of GEN, bits
+//                [5n+4:5n] of HOST_ADDR_REG and bits [32n+31:32n] of the
+//                data buses. Each port runs on its own CLK_OUT[n], which
+//                follows the GEN negotiated on that port.
+//  Design ref. : SATA3 Specification
+//  Dependencies   : sata_phy_quad, link_layer, sata_transport
+//////////////////////////////////////////////////////////////////////////////
+
+module SATA_CONTROLLER_MP#(
+    parameter integer NUM_PORTS = 4,
+    parameter integer CHIPSCOPE = 0,
+    parameter integer DMA_ONLY  = 0,                 // 1 : transports without PIO data out, PIO in kept for SATA_IDENTIFY
+    parameter integer FIXED_GEN = 0,                 // 0 : negotiate, 1 / 2 / 3 : GEN1 / GEN2 / GEN3 only
+    parameter integer FIFO_AWIDTH = 11,              // host TX / RX FIFO depth 2**FIFO_AWIDTH Dwords
+    parameter integer SHARED_FIFO = 0,               // 1 : host TX / RX FIFOs in one paged RAM, see BUF_RX_ALLOC
+    parameter integer POOL_AWIDTH = 11               // SHARED_FIFO pool depth 2**POOL_AWIDTH Dwords
+    )
+    (
+    input                       TILE0_REFCLK_PAD_P_IN,  // Input differential clock pin P 150MHZ
+    input                       TILE0_REFCLK_PAD_N_IN,  // Input differential clock pin N 150MHZ
+    input                       GTPRESET_IN,            // Reset input for GTX initialization, all ports
+    output                      TILE0_PLLLKDET_OUT,     // QPLL Lock detected output
+    output                      DCMLOCKED_OUT,          // PHY Layer MMCM locked
+    input                       OOB_reset_IN,
+    input                       RX_FSM_reset_IN,
+    input                       TX_FSM_reset_IN,
+
+    output [NUM_PORTS-1:0]      TXP_OUT,                // SATA Connector TX P pins
+    output [NUM_PORTS-1:0]      TXN_OUT,                // SATA Connector TX N pins
+    input  [NUM_PORTS-1:0]      RXP_IN,                 // SATA Connector RX P pins
+    input  [NUM_PORTS-1:0]      RXN_IN,                 // SATA Connector RX N pins
+
+    output [NUM_PORTS-1:0]      LINKUP,                 // per port LINK UP
+    output [NUM_PORTS*2-1:0]    GEN,                    // per port negotiated generation
+    output [NUM_PORTS-1:0]      CLK_OUT,                // per port LINK and Transport Layer clock out
+    input  [NUM_PORTS-1:0]      HOST_READ_EN,
+    input  [NUM_PORTS-1:0]      HOST_WRITE_EN,
+    input  [NUM_PORTS*5-1:0]    HOST_ADDR_REG,
+    input  [NUM_PORTS*32-1:0]   HOST_DATA_IN,
+    output [NUM_PORTS*32-1:0]   HOST_DATA_OUT,
+    output [NUM_PORTS-1:0]      RESET_OUT,
+    output [NUM_PORTS-1:0]      WRITE_HOLD_U,
+    output [NUM_PORTS-1:0]      READ_HOLD_U,
+    input  [NUM_PORTS-1:0]      PIO_CLK_IN,
+    input  [NUM_PORTS-1:0]      DMA_CLK_IN,
+    input  [NUM_PORTS-1:0]      DMA_RQST,
+    output [NUM_PORTS*32-1:0]   DMA_RX_DATA_OUT,
+    input  [NUM_PORTS-1:0]      DMA_RX_REN,
+    input  [NUM_PORTS*32-1:0]   DMA_TX_DATA_IN,
+    input  [NUM_PORTS-1:0]      DMA_TX_WEN,
+    input  [NUM_PORTS-1:0]      CE,
+    output [NUM_PORTS-1:0]      IPF,
+    output [NUM_PORTS-1:0]      DMA_TERMINATED,
+    output [NUM_PORTS-1:0]      R_ERR,
+    output [NUM_PORTS-1:0]      ILLEGAL_STATE,
+    input  [NUM_PORTS-1:0]      RX_FIFO_RESET,
+    input  [NUM_PORTS-1:0]      TX_FIFO_RESET,
+    input  [NUM_PORTS*16-1:0]   TX_PROG_FULL,           // per port [16n+15:16n], 0 : build default
+    input  [NUM_PORTS*16-1:0]   RX_PROG_FULL,
+    input  [NUM_PORTS-1:0]      BUF_RX_ALLOC,           // SHARED_FIFO : 1 read, 0 write command next
+    output [NUM_PORTS-1:0]      DMA_DATA_RCV_ERROR
+    );
+
+  wire  [NUM_PORTS*32-1:0]  phy_rx_data_out;
+  wire  [NUM_PORTS*4-1:0]   phy_rx_charisk_out;
+  wire  [NUM_PORTS*32-1:0]  link_tx_data_out;
+  wire  [NUM_PORTS-1:0]     link_tx_charisk_out;
+  wire  [NUM_PORTS-1:0]     linkup_int;
+  wire  [NUM_PORTS-1:0]     logic_reset;
+  wire  [NUM_PORTS-1:0]     clk;
+
+  sata_phy_quad #(
+    .NUM_PORTS              (NUM_PORTS),
+    .FIXED_GEN              (FIXED_GEN)
+    )
+  PHY
+  (
+    .TILE0_REFCLK_PAD_P_IN  (TILE0_REFCLK_PAD_P_IN),
+    .TILE0_REFCLK_PAD_N_IN  (TILE0_REFCLK_PAD_N_IN),
+    .GTXRESET_IN            (GTPRESET_IN),
+    .TILE0_PLLLKDET_OUT     (TILE0_PLLLKDET_OUT),
+    .DCMLOCKED_OUT          (DCMLOCKED_OUT),
+    .OOB_reset_IN           (OOB_reset_IN),
+    .RX_FSM_reset_IN        (RX_FSM_reset_IN),
+    .TX_FSM_reset_IN        (TX_FSM_reset_IN),
+    .TXP_OUT                (TXP_OUT),
+    .TXN_OUT                (TXN_OUT),
+    .RXP_IN                 (RXP_IN),
+    .RXN_IN                 (RXN_IN),
+    .LINKUP                 (linkup_int),
+    .logic_clk              (clk),
+    .GEN                    (GEN),
+    .tx_data_in             (link_tx_data_out),
+    .tx_charisk_in          (link_tx_charisk_out),
+    .rx_data_out            (phy_rx_data_out),
+    .rx_charisk_out         (phy_rx_charisk_out),
+    .logic_reset            (logic_reset)
+  );
+
+  assign LINKUP    = linkup_int;
+  assign CLK_OUT   = clk;
+  assign RESET_OUT = logic_reset;
+
+  genvar n;
+  generate
+    for(n = 0; n < NUM_PORTS; n = n + 1) begin : port
+
+      wire  [31:0]  trnsp_tx_data_out;
+      wire  [31:0]  link_rx_data_out;
+      wire          data_rdy_t;
+      wire          phy_detect_t;
+      wire          illegal_state_t;
+      wire          escapecf_t;
+      wire          frame_end_t;
+      wire          tx_termn_t_o;
+      wire          rx_fifo_rdy;
+      wire          rx_fail_t;
+      wire          crc_err_t;
+      wire          valid_crc_t;
+      wire          fis_err;
+      wire          good_status_t;
+      wire          unrecgnzd_fis_t;
+      wire          r_ok_t;
+      wire          r_err_t;
+      wire          sof_t;
+      wire          eof_t;
+      wire          tx_rdy_ack_t;
+      wire          data_out_vld_t;
+      wire          r_ok_sent_t;
+      wire          data_in_rd_en_t;
+      wire          x_rdy_sent_t;
+      wire          tx_rdy_t;
+      wire          hold_L;
+      wire          cmd_done;
+      wire          dma_end;
+      wire          bist_active;
+      wire  [31:0]  bist_words;
+      wire  [31:0]  bist_errors;
+      wire          bist_lock;
+
+      assign R_ERR[n]          = r_err_t;
+      assign ILLEGAL_STATE[n]  = illegal_state_t;
+      assign DMA_TERMINATED[n] = tx_termn_t_o;
+
+      link_layer #(
+        .CHIPSCOPE        (CHIPSCOPE)
+        )
+      link_layer_32bit(
+        .clk              (clk[n]),
+        .rst              (logic_reset[n]),
+        .data_in_p        (phy_rx_data_out[n*32+31:n*32]),
+        .data_in_t        (trnsp_tx_data_out),
+        .data_out_p       (link_tx_data_out[n*32+31:n*32]),
+        .data_out_t       (link_rx_data_out),
+        .PHYRDY           (linkup_int[n]),
+        .TX_RDY_T         (tx_rdy_t),
+        .PMREQ_P_T        (1'b0),
+        .PMREQ_S_T        (1'b0),
+        .PM_EN            (1'b0),
+        .LRESET           (1'b0),
+        .data_rdy_T       (data_rdy_t),
+        .phy_detect_T     (phy_detect_t),
+        .illegal_state_t  (illegal_state_t),
+        .EscapeCF_T       (escapecf_t),
+        .frame_end_T      (frame_end_t),
+        .DecErr           (1'b0),
+        .tx_termn_T_o     (tx_termn_t_o),
+        .rx_FIFO_rdy      (rx_fifo_rdy),
+        .rx_fail_T        (rx_fail_t),
+        .crc_err_T        (crc_err_t),
+        .valid_CRC_T      (valid_crc_t),
+        .FIS_err          (fis_err),
+        .Good_status_T    (good_status_t),
+        .Unrecgnzd_FIS_T  (unrecgnzd_fis_t),
+        .tx_termn_T_i     (1'b0),
+        .R_OK_T           (r_ok_t),
+        .R_ERR_T          (r_err_t),
+        .SOF_T            (sof_t),
+        .EOF_T            (eof_t),
+        .cntrl_char       (link_tx_charisk_out[n]),
+        .RX_CHARISK_IN    (phy_rx_charisk_out[n*4+1:n*4]),
+        .tx_rdy_ack_t     (tx_rdy_ack_t),
+        .data_out_vld_T   (data_out_vld_t),
+        .R_OK_SENT_T      (r_ok_sent_t),
+        .data_in_rd_en_t  (data_in_rd_en_t),
+        .X_RDY_SENT_T     (x_rdy_sent_t),
+        .DMA_TERMINATED   (),
+        .BIST_ACTIVE      (bist_active),
+        .BIST_WORDS       (bist_words),
+        .BIST_ERRORS      (bist_errors),
+        .BIST_LOCK        (bist_lock)
+      );
+
+      sata_transport #(
+        .DMA_ONLY         (DMA_ONLY),
+        .FIFO_AWIDTH      (FIFO_AWIDTH),
+        .SHARED_FIFO      (SHARED_FIFO),
+        .POOL_AWIDTH      (POOL_AWIDTH)
+        )
+      TRANSPORT (
+        .clk                      (clk[n]),
+        .reset                    (logic_reset[n]),
+        .DMA_RQST                 (DMA_RQST[n]),
+        .data_in                  (HOST_DATA_IN[n*32+31:n*32]),
+        .addr_reg                 (HOST_ADDR_REG[n*5+4:n*5]),
+        .data_link_in             (link_rx_data_out),
+        .LINK_DMA_ABORT           (tx_termn_t_o),
+        .link_fis_recved_frm_dev  (sof_t),
+        .phy_detect               (phy_detect_t),
+        .H_write                  (HOST_WRITE_EN[n]),
+        .H_read                   (HOST_READ_EN[n]),
+        .link_txr_rdy             (tx_rdy_ack_t),
+        .r_ok                     (r_ok_t),
+        .r_error                  (r_err_t),
+        .illegal_state            (illegal_state_t),
+        .end_status               (eof_t),
+        .data_link_out            (trnsp_tx_data_out),
+        .FRAME_END_T              (frame_end_t),
+        .hold_L                   (hold_L),
+        .WRITE_HOLD_U             (WRITE_HOLD_U[n]),
+        .READ_HOLD_U              (READ_HOLD_U[n]),
+        .txr_rdy                  (tx_rdy_t),
+        .data_out                 (HOST_DATA_OUT[n*32+31:n*32]),
+        .EscapeCF_T               (escapecf_t),
+        .UNRECGNZD_FIS_T          (unrecgnzd_fis_t),
+        .IPF                      (IPF[n]),
+        .FIS_ERR                  (fis_err),
+        .Good_status_T            (good_status_t),
+        .RX_FIFO_RDY              (rx_fifo_rdy),
+        .cmd_done                 (cmd_done),
+        .DMA_TX_DATA_IN           (DMA_TX_DATA_IN[n*32+31:n*32]),
+        .DMA_TX_WEN               (DMA_TX_WEN[n]),
+        .DMA_RX_DATA_OUT          (DMA_RX_DATA_OUT[n*32+31:n*32]),
+        .DMA_RX_REN               (DMA_RX_REN[n]),
+        .VALID_CRC_T              (valid_crc_t),
+        .data_out_vld_T           (data_out_vld_t),
+        .CRC_ERR_T                (crc_err_t),
+        .DMA_INIT                 (1'b 0),
+        .DMA_END                  (dma_end),
+        .DATA_RDY_T               (data_rdy_t),
+        .data_link_rd_en_t        (data_in_rd_en_t),
+        .PIO_CLK_IN               (PIO_CLK_IN[n]),
+        .DMA_CLK_IN               (DMA_CLK_IN[n]),
+        .CE                       (CE[n]),
+        .RX_FIFO_RESET            (RX_FIFO_RESET[n]),
+        .TX_FIFO_RESET            (TX_FIFO_RESET[n]),
+        .TX_PROG_FULL_IN          (TX_PROG_FULL[n*16+15:n*16]),
+        .RX_PROG_FULL_IN          (RX_PROG_FULL[n*16+15:n*16]),
+        .BUF_RX_ALLOC             (BUF_RX_ALLOC[n]),
+        .DMA_data_rcv_error       (DMA_DATA_RCV_ERROR[n]),
+        .BIST_ACTIVE              (bist_active),
+        .BIST_WORDS               (bist_words),
+        .BIST_ERRORS              (bist_errors),
+        .BIST_LOCK                (bist_lock)
+        );
+
+    end
+  endgenerate
+
+endmodule
@@ -0,0 +1,155 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : Shared TX / RX buffer pool
+//  File name   : sata_buf_pool.v
+//  Note        : Host TX and RX FIFOs of the transport in one true dual
+//                port block RAM of 2**POOL_AWIDTH Dwords, split into pages
+//                of 2**PAGE_AWIDTH Dwords. Only one direction moves data in
+//                a command, so the pages are handed to that direction :
+//                rx_alloc = 1 gives RX all pages but IDLE_PAGES, rx_alloc
+//                = 0 gives them to TX. The split is taken at reset (rst
+//                resets both rings), rx_alloc must be stable while rst is
+//                high and two clocks of each side after it.
+//                Port A runs on hclk (TX write, RX read), port B on lclk
+//                (TX read, RX write). A write has the port, the FWFT
+//                prefetch of the other ring waits a clock.
+//                Same flags as two sata_fifo with DUAL_CLOCK = 1, FWFT = 1;
+//                prog_full is relative to the pages a ring has.
+//  Design ref. : sata_fifo.v
+//  Dependencies   : sata_buf_ring.v
+//////////////////////////////////////////////////////////////////////////////
+
+module sata_buf_pool #(
+    parameter        POOL_AWIDTH       = 11,        // pool depth 2**POOL_AWIDTH
+    parameter        PAGE_AWIDTH       = 9,         // page 2**PAGE_AWIDTH, above PROG_FULL_MARGIN
+    parameter        IDLE_PAGES        = 1,         // pages left to the idle direction
+    parameter        PROG_FULL_MARGIN  = 148
+    )
+    (
+    input                        rst,
+    input                        hclk,              // host side, TX write / RX read
+    input                        lclk,              // link side, TX read / RX write
+    input                        rx_alloc,          // 1 : pages to RX, 0 : pages to TX
+
+    input      [31:0]            tx_din,
+    input                        tx_wr_en,
+    input                        tx_rd_en,
+    input      [POOL_AWIDTH:0]   tx_prog_full_thresh,
+    output reg [31:0]            tx_dout,
+    output                       tx_prog_full,
+    output                       tx_empty,
+    output                       tx_almost_empty,
+
+    input      [31:0]            rx_din,
+    input                        rx_wr_en,
+    input                        rx_rd_en,
+    input      [POOL_AWIDTH:0]   rx_prog_full_thresh,
+    output reg [31:0]            rx_dout,
+    output                       rx_full,
+    output                       rx_prog_full,
+    output                       rx_empty
+    );
+
+  localparam  PAGES     = 1 << (POOL_AWIDTH - PAGE_AWIDTH);
+  localparam  IDLE_SIZE = IDLE_PAGES << PAGE_AWIDTH;
+  localparam  BUSY_SIZE = (PAGES - IDLE_PAGES) << PAGE_AWIDTH;
+
+  reg   [31:0]             mem [0:(1<<POOL_AWIDTH)-1];
+
+  wire  [POOL_AWIDTH-1:0]  tx_base;
+  wire  [POOL_AWIDTH:0]    tx_size;
+  wire  [POOL_AWIDTH-1:0]  rx_base;
+  wire  [POOL_AWIDTH:0]    rx_size;
+
+  wire                     tx_we;
+  wire  [POOL_AWIDTH-1:0]  tx_waddr;
+  wire                     tx_re;
+  wire  [POOL_AWIDTH-1:0]  tx_raddr;
+  wire                     rx_we;
+  wire  [POOL_AWIDTH-1:0]  rx_waddr;
+  wire                     rx_re;
+  wire  [POOL_AWIDTH-1:0]  rx_raddr;
+
+  wire  [POOL_AWIDTH-1:0]  addr_a;
+  wire  [POOL_AWIDTH-1:0]  addr_b;
+
+  // TX region first, RX region after it
+  assign tx_base = 'd0;
+  assign tx_size = rx_alloc ? IDLE_SIZE : BUSY_SIZE;
+  assign rx_base = rx_alloc ? IDLE_SIZE : BUSY_SIZE;
+  assign rx_size = rx_alloc ? BUSY_SIZE : IDLE_SIZE;
+
+  sata_buf_ring #(
+    .ADDR_WIDTH        (POOL_AWIDTH),
+    .PROG_FULL_MARGIN  (PROG_FULL_MARGIN)
+    )
+  TX_RING (
+    .rst               (rst),
+    .wr_clk            (hclk),
+    .rd_clk            (lclk),
+    .base              (tx_base),
+    .size              (tx_size),
+    .wr_en             (tx_wr_en),
+    .rd_en             (tx_rd_en),
+    .rd_stall          (rx_we),
+    .prog_full_thresh  (tx_prog_full_thresh),
+    .ram_we            (tx_we),
+    .ram_waddr         (tx_waddr),
+    .ram_re            (tx_re),
+    .ram_raddr         (tx_raddr),
+    .full              (),
+    .prog_full         (tx_prog_full),
+    .empty             (tx_empty),
+    .almost_empty      (tx_almost_empty)
+  );
+
+  sata_buf_ring #(
+    .ADDR_WIDTH        (POOL_AWIDTH),
+    .PROG_FULL_MARGIN  (PROG_FULL_MARGIN)
+    )
+  RX_RING (
+    .rst               (rst),
+    .wr_clk            (lclk),
+    .rd_clk            (hclk),
+    .base              (rx_base),
+    .size              (rx_size),
+    .wr_en             (rx_wr_en),
+    .rd_en             (rx_rd_en),
+    .rd_stall          (tx_we),
+    .prog_full_thresh  (rx_prog_full_thresh),
+    .ram_we            (rx_we),
+    .ram_waddr         (rx_waddr),
+    .ram_re            (rx_re),
+    .ram_raddr         (rx_raddr),
+    .full              (rx_full),
+    .prog_full         (rx_prog_full),
+    .empty             (rx_empty),
+    .almost_empty      ()
+  );
+
+  //******** true dual port RAM, no change on write ****
+  assign addr_a = tx_we ? tx_waddr : rx_raddr;
+  assign addr_b = rx_we ? rx_waddr : tx_raddr;
+
+  always @(posedge hclk)
+  begin
+    if (tx_we) begin
+      mem[addr_a] <= tx_din;
+    end
+    else if (rx_re) begin
+      rx_dout     <= mem[addr_a];
+    end
+  end
+
+  always @(posedge lclk)
+  begin
+    if (rx_we) begin
+      mem[addr_b] <= rx_din;
+    end
+    else if (tx_re) begin
+      tx_dout     <= mem[addr_b];
+    end
+  end
+
+endmodule
@@ -0,0 +1,204 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : Buffer pool ring
+//  File name   : sata_buf_ring.v
+//  Note        : Pointer logic of one dual clock FWFT FIFO that keeps its
+//                data in a region of the shared RAM of sata_buf_pool. The
+//                region is base .. base + size - 1, size need not be a
+//                power of two : the gray coded pointers count over the
+//                whole pool (2**ADDR_WIDTH) and only the RAM addresses wrap
+//                at the region end. base and size are taken at reset, in
+//                each clock domain, and must be stable while rst is high
+//                and two clocks after.
+//                rd_stall : the RAM port is used by the other ring this
+//                clock, the FWFT prefetch waits (empty may then go high
+//                for a clock). Writes are never stalled.
+//                prog_full : wr_data_count >= size - PROG_FULL_MARGIN, or
+//                >= prog_full_thresh when that is not 0 and lower.
+//  Design ref. : sata_fifo.v
+//  Dependencies   : Nil
+//////////////////////////////////////////////////////////////////////////////
+
+module sata_buf_ring #(
+    parameter        ADDR_WIDTH        = 11,        // pool depth 2**ADDR_WIDTH
+    parameter        PROG_FULL_MARGIN  = 148
+    )
+    (
+    input                        rst,
+    input                        wr_clk,
+    input                        rd_clk,
+    input      [ADDR_WIDTH-1:0]  base,
+    input      [ADDR_WIDTH:0]    size,
+    input                        wr_en,
+    input                        rd_en,
+    input                        rd_stall,
+    input      [ADDR_WIDTH:0]    prog_full_thresh,          // 0 : size - PROG_FULL_MARGIN
+    output                       ram_we,
+    output reg [ADDR_WIDTH-1:0]  ram_waddr,
+    output                       ram_re,
+    output reg [ADDR_WIDTH-1:0]  ram_raddr,
+    output                       full,
+    output reg                   prog_full,
+    output                       empty,
+    output                       almost_empty
+    );
+
+  reg   [1:0]             wr_rst_s;
+  reg   [1:0]             rd_rst_s;
+  wire                    wr_rst;
+  wire                    rd_rst;
+
+  reg   [ADDR_WIDTH-1:0]  wr_base;
+  reg   [ADDR_WIDTH:0]    wr_size;
+  reg   [ADDR_WIDTH-1:0]  rd_base;
+  reg   [ADDR_WIDTH:0]    rd_size;
+
+  reg   [ADDR_WIDTH:0]    wr_bin;
+  reg   [ADDR_WIDTH:0]    wr_gray;
+  reg   [ADDR_WIDTH:0]    rd_bin;
+  reg   [ADDR_WIDTH:0]    rd_gray;
+  reg   [ADDR_WIDTH:0]    rd_gray_s1, rd_gray_s2;   // read pointer in wr_clk
+  reg   [ADDR_WIDTH:0]    wr_gray_s1, wr_gray_s2;   // write pointer in rd_clk
+  wire  [ADDR_WIDTH:0]    rd_bin_w;
+  wire  [ADDR_WIDTH:0]    wr_bin_r;
+
+  wire  [ADDR_WIDTH:0]    wr_cnt;
+  wire  [ADDR_WIDTH:0]    ram_cnt;
+  wire  [ADDR_WIDTH:0]    rd_cnt;
+  wire  [ADDR_WIDTH:0]    pf_max;
+  wire  [ADDR_WIDTH:0]    pf_thresh;
+  reg                     dout_vld;
+
+  function [ADDR_WIDTH:0] gray2bin;
+    input [ADDR_WIDTH:0] g;
+    integer              i;
+    begin
+      gray2bin[ADDR_WIDTH] = g[ADDR_WIDTH];
+      for (i = ADDR_WIDTH - 1; i >= 0; i = i - 1) begin
+        gray2bin[i] = gray2bin[i+1] ^ g[i];
+      end
+    end
+  endfunction
+
+  //******** reset release ****
+  always @(posedge wr_clk, posedge rst)
+  begin
+    if (rst) begin
+      wr_rst_s <= 2'b11;
+    end
+    else begin
+      wr_rst_s <= {wr_rst_s[0], 1'b0};
+    end
+  end
+
+  always @(posedge rd_clk, posedge rst)
+  begin
+    if (rst) begin
+      rd_rst_s <= 2'b11;
+    end
+    else begin
+      rd_rst_s <= {rd_rst_s[0], 1'b0};
+    end
+  end
+
+  assign wr_rst = wr_rst_s[1];
+  assign rd_rst = rd_rst_s[1];
+
+  //******** pointer crossing ****
+  always @(posedge wr_clk, posedge rst)
+  begin
+    if (rst) begin
+      rd_gray_s1 <= 'd0;
+      rd_gray_s2 <= 'd0;
+    end
+    else begin
+      rd_gray_s1 <= rd_gray;
+      rd_gray_s2 <= rd_gray_s1;
+    end
+  end
+
+  always @(posedge rd_clk, posedge rst)
+  begin
+    if (rst) begin
+      wr_gray_s1 <= 'd0;
+      wr_gray_s2 <= 'd0;
+    end
+    else begin
+      wr_gray_s1 <= wr_gray;
+      wr_gray_s2 <= wr_gray_s1;
+    end
+  end
+
+  assign rd_bin_w = gray2bin(rd_gray_s2);
+  assign wr_bin_r = gray2bin(wr_gray_s2);
+
+  //******** write side ****
+  assign wr_cnt    = wr_bin - rd_bin_w;
+  assign full      = (wr_cnt >= wr_size) || wr_rst;
+  assign ram_we    = wr_en && !full;
+  assign pf_max    = wr_size - PROG_FULL_MARGIN;
+  assign pf_thresh = (prog_full_thresh != 'd0 && prog_full_thresh < pf_max) ? prog_full_thresh : pf_max;
+
+  always @(posedge wr_clk, posedge rst)
+  begin
+    if (rst) begin
+      wr_bin    <= 'd0;
+      wr_gray   <= 'd0;
+      wr_base   <= 'd0;
+      wr_size   <= 'd0;
+      ram_waddr <= 'd0;
+      prog_full <= 1'b0;
+    end
+    else if (wr_rst) begin
+      wr_base   <= base;
+      wr_size   <= size;
+      ram_waddr <= base;
+      prog_full <= 1'b0;
+    end
+    else begin
+      if (ram_we) begin
+        wr_bin    <= wr_bin + 1'b1;
+        wr_gray   <= (wr_bin + 1'b1) ^ ((wr_bin + 1'b1) >> 1);
+        ram_waddr <= (ram_waddr == wr_base + wr_size - 1'b1) ? wr_base : ram_waddr + 1'b1;
+      end
+      prog_full <= (wr_cnt + ram_we >= pf_thresh);
+    end
+  end
+
+  //******** read side ****
+  assign ram_cnt      = wr_bin_r - rd_bin;
+  assign ram_re       = (ram_cnt != 'd0) && !rd_rst && !rd_stall && (!dout_vld || rd_en);
+  assign rd_cnt       = ram_cnt + dout_vld;
+  assign empty        = !dout_vld;
+  assign almost_empty = (rd_cnt <= 1);
+
+  always @(posedge rd_clk, posedge rst)
+  begin
+    if (rst) begin
+      rd_bin    <= 'd0;
+      rd_gray   <= 'd0;
+      rd_base   <= 'd0;
+      rd_size   <= 'd0;
+      ram_raddr <= 'd0;
+      dout_vld  <= 1'b0;
+    end
+    else if (rd_rst) begin
+      rd_base   <= base;
+      rd_size   <= size;
+      ram_raddr <= base;
+    end
+    else begin
+      if (ram_re) begin
+        rd_bin    <= rd_bin + 1'b1;
+        rd_gray   <= (rd_bin + 1'b1) ^ ((rd_bin + 1'b1) >> 1);
+        ram_raddr <= (ram_raddr == rd_base + rd_size - 1'b1) ? rd_base : ram_raddr + 1'b1;
+        dout_vld  <= 1'b1;
+      end
+      else if (rd_en) begin
+        dout_vld  <= 1'b0;
+      end
+    end
+  end
+
+endmodule
@@ -0,0 +1,217 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : Parameterized FIFO
+//  File name   : sata_fifo.v
+//  Note        : Inferred block RAM FIFO, 2**ADDR_WIDTH x DATA_WIDTH,
+//                replaces the TX_FIFO, RX_FIFO and fifo_generator_v8_3
+//                cores with the same port names.
+//                DUAL_CLOCK = 1 : independent wr_clk / rd_clk, the
+//                pointers cross in gray code through two flops, so the
+//                flags and counts of the other side lag by 2-3 clocks
+//                (in the safe direction, as the Xilinx core).
+//                DUAL_CLOCK = 0 : common clock, rd_clk is not used and
+//                all flags are exact.
+//                FWFT = 1 : first word fall through, dout is valid
+//                whenever empty is low and rd_en takes it. FWFT = 0 :
+//                standard FIFO, dout is valid the clock after rd_en.
+//                prog_full  : wr_data_count >= PROG_FULL_THRESH, or
+//                             >= prog_full_thresh when that is not 0;
+//                             the port is sampled in wr_clk and is meant
+//                             to be changed while the FIFO is idle
+//                prog_empty : rd_data_count <= PROG_EMPTY_THRESH
+//                almost_full / almost_empty : one word from full / empty.
+//                rst is asynchronous, its release is synchronised to
+//                each clock.
+//  Design ref. : Nil
+//  Dependencies   : Nil
+//////////////////////////////////////////////////////////////////////////////
+
+module sata_fifo #(
+    parameter        DATA_WIDTH        = 32,
+    parameter        ADDR_WIDTH        = 11,        // depth 2**ADDR_WIDTH
+    parameter        DUAL_CLOCK        = 1,
+    parameter        FWFT              = 1,
+    parameter        PROG_FULL_THRESH  = 1900,
+    parameter        PROG_EMPTY_THRESH = 4
+    )
+    (
+    input                        rst,
+    input                        wr_clk,
+    input                        rd_clk,
+    input      [DATA_WIDTH-1:0]  din,
+    input                        wr_en,
+    input                        rd_en,
+    input      [ADDR_WIDTH:0]    prog_full_thresh,          // 0 : PROG_FULL_THRESH
+    output reg [DATA_WIDTH-1:0]  dout,
+    output                       full,
+    output                       almost_full,
+    output reg                   prog_full,
+    output                       empty,
+    output                       almost_empty,
+    output                       prog_empty,
+    output     [ADDR_WIDTH:0]    wr_data_count,
+    output     [ADDR_WIDTH:0]    rd_data_count
+    );
+
+  localparam  DEPTH = 1 << ADDR_WIDTH;
+
+  reg   [DATA_WIDTH-1:0]  mem [0:DEPTH-1];
+
+  wire                    rclk;
+  reg   [1:0]             wr_rst_s;
+  reg   [1:0]             rd_rst_s;
+  wire                    wr_rst;
+  wire                    rd_rst;
+
+  reg   [ADDR_WIDTH:0]    wr_bin;
+  reg   [ADDR_WIDTH:0]    wr_gray;
+  reg   [ADDR_WIDTH:0]    rd_bin;
+  reg   [ADDR_WIDTH:0]    rd_gray;
+  reg   [ADDR_WIDTH:0]    rd_gray_s1, rd_gray_s2;   // read pointer in wr_clk
+  reg   [ADDR_WIDTH:0]    wr_gray_s1, wr_gray_s2;   // write pointer in rd_clk
+  wire  [ADDR_WIDTH:0]    rd_bin_w;
+  wire  [ADDR_WIDTH:0]    wr_bin_r;
+
+  wire  [ADDR_WIDTH:0]    wr_cnt;
+  wire  [ADDR_WIDTH:0]    ram_cnt;                  // words in the RAM, read side
+  wire                    wr_ok;
+  wire  [ADDR_WIDTH:0]    pf_thresh;
+  wire                    ram_rd;
+  reg                     dout_vld;                 // FWFT output register holds a word
+
+  function [ADDR_WIDTH:0] gray2bin;
+    input [ADDR_WIDTH:0] g;
+    integer              i;
+    begin
+      gray2bin[ADDR_WIDTH] = g[ADDR_WIDTH];
+      for (i = ADDR_WIDTH - 1; i >= 0; i = i - 1) begin
+        gray2bin[i] = gray2bin[i+1] ^ g[i];
+      end
+    end
+  endfunction
+
+  assign rclk = DUAL_CLOCK ? rd_clk : wr_clk;
+
+  //******** reset release ****
+  always @(posedge wr_clk, posedge rst)
+  begin
+    if (rst) begin
+      wr_rst_s <= 2'b11;
+    end
+    else begin
+      wr_rst_s <= {wr_rst_s[0], 1'b0};
+    end
+  end
+
+  always @(posedge rclk, posedge rst)
+  begin
+    if (rst) begin
+      rd_rst_s <= 2'b11;
+    end
+    else begin
+      rd_rst_s <= {rd_rst_s[0], 1'b0};
+    end
+  end
+
+  assign wr_rst = wr_rst_s[1];
+  assign rd_rst = rd_rst_s[1];
+
+  //******** pointer crossing ****
+  always @(posedge wr_clk, posedge rst)
+  begin
+    if (rst) begin
+      rd_gray_s1 <= 'd0;
+      rd_gray_s2 <= 'd0;
+    end
+    else begin
+      rd_gray_s1 <= rd_gray;
+      rd_gray_s2 <= rd_gray_s1;
+    end
+  end
+
+  always @(posedge rclk, posedge rst)
+  begin
+    if (rst) begin
+      wr_gray_s1 <= 'd0;
+      wr_gray_s2 <= 'd0;
+    end
+    else begin
+      wr_gray_s1 <= wr_gray;
+      wr_gray_s2 <= wr_gray_s1;
+    end
+  end
+
+  assign rd_bin_w = DUAL_CLOCK ? gray2bin(rd_gray_s2) : rd_bin;
+  assign wr_bin_r = DUAL_CLOCK ? gray2bin(wr_gray_s2) : wr_bin;
+
+  //******** write side ****
+  assign wr_cnt        = wr_bin - rd_bin_w;
+  assign full          = (wr_cnt == DEPTH) || wr_rst;
+  assign almost_full   = (wr_cnt >= DEPTH - 1) || wr_rst;
+  assign wr_data_count = wr_cnt;
+  assign wr_ok         = wr_en && !full;
+  assign pf_thresh     = (prog_full_thresh != 'd0) ? prog_full_thresh : PROG_FULL_THRESH;
+
+  always @(posedge wr_clk)
+  begin
+    if (wr_ok) begin
+      mem[wr_bin[ADDR_WIDTH-1:0]] <= din;
+    end
+  end
+
+  always @(posedge wr_clk, posedge rst)
+  begin
+    if (rst) begin
+      wr_bin    <= 'd0;
+      wr_gray   <= 'd0;
+      prog_full <= 1'b0;
+    end
+    else if (wr_rst) begin
+      prog_full <= 1'b0;
+    end
+    else begin
+      if (wr_ok) begin
+        wr_bin    <= wr_bin + 1'b1;
+        wr_gray   <= (wr_bin + 1'b1) ^ ((wr_bin + 1'b1) >> 1);
+      end
+      prog_full <= (wr_cnt + wr_ok >= pf_thresh);
+    end
+  end
+
+  //******** read side ****
+  assign ram_cnt       = wr_bin_r - rd_bin;
+  assign ram_rd        = (ram_cnt != 'd0) && !rd_rst &&
+                         (FWFT ? (!dout_vld || rd_en) : rd_en);
+  assign rd_data_count = FWFT ? ram_cnt + dout_vld : ram_cnt;
+  assign empty         = FWFT ? !dout_vld : (ram_cnt == 'd0);
+  assign almost_empty  = (rd_data_count <= 1);
+  assign prog_empty    = (rd_data_count <= PROG_EMPTY_THRESH);
+
+  always @(posedge rclk)
+  begin
+    if (ram_rd) begin
+      dout <= mem[rd_bin[ADDR_WIDTH-1:0]];
+    end
+  end
+
+  always @(posedge rclk, posedge rst)
+  begin
+    if (rst) begin
+      rd_bin   <= 'd0;
+      rd_gray  <= 'd0;
+      dout_vld <= 1'b0;
+    end
+    else begin
+      if (ram_rd) begin
+        rd_bin   <= rd_bin + 1'b1;
+        rd_gray  <= (rd_bin + 1'b1) ^ ((rd_bin + 1'b1) >> 1);
+        dout_vld <= 1'b1;
+      end
+      else if (rd_en) begin
+        dout_vld <= 1'b0;
+      end
+    end
+  end
+
+endmodule
@@ -49,13 +49,31 @@ module sata_transport (
    input                CE,                           // Chip enable,
    input                RX_FIFO_RESET,                // RX fifo reset
    input                TX_FIFO_RESET,                // TX fifo reset
-   output reg           DMA_data_rcv_error            // Indicates error during DMA data receive
+   input     [15:0]     TX_PROG_FULL_IN,              // WRITE_HOLD_U threshold in Dwords, 0 : TX_PROG_FULL
+   input     [15:0]     RX_PROG_FULL_IN,              // RX_FIFO_RDY (link HOLD) threshold in Dwords, 0 : RX_PROG_FULL
+   input                BUF_RX_ALLOC,                 // SHARED_FIFO : 1 pool pages to RX, 0 to TX, taken at FIFO reset
+   output reg           DMA_data_rcv_error,           // Indicates error during DMA data receive
+   output reg           BIST_ACTIVE,                  // to LL : BIST Activate FIS accepted, link sends and checks the test pattern
+   input     [31:0]     BIST_WORDS,                   // from LL : Dwords checked by the BIST checker
+   input     [31:0]     BIST_ERRORS,                  // from LL : mismatching Dwords
+   input                BIST_LOCK                     // from LL : BIST checker locked to the returned pattern
 
    ); 
    
 
 
    parameter    DMA_WR_MAX_COUNT = 'h2000; //'h200; //'d8192 bytes
+   parameter    DMA_ONLY         = 0;      // 1 : PIO data out removed, a host to device PIO Setup FIS is rejected
+                                           //     as unrecognized and the TX FIFO always uses the DMA port. PIO data
+                                           //     in is kept for IDENTIFY DEVICE (SATA_IDENTIFY), the RX FIFO and
+                                           //     PIO_CLK_IN still follow DMA_RQST
+   parameter    FIFO_AWIDTH      = 11;     // host TX / RX FIFO depth 2**FIFO_AWIDTH Dwords
+   parameter    TX_PROG_FULL     = (1 << FIFO_AWIDTH) - 148;   // WRITE_HOLD_U threshold, 1900 for 2048
+   parameter    RX_PROG_FULL     = (1 << FIFO_AWIDTH) - 148;   // RX_FIFO_RDY threshold, the link sends HOLD above it
+   parameter    LL_FIFO_AWIDTH   = 11;     // transport -> link FIFO depth
+   parameter    SHARED_FIFO      = 0;      // 1 : host TX and RX FIFOs share one paged RAM (sata_buf_pool)
+   parameter    POOL_AWIDTH      = 11;     // shared pool depth 2**POOL_AWIDTH Dwords
+   parameter    POOL_PAGE_AWIDTH = 9;      // shared pool page 2**POOL_PAGE_AWIDTH Dwords
       
    reg [7:0 ]   command_register;       
    reg [15:0]   features_register;
@@ -68,6 +86,10 @@ module sata_transport (
    reg [15:0]   sector_count_register;
    reg [7:0 ]   status_register;
    reg [31:0]   data_register_in;
+   reg [3:0 ]   pm_port_register;      // port multiplier port of the next command / control FIS
+   reg [7:0 ]   bist_pattern;          // pattern definition of the BIST Activate FIS to send
+   reg [31:0]   bist_data1;            // BIST Activate FIS DW1
+   reg [31:0]   bist_data2;            // BIST Activate FIS DW2
    wire [31:0]   data_register_out;
    
                 
@@ -183,6 +205,16 @@ module sata_transport (
    reg       [3:0]  rst_delay_count;
    reg       [4:0]  dest_state;
    
+   // port multiplier, per port shadow state
+   reg       [7:0]  pm_status_shadow [0:15];
+   reg       [7:0]  pm_error_shadow  [0:15];
+   reg      [15:0]  pm_event;          // a register / set device bits FIS arrived from the port
+   reg       [4:0]  pm_index;
+   
+   reg              bist_en;
+   reg              bist_rcvd;         // BIST Activate FIS received from the device
+   reg       [7:0]  bist_rx_pattern;
+   
    wire             tx_fifo1_reset;
    wire             rx_fifo1_reset;
    
@@ -207,11 +239,16 @@ module sata_transport (
    wire             rcv_fifo_prog_full;
    wire             rx_fifo_pio_rd_en;
    wire             rx_fifo_rd_clk;
+   wire             dma_path;
    wire             tx_fifo_prog_full;
+   wire  [15:0]     tx_pf_thresh;
+   wire  [15:0]     rx_pf_thresh;
    wire             tl_ll_tx_fifo_full;
    wire             tx_fifo_almost_empty;
    
    wire      [31:0] tx_fifo_din;
+   wire       [3:0] rx_pm_port;
+   wire             rx_port_match;
 
 /*************************states************************************/
 
@@ -241,6 +278,8 @@ module sata_transport (
    parameter HT_DMAOTrans2         =   5'h 16      ;
    parameter HT_DMAEnd             =   5'h 17      ;
    parameter HT_tl_ll_tx_fifo_rst_delay = 5'h 18;       
+   parameter HT_BISTFIS            =   5'h 19      ;
+   parameter HT_BISTTransStatus    =   5'h 1A      ;
    
 /***************ADDRESS PARAMETER***************************************/
 
@@ -256,12 +295,20 @@ module sata_transport (
    parameter lba_high              =  8'd9        ;
    parameter sect_count            =  8'd10       ;
    parameter data_reg              =  8'd11       ;
+   parameter pm_port_reg           =  8'd12       ;
+   parameter pm_sts_reg            =  8'd13       ;
+   parameter bist_reg              =  8'd14       ;
+   parameter bist_data1_reg        =  8'd15       ;   // write : FIS DW1, read : BIST error count
+   parameter bist_data2_reg        =  8'd16       ;   // write : FIS DW2, read : BIST Dword count
    
    parameter DEVICE_RESET          = 8'h08       ;
    
    //assign Transfer_cnt_DMA      = sector_count_register;
+   // PM port field of the received FIS, only FISes of the selected port update the shadow registers
+   assign rx_pm_port            = fis_reg_DW0[11:8];
+   assign rx_port_match         = (rx_pm_port == pm_port_register);
    assign rx_ren_pio            = (~rcv_fifo_almost_empty);
-   assign txr_ren_pio           = (~tx_fifo_empty && link_txr_rdy_PIO && (state == HT_PIOOTrans2 ) && (count!= 'd2044));
+   assign txr_ren_pio           = !DMA_ONLY && (~tx_fifo_empty && link_txr_rdy_PIO && (state == HT_PIOOTrans2 ) && (count!= 'd2044));
    assign link_txr_rdy_PIO      = link_txr_rdy? 1'b1:txr_ren_pio;
    //assign tx_fifo_dma_rd_en     = (~tx_fifo_empty && link_txr_rdy_PIO && (state == HT_DMAOTrans2 ) && (count!= 'd2044));
    
@@ -283,7 +330,7 @@ module sata_transport (
       Transfer_cnt_PIO       <= 1'b0  ;
     end
     else begin
-      if(state == HT_PIOITrans1 || state == HT_PIOOTrans1) begin  
+      if(state == HT_PIOITrans1 || (!DMA_ONLY && state == HT_PIOOTrans1)) begin  
         Transfer_cnt_PIO  <= fis_reg_DW4[15:0] ; 
       end
       else begin
@@ -323,6 +370,40 @@ module sata_transport (
     
   end
 
+  //***************************** BIST Activate FIS request, BIST state *****************************
+  // BIST is left only through COMRESET, the link goes down and BIST_ACTIVE is cleared
+  always @(posedge clk, posedge reset) begin
+    if(reset) begin  
+      bist_en      <= 1'b0  ;
+      BIST_ACTIVE  <= 1'b0  ;
+    end
+    else if(!phy_detect) begin
+      bist_en      <= 1'b0  ;
+      BIST_ACTIVE  <= 1'b0  ;
+    end
+    else if(addr_reg == bist_reg && H_write && CE && !status_register[7] && !status_register[3] && !BIST_ACTIVE)
+      bist_en      <= 1'b1  ;
+    else if(state == HT_BISTTransStatus && r_ok) begin
+      bist_en      <= 1'b0  ;
+      BIST_ACTIVE  <= 1'b1  ;
+    end
+    else if(state == HT_BISTTransStatus && (r_error || illegal_state))
+      bist_en      <= 1'b0  ;
+  end
+  
+  always @(posedge clk, posedge reset) begin
+    if(reset) begin  
+      bist_rcvd       <= 1'b0  ;
+      bist_rx_pattern <= 8'h00 ;
+    end
+    else if(state == HT_RcvBIST && VALID_CRC_T) begin
+      bist_rcvd       <= 1'b1  ;
+      bist_rx_pattern <= fis_reg_DW0[23:16] ;
+    end
+    else if(H_read && addr_reg == bist_reg && CE)
+      bist_rcvd       <= 1'b0  ;
+  end
+
   //*****************************************status register updation******************************************************
 
   always @(posedge clk, posedge reset)
@@ -342,9 +423,13 @@ module sata_transport (
       detection       <= 1'b0  ;
       Status_init     <= 1'b0  ;
     end  
-    else if(state == HT_RegTransStatus && VALID_CRC_T)  begin  
+    else if(state == HT_RegTransStatus && VALID_CRC_T && rx_port_match)  begin  
       status_register <= fis_reg_DW0[23:16] ;
     end
+    else if(state == HT_DB_FIS && VALID_CRC_T && rx_port_match)  begin  
+      status_register[6:4] <= fis_reg_DW0[22:20] ; // Set Device Bits : BSY and DRQ are not changed
+      status_register[2:0] <= fis_reg_DW0[18:16] ;
+    end
     else if(H_write && (addr_reg == cmd_reg ) && CE) begin  
       status_register[7] <= 1'd1 ;
     end 
@@ -403,7 +488,7 @@ module sata_transport (
       IPF <= 0;
     end
     else begin
-      if((state == HT_RegTransStatus && VALID_CRC_T) ||                                        
+      if((state == HT_RegTransStatus && VALID_CRC_T && rx_port_match) ||                                        
               (state == HT_PIOITrans1) || 
               (state == HT_PIOOTrans1) ) begin
               
@@ -425,6 +510,37 @@ module sata_transport (
   end //always
   
   
+  //Port multiplier : status and error of the last register / set device bits FIS of every port.
+  //pm_event bit of the selected port is cleared when pm_sts_reg is read.
+  always @(posedge clk, posedge reset)
+  begin
+    if(reset) begin
+      pm_event <= 16'h0;
+      for(pm_index = 0; pm_index < 16; pm_index = pm_index + 1) begin
+        pm_status_shadow[pm_index] <= 8'h80;
+        pm_error_shadow[pm_index]  <= 8'h00;
+      end
+    end
+    else begin
+      if (H_read && addr_reg == pm_sts_reg && CE) begin
+        pm_event[pm_port_register] <= 0;
+      end
+      
+      if(state == HT_RegTransStatus && VALID_CRC_T) begin
+        pm_status_shadow[rx_pm_port] <= fis_reg_DW0[23:16];
+        pm_error_shadow[rx_pm_port]  <= fis_reg_DW0[31:24];
+        pm_event[rx_pm_port]         <= 1;
+      end
+      else if(state == HT_DB_FIS && VALID_CRC_T) begin
+        pm_status_shadow[rx_pm_port] <= {pm_status_shadow[rx_pm_port][7], fis_reg_DW0[22:20],
+                                         pm_status_shadow[rx_pm_port][3], fis_reg_DW0[18:16]};
+        pm_error_shadow[rx_pm_port]  <= fis_reg_DW0[31:24];
+        pm_event[rx_pm_port]         <= 1;
+      end
+    end
+  end //always
+  
+  
   //*************************************************************************************************
   //..................register writing for shadow registers and trigger generation..................*
   //*************************************************************************************************
@@ -440,6 +556,10 @@ module sata_transport (
       lba_mid_register      <=  16'h0000  ;    
       lba_high_register     <=  16'h0000  ;   
       sector_count_register <=  16'h0000  ;               
+      pm_port_register      <=  4'h0      ;
+      bist_pattern          <=  8'h00     ;
+      bist_data1            <=  32'd0     ;
+      bist_data2            <=  32'd0     ;
       data_register_in      <=  32'd0   ;
       //IPF                   <=  1'b0    ; 
       //HOLD_U                <=  1'b0    ;
@@ -531,9 +651,31 @@ module sata_transport (
             //  tx_fifo_pio_wr_en <= 0;              
             //end
           end                      
+          pm_port_reg: begin
+            // not gated by BSY : the host has to be able to leave a port that does not answer
+            tx_fifo_pio_wr_en <= 0;
+            pm_port_register  <= data_in[3:0];
+          end
+          bist_reg: begin
+            tx_fifo_pio_wr_en <= 0;
+            if((!status_register[7] && !status_register[3]))begin        
+              bist_pattern <= data_in[7:0];
+            end
+            else begin
+              bist_pattern <= bist_pattern;
+            end  
+          end
+          bist_data1_reg: begin
+            tx_fifo_pio_wr_en <= 0;
+            bist_data1        <= data_in;
+          end
+          bist_data2_reg: begin
+            tx_fifo_pio_wr_en <= 0;
+            bist_data2        <= data_in;
+          end
         endcase
       end 
-      else if((state == HT_RegTransStatus && VALID_CRC_T) ||                                        
+      else if((state == HT_RegTransStatus && VALID_CRC_T && rx_port_match) ||                                        
               (state == HT_PIOITrans1) || 
               (state == HT_PIOOTrans1) ) begin
         //if (control_register[1] == 1) begin
@@ -614,6 +756,26 @@ module sata_transport (
          begin
            data_out <= data_register_out; 
          end                                 
+         pm_port_reg:
+         begin
+           data_out <= {24'h0, rx_pm_port, pm_port_register};
+         end
+         pm_sts_reg:
+         begin
+           data_out <= {pm_event, pm_error_shadow[pm_port_register], pm_status_shadow[pm_port_register]};
+         end
+         bist_reg:
+         begin
+           data_out <= {13'h0, BIST_LOCK, bist_rcvd, BIST_ACTIVE, bist_rx_pattern, bist_pattern};
+         end
+         bist_data1_reg:
+         begin
+           data_out <= BIST_ERRORS;
+         end
+         bist_data2_reg:
+         begin
+           data_out <= BIST_WORDS;
+         end
          default:                        
          begin                               
           data_out <= 'h80;         
@@ -710,10 +872,16 @@ module sata_transport (
             fis_count           <= 3'd0;
             tl_ll_tx_fifo_reset <= 1;
           end
-          else if(prvs_pio  && !tx_fifo_empty ) begin  //H_write && (addr_reg == data_reg)
+          else if(bist_en) begin      
+            dest_state          <= HT_BISTFIS;
+            state               <= HT_tl_ll_tx_fifo_rst_delay;   
+            fis_count           <= 3'd0;
+            tl_ll_tx_fifo_reset <= 1;
+          end
+          else if(!DMA_ONLY && prvs_pio  && !tx_fifo_empty ) begin  //H_write && (addr_reg == data_reg)
             tl_ll_tx_fifo_reset <= 0;
             if(link_txr_rdy) begin      
-              data_link_out_int   <= 32'h0046;
+              data_link_out_int   <= {20'h0, pm_port_register, 8'h46};
               data_link_out_wr_en <= 1;
               tx_fifo_pio_rd_en   <= 1;
               txr_rdy             <= 1'b0;
@@ -775,7 +943,7 @@ module sata_transport (
               prvs_pio        <= 1'b0;
               UNRECGNZD_FIS_T <= 0;
             end
-            else if(data_link_in[7:0] == 8'h5F) begin  //PIO Setup FIS Device to Host
+            else if(data_link_in[7:0] == 8'h5F && (!DMA_ONLY || data_link_in[13])) begin  //PIO Setup FIS Device to Host
               state           <= HT_PS_FIS;
               prvs_pio        <= 1'b1;
               UNRECGNZD_FIS_T <= 0;
@@ -787,7 +955,7 @@ module sata_transport (
               UNRECGNZD_FIS_T <= 0;
             end
             else if(data_link_in[7:0] == 8'h58) begin  //BIST Active FIS Bi-Directional
-              state           <= HT_HostIdle; //HT_RcvBIST; not implemented
+              state           <= HT_RcvBIST;
               prvs_pio        <= 1'b0;
               UNRECGNZD_FIS_T <= 0;
             end
@@ -834,7 +1002,7 @@ module sata_transport (
           end
           else if(link_txr_rdy) begin      
             txr_rdy             <= 0;
-            data_link_out_int   <= {features_register[7:0],command_register,8'h80,8'h27};
+            data_link_out_int   <= {features_register[7:0],command_register,4'h8,pm_port_register,8'h27};
             fis_count           <= fis_count + 1;
             //data_rdy_T          <= 1'b1;
             state               <= state;
@@ -902,7 +1070,7 @@ module sata_transport (
           else if(link_txr_rdy) begin      
             txr_rdy             <= 1'b0        ;
             //data_link_out_int   <= {features_register[7:0],command_register,8'h00,8'h27} ;
-            data_link_out_int   <= {24'h 0, 8'h 27};
+            data_link_out_int   <= {16'h 0, 4'h 0, pm_port_register, 8'h 27};
             data_link_out_wr_en <= 1;
             fis_count           <= fis_count+1 ;
             //data_rdy_T        <= 1'b1        ;
@@ -943,6 +1111,84 @@ module sata_transport (
           end 
         end         
              
+        HT_BISTFIS:   //BIST Activate FIS, pattern definition in byte 2
+        begin
+          tl_ll_tx_fifo_reset <= 0;
+          if(link_fis_recved_frm_dev) begin      
+            state               <= HT_ChkTyp;        // new Fis is received in the linklayer from device
+            fis_count           <= 3'd0;
+            data_link_out_wr_en <= 0;
+          end
+          else if(illegal_state) begin      
+            state               <= HT_HostIdle;
+            data_link_out_wr_en <= 0;
+          end
+          else if(link_txr_rdy) begin      
+            txr_rdy             <= 1'b0;
+            data_link_out_int   <= {8'h 0, bist_pattern, 4'h 0, pm_port_register, 8'h 58};
+            data_link_out_wr_en <= 1;
+            fis_count           <= fis_count + 1;
+            state               <= state;
+          end
+          else if(fis_count == 3'd1) begin      
+            data_link_out_int   <= bist_data1;
+            data_link_out_wr_en <= 1;
+            fis_count           <= fis_count + 1;
+            state               <= state;
+          end
+          else if(fis_count == 3'd2) begin      
+            data_link_out_int   <= bist_data2;
+            data_link_out_wr_en <= 1;
+            fis_count           <= 3'd0;
+            state               <= HT_BISTTransStatus;
+          end
+          else begin      
+            state               <= state;
+            data_link_out_wr_en <= 0;
+          end 
+        end
+        
+        HT_BISTTransStatus:
+        begin
+          data_link_out_wr_en <= 0;
+          if(r_ok || r_error || illegal_state) begin       
+            state <= HT_HostIdle;
+          end
+          else begin      
+            state <= state;
+          end
+        end
+        
+        HT_RcvBIST:   //BIST Activate FIS from the device, reported through bist_reg
+        begin
+          if(data_out_vld_T && fis_count <= 3'd2) begin
+            fis_count   <= fis_count + 1'b1;
+            if(fis_count == 3'd1) begin
+              fis_reg_DW1 <= data_link_in;
+            end
+            else begin
+              fis_reg_DW2 <= data_link_in;
+            end
+          end
+          if(VALID_CRC_T) begin       
+            Good_status_T <= 1'b1;
+            state         <= HT_HostIdle;
+          end            
+          else if(CRC_ERR_T) begin                                   
+            FIS_ERR       <= 1'b1;
+            state         <= HT_HostIdle;
+            Good_status_T <= 1'b0;
+          end
+          else if(illegal_state) begin       
+            state         <= HT_HostIdle;
+            Good_status_T <= 1'b0;
+          end
+          else begin      
+            state         <= HT_RcvBIST;
+            Good_status_T <= 1'b0;
+          end
+        end
+        
         HT_CtrlTransStatus:
         begin
           data_link_out_wr_en <= 0;
@@ -970,7 +1216,7 @@ module sata_transport (
           end 
           else if(link_txr_rdy) begin       
             txr_rdy       <= 1'b0                ;
-            data_link_out_int <= {16'h0,8'h50,8'h41} ;
+            data_link_out_int <= {16'h0,4'h5,pm_port_register,8'h41} ;
             data_link_out_wr_en <= 1;
             fis_count     <= fis_count+1         ;
             //data_rdy_T    <= 1'b1                ;
@@ -1037,6 +1283,31 @@ module sata_transport (
           end
         end  
             
+        HT_DB_FIS:    //Set Device Bits FIS, also the asynchronous notification of a port multiplier
+        begin
+          if(data_out_vld_T && fis_count == 3'd1) begin
+            fis_reg_DW1   <= data_link_in;
+            fis_count     <= fis_count + 1'b1;
+          end
+          if(VALID_CRC_T) begin       
+            Good_status_T <= 1'b1;
+            state         <= HT_HostIdle;
+          end            
+          else if(CRC_ERR_T) begin                                   
+            FIS_ERR       <= 1'b1;
+            state         <= HT_HostIdle;
+            Good_status_T <= 1'b0;
+          end
+          else if(illegal_state) begin       
+            state         <= HT_HostIdle;
+            Good_status_T <= 1'b0;
+          end
+          else begin      
+            state         <= HT_DB_FIS;
+            Good_status_T <= 1'b0;
+          end
+        end
+            
         HT_DMA_FIS:   //DMA Activate FIS
         begin
           if(VALID_CRC_T) begin       
@@ -1078,7 +1349,7 @@ module sata_transport (
           end
           else if(DMA_RQST) begin 
              if(link_txr_rdy) begin      
-              data_link_out_int   <= 32'h0046;
+              data_link_out_int   <= {20'h0, pm_port_register, 8'h46};
               data_link_out_wr_en <= 1;
               tx_fifo_dma_rd_en   <= 1;
               txr_rdy             <= 1'b0;
@@ -1496,9 +1767,10 @@ module sata_transport (
 
 
   // transmit fifo ...........................
-   assign tx_fifo_din       = DMA_RQST ? DMA_TX_DATA_IN : data_register_in ;    //   transmit data from dma to tx fifo connected to   sata_din
-   assign tx_fifo_wr_en     = DMA_RQST ? (DMA_TX_WEN && CE)   : tx_fifo_pio_wr_en;
-   assign tx_fifo_rd_en     = DMA_RQST ? tx_fifo_dma_rd_en    : tx_fifo_pio_rd_en;
+   assign dma_path          = DMA_ONLY || DMA_RQST;       // TX only, PIO data in needs the RX FIFO data register port
+   assign tx_fifo_din       = dma_path ? DMA_TX_DATA_IN : data_register_in ;    //   transmit data from dma to tx fifo connected to   sata_din
+   assign tx_fifo_wr_en     = dma_path ? (DMA_TX_WEN && CE)   : tx_fifo_pio_wr_en;
+   assign tx_fifo_rd_en     = dma_path ? tx_fifo_dma_rd_en    : tx_fifo_pio_rd_en;
    //assign tx_fifo_pio_wr_en = H_write && (!status_register[7]) && status_register[3];
                
   //receiver fifo...............................
@@ -1525,52 +1797,127 @@ module sata_transport (
 
   assign tx_fifo1_reset = reset || TX_FIFO_RESET;
 
-  //PIO and DMA Transmit FIO
-  fifo_generator_v8_3 TX_FIFO1 (
-    .rst           (tx_fifo1_reset),      // input rst
-    .wr_clk        (rx_fifo_rd_clk),      // input wr_clk
-    .rd_clk        (clk),                 // input rd_clk
-    .din           (tx_fifo_din),         // input [31 : 0] din
-    .wr_en         (tx_fifo_wr_en),       // input wr_en
-    .rd_en         (tx_fifo_rd_en),       // input rd_en
-    .dout          (tx_fifo_dout),        // output [31 : 0] dout
-    .full          (),                    // output full
-    .empty         (tx_fifo_empty),       // output empty
-    .almost_empty  (tx_fifo_almost_empty),
-    .prog_full     (tx_fifo_prog_full)    // output prog_full
-  );
-  
+  // runtime thresholds, never above the build values so the HOLD margin stays
+  assign tx_pf_thresh   = (TX_PROG_FULL_IN > TX_PROG_FULL) ? TX_PROG_FULL : TX_PROG_FULL_IN;
+  assign rx_pf_thresh   = (RX_PROG_FULL_IN > RX_PROG_FULL) ? RX_PROG_FULL : RX_PROG_FULL_IN;
+
   assign rx_fifo1_reset = reset || RX_FIFO_RESET;
-  
-  //PIO and DMA Receive FIFO  
-  RX_FIFO RX_FIFO1 (
-    .rst          (rx_fifo1_reset),        // input rst
-    .wr_clk       (clk),                   // input wr_clk
-    .rd_clk       (rx_fifo_rd_clk),        // input rd_clk
-    .din          (rcv_fifo_din),          // input [31 : 0] din
-    .wr_en        (rcv_fifo_wr_en),        // input wr_en
-    .rd_en        (rcv_fifo_rd_en),        // input rd_en
-    .dout         (rcv_fifo_data_out),     // output [31 : 0] dout
-    .full         (rcv_fifo_full),         // output full
-    .empty        (rcv_fifo_almost_empty), // output empty
-    .almost_empty (),
-    .prog_full    (rcv_fifo_prog_full),    // output prog_full
-    .rd_data_count()
-  ); 
-  
-  
+
+  generate
+    if (SHARED_FIFO) begin : gen_buf_pool
+      // one RAM for both directions, a FIFO reset moves the pages so it
+      // resets both sides
+      sata_buf_pool #(
+        .POOL_AWIDTH       (POOL_AWIDTH),
+        .PAGE_AWIDTH       (POOL_PAGE_AWIDTH),
+        .IDLE_PAGES        (1),
+        .PROG_FULL_MARGIN  (148)
+        )
+      BUF_POOL (
+        .rst                 (tx_fifo1_reset || rx_fifo1_reset),
+        .hclk                (rx_fifo_rd_clk),
+        .lclk                (clk),
+        .rx_alloc            (BUF_RX_ALLOC),
+        .tx_din              (tx_fifo_din),
+        .tx_wr_en            (tx_fifo_wr_en),
+        .tx_rd_en            (tx_fifo_rd_en),
+        .tx_prog_full_thresh (tx_pf_thresh[POOL_AWIDTH:0]),
+        .tx_dout             (tx_fifo_dout),
+        .tx_prog_full        (tx_fifo_prog_full),
+        .tx_empty            (tx_fifo_empty),
+        .tx_almost_empty     (tx_fifo_almost_empty),
+        .rx_din              (rcv_fifo_din),
+        .rx_wr_en            (rcv_fifo_wr_en),
+        .rx_rd_en            (rcv_fifo_rd_en),
+        .rx_prog_full_thresh (rx_pf_thresh[POOL_AWIDTH:0]),
+        .rx_dout             (rcv_fifo_data_out),
+        .rx_full             (rcv_fifo_full),
+        .rx_prog_full        (rcv_fifo_prog_full),
+        .rx_empty            (rcv_fifo_almost_empty)
+      );
+    end
+    else begin : gen_fifo
+      //PIO and DMA Transmit FIO
+      sata_fifo #(
+        .DATA_WIDTH        (32),
+        .ADDR_WIDTH        (FIFO_AWIDTH),
+        .DUAL_CLOCK        (1),
+        .FWFT              (1),
+        .PROG_FULL_THRESH  (TX_PROG_FULL)
+        )
+      TX_FIFO1 (
+        .rst           (tx_fifo1_reset),      // input rst
+        .wr_clk        (rx_fifo_rd_clk),      // input wr_clk
+        .rd_clk        (clk),                 // input rd_clk
+        .din           (tx_fifo_din),         // input [31 : 0] din
+        .wr_en         (tx_fifo_wr_en),       // input wr_en
+        .rd_en         (tx_fifo_rd_en),       // input rd_en
+        .prog_full_thresh (tx_pf_thresh[FIFO_AWIDTH:0]),
+        .dout          (tx_fifo_dout),        // output [31 : 0] dout
+        .full          (),                    // output full
+        .almost_full   (),
+        .prog_full     (tx_fifo_prog_full),   // output prog_full
+        .empty         (tx_fifo_empty),       // output empty
+        .almost_empty  (tx_fifo_almost_empty),
+        .prog_empty    (),
+        .wr_data_count (),
+        .rd_data_count ()
+      );
+
+      //PIO and DMA Receive FIFO  
+      sata_fifo #(
+        .DATA_WIDTH        (32),
+        .ADDR_WIDTH        (FIFO_AWIDTH),
+        .DUAL_CLOCK        (1),
+        .FWFT              (1),
+        .PROG_FULL_THRESH  (RX_PROG_FULL)
+        )
+      RX_FIFO1 (
+        .rst          (rx_fifo1_reset),        // input rst
+        .wr_clk       (clk),                   // input wr_clk
+        .rd_clk       (rx_fifo_rd_clk),        // input rd_clk
+        .din          (rcv_fifo_din),          // input [31 : 0] din
+        .wr_en        (rcv_fifo_wr_en),        // input wr_en
+        .rd_en        (rcv_fifo_rd_en),        // input rd_en
+        .prog_full_thresh (rx_pf_thresh[FIFO_AWIDTH:0]),
+        .dout         (rcv_fifo_data_out),     // output [31 : 0] dout
+        .full         (rcv_fifo_full),         // output full
+        .almost_full  (),
+        .prog_full    (rcv_fifo_prog_full),    // output prog_full
+        .empty        (rcv_fifo_almost_empty), // output empty
+        .almost_empty (),
+        .prog_empty   (),
+        .wr_data_count(),
+        .rd_data_count()
+      );
+    end
+  endgenerate
+
+
   //General Transmit FIFO
-  TX_FIFO TL_LL_TX_FIFO (
-    .clk          (clk),                     // input clk
+  sata_fifo #(
+    .DATA_WIDTH        (32),
+    .ADDR_WIDTH        (LL_FIFO_AWIDTH),
+    .DUAL_CLOCK        (0),
+    .FWFT              (0)
+    )
+  TL_LL_TX_FIFO (
     .rst          (tl_ll_tx_fifo_reset),     // input rst
+    .wr_clk       (clk),                     // input clk
+    .rd_clk       (clk),
     .din          (data_link_out_int),       // input [31 : 0] din
     .wr_en        (data_link_out_wr_en),     // input wr_en
     .rd_en        (data_link_rd_en_t),       // input rd_en
+    .prog_full_thresh ('d0),
     .dout         (data_link_out),           // output [31 : 0] dout
     .full         (tl_ll_tx_fifo_full),      // output full
+    .almost_full  (),
+    .prog_full    (),
     .empty        (tl_ll_tx_fifo_empty),     // output empty 
-    .almost_full  (),                        // output prog_full
-    .almost_empty (tl_ll_tx_fifo_almost_empty) // output prog_empty
+    .almost_empty (tl_ll_tx_fifo_almost_empty), // output almost_empty
+    .prog_empty   (),
+    .wr_data_count(),
+    .rd_data_count()
   );
 
   assign FRAME_END_T  = tl_ll_tx_fifo_empty;
@@ -0,0 +1,428 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : Disk to disk copy engine
+//  File name   : copy_engine.v
+//  Note        : Copies an LBA range from drive 0 (source) to drive 1
+//                (destination) of SATA_CONTROLLER_MP, without user logic or
+//                firmware in the data path. The range is cut in CMD_SECTORS
+//                commands; up to READ_AHEAD source reads are queued ahead,
+//                so the next read runs while the previous segment is
+//                written. Each segment moves word by word from the source
+//                RX staging FIFO to the destination TX staging FIFO and its
+//                write is queued as soon as it is complete.
+//                With CP_VERIFY the range is read back from both drives
+//                afterwards and compared, CP_MISMATCH counts differing words
+//                and CP_MISMATCH_LBA holds the source LBA of the first one.
+//                Progress : CP_COPIED (sectors written and acknowledged),
+//                CP_VERIFIED, CP_ELAPSED (clocks since start) and CP_RATE
+//                (sectors completed in the last RATE_WINDOW clocks, with
+//                RATE_WINDOW = CLK frequency that is sectors per second).
+//                A failing command stops the copy, the commands already
+//                queued run to the end.
+//  Design ref. : -
+//  Dependencies   : SATA_DRIVE_PORT, sata_async_fifo
+//////////////////////////////////////////////////////////////////////////////
+
+module COPY_ENGINE #(
+    parameter  STAGE_ADDR_WIDTH = 15,                  // per drive staging FIFO, 2**STAGE_ADDR_WIDTH words
+    parameter  CMD_SECTORS      = 16'd256,             // sectors per command, at most 2**(STAGE_ADDR_WIDTH-7)
+    parameter  READ_AHEAD       = 2,                   // source reads queued ahead of the mover
+    parameter  RATE_WINDOW      = 32'd150_000_000      // clocks per CP_RATE sample
+    )
+    (
+    input                     CLK,                     // engine clock
+    input                     RESET,
+
+    // control / status
+    input                     CP_START,                // pulse
+    input                     CP_ABORT,                // stop queueing new commands
+    input      [47:0]         CP_SRC_LBA,
+    input      [47:0]         CP_DST_LBA,
+    input      [47:0]         CP_SECTORS,
+    input                     CP_VERIFY,               // compare both ranges after the copy
+    output reg                CP_BUSY,
+    output reg                CP_DONE,                 // one clock pulse
+    output reg                CP_ERROR,                // a command failed
+    output reg [7:0]          CP_ERR_STATUS,           // status register of the first failing command
+    output reg                CP_VERIFY_PHASE,
+    output reg [47:0]         CP_COPIED,
+    output reg [47:0]         CP_VERIFIED,
+    output reg [31:0]         CP_MISMATCH,
+    output reg [47:0]         CP_MISMATCH_LBA,
+    output reg [47:0]         CP_ELAPSED,
+    output reg [31:0]         CP_RATE,
+
+    // to the SATA_CONTROLLER_MP ports, port n on bit n / slice n
+    input      [1:0]          PORT_CLK,
+    input      [1:0]          LINKUP,
+    output     [1:0]          HOST_READ_EN,
+    output     [1:0]          HOST_WRITE_EN,
+    output     [9:0]          HOST_ADDR_REG,
+    output     [63:0]         HOST_DATA_IN,
+    input      [63:0]         HOST_DATA_OUT,
+    output     [63:0]         DMA_TX_DATA_IN,
+    output     [1:0]          DMA_TX_WEN,
+    input      [1:0]          WRITE_HOLD_U,
+    input      [63:0]         DMA_RX_DATA_OUT,
+    output     [1:0]          DMA_RX_REN,
+    input      [1:0]          READ_HOLD_U,
+    output     [1:0]          TX_FIFO_RESET,
+    output     [1:0]          RX_FIFO_RESET
+    );
+
+  parameter  C_IDLE        = 2'h0;
+  parameter  C_RUN         = 2'h1;
+  parameter  C_DRAIN       = 2'h2;
+
+  reg   [1:0]                  state;
+  reg                          stopping;
+  reg   [47:0]                 src_lba;
+  reg   [47:0]                 dst_lba;
+  reg   [47:0]                 left;
+  reg   [47:0]                 total;
+  reg   [7:0]                  ahead;                // segments queued, not yet moved / compared
+  reg   [15:0]                 cmd_out;
+  reg   [31:0]                 window_count;
+  reg   [31:0]                 window_sectors;
+
+  wire  [15:0]                 seg;
+  wire                         gen_push;
+
+  // segment queue {src lba, dst lba, sectors}
+  wire  [111:0]                seg_dout;
+  wire                         seg_empty;
+  wire                         seg_ren;
+
+  // mover / comparator
+  reg                          m_active;
+  reg   [47:0]                 m_src_lba;
+  reg   [47:0]                 m_dst_lba;
+  reg   [15:0]                 m_sectors;
+  reg   [22:0]                 m_left;
+  reg   [22:0]                 m_widx;
+  wire                         m_last;
+  wire                         copy_move;
+  wire                         cmp_move;
+  wire                         m_move;
+  wire                         m_end;
+  wire  [47:0]                 copy_rest;
+  wire  [47:0]                 verify_rest;
+  wire  [15:0]                 copy_step;
+  wire  [15:0]                 verify_step;
+
+  // drive ports
+  wire  [1:0]                  q_cmd_wen;
+  wire  [129:0]                q_cmd_data;
+  wire  [1:0]                  q_cmd_full;
+  wire  [1:0]                  q_sts_ren;
+  wire  [33:0]                 q_sts_data;
+  wire  [1:0]                  q_sts_empty;
+  wire  [63:0]                 stg_rx_data;
+  wire  [1:0]                  stg_rx_ren;
+  wire  [1:0]                  stg_rx_empty;
+  wire                         stg_tx_full;
+  wire  [1:0]                  cmd_dec;
+
+  //******************************** command generation *********************************
+  assign seg        = (left < CMD_SECTORS) ? left[15:0] : CMD_SECTORS;
+
+  // copy : source reads only, verify : reads on both drives
+  assign gen_push   = (state == C_RUN) && !stopping && (left != 48'd0) && (ahead < READ_AHEAD) &&
+                      !q_cmd_full[0] && !(CP_VERIFY_PHASE && q_cmd_full[1]);
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      state            <= C_IDLE;
+      stopping         <= 1'b0;
+      src_lba          <= 48'd0;
+      dst_lba          <= 48'd0;
+      left             <= 48'd0;
+      total            <= 48'd0;
+      CP_BUSY          <= 1'b0;
+      CP_DONE          <= 1'b0;
+      CP_VERIFY_PHASE  <= 1'b0;
+    end
+    else begin
+      CP_DONE          <= 1'b0;
+      if(CP_ABORT && CP_BUSY) begin
+        stopping         <= 1'b1;
+      end
+      case(state)
+        C_IDLE: begin
+          if(CP_START) begin
+            src_lba          <= CP_SRC_LBA;
+            dst_lba          <= CP_DST_LBA;
+            left             <= CP_SECTORS;
+            total            <= CP_SECTORS;
+            stopping         <= 1'b0;
+            CP_VERIFY_PHASE  <= 1'b0;
+            CP_BUSY          <= 1'b1;
+            state            <= C_RUN;
+          end
+        end
+        C_RUN: begin
+          if(left == 48'd0 || stopping || CP_ERROR) begin
+            state            <= C_DRAIN;
+          end
+          else if(gen_push) begin
+            src_lba          <= src_lba + seg;
+            dst_lba          <= dst_lba + seg;
+            left             <= left - seg;
+          end
+        end
+        C_DRAIN: begin
+          if(ahead == 8'd0 && !m_active && seg_empty && cmd_out == 16'd0) begin
+            if(CP_VERIFY && !CP_VERIFY_PHASE && !stopping && !CP_ERROR) begin
+              src_lba          <= CP_SRC_LBA;
+              dst_lba          <= CP_DST_LBA;
+              left             <= CP_SECTORS;
+              CP_VERIFY_PHASE  <= 1'b1;
+              state            <= C_RUN;
+            end
+            else begin
+              CP_BUSY          <= 1'b0;
+              CP_DONE          <= 1'b1;
+              state            <= C_IDLE;
+            end
+          end
+        end
+        default: begin
+          state            <= C_IDLE;
+        end
+      endcase
+    end
+  end
+
+  sata_async_fifo #(
+    .DATA_WIDTH  (112),
+    .ADDR_WIDTH  (4)
+    )
+  seg_queue (
+    .rst         (RESET),
+    .wr_clk      (CLK),
+    .wr_en       (gen_push),
+    .din         ({src_lba, dst_lba, seg}),
+    .full        (),
+    .wr_count    (),
+    .rd_clk      (CLK),
+    .rd_en       (seg_ren),
+    .dout        (seg_dout),
+    .empty       (seg_empty),
+    .rd_count    ()
+    );
+
+  //******************************** mover / comparator *********************************
+  assign seg_ren    = !m_active && !seg_empty;
+  assign m_last     = (m_left == 23'd1);
+  assign copy_move  = m_active && !CP_VERIFY_PHASE && !stg_rx_empty[0] && !stg_tx_full &&
+                      !(m_last && q_cmd_full[1]);
+  assign cmp_move   = m_active && CP_VERIFY_PHASE && !stg_rx_empty[0] && !stg_rx_empty[1];
+  assign m_move     = copy_move || cmp_move;
+  assign m_end      = m_move && m_last;
+
+  assign stg_rx_ren = {cmp_move, m_move};
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      m_active         <= 1'b0;
+      m_src_lba        <= 48'd0;
+      m_dst_lba        <= 48'd0;
+      m_sectors        <= 16'd0;
+      m_left           <= 23'd0;
+      m_widx           <= 23'd0;
+      ahead            <= 8'd0;
+      CP_MISMATCH      <= 32'd0;
+      CP_MISMATCH_LBA  <= 48'd0;
+    end
+    else begin
+      if(seg_ren) begin
+        m_active         <= 1'b1;
+        {m_src_lba, m_dst_lba, m_sectors} <= seg_dout;
+        m_left           <= {seg_dout[15:0], 7'd0};
+        m_widx           <= 23'd0;
+      end
+      else if(m_move) begin
+        m_left           <= m_left - 1'b1;
+        m_widx           <= m_widx + 1'b1;
+        if(m_last) begin
+          m_active         <= 1'b0;
+        end
+      end
+
+      if(gen_push && !m_end) begin
+        ahead            <= ahead + 1'b1;
+      end
+      else if(!gen_push && m_end) begin
+        ahead            <= ahead - 1'b1;
+      end
+
+      if(state == C_IDLE && CP_START) begin
+        CP_MISMATCH      <= 32'd0;
+        CP_MISMATCH_LBA  <= 48'd0;
+      end
+      else if(cmp_move && stg_rx_data[31:0] != stg_rx_data[63:32]) begin
+        CP_MISMATCH      <= CP_MISMATCH + 1'b1;
+        if(CP_MISMATCH == 32'd0) begin
+          CP_MISMATCH_LBA  <= m_src_lba + m_widx[22:7];
+        end
+      end
+    end
+  end
+
+  //******************************** commands / status / progress ***********************
+  // source (and verify destination) reads from the generator, destination writes from the mover
+  assign q_cmd_wen[0]        = gen_push;
+  assign q_cmd_wen[1]        = (gen_push && CP_VERIFY_PHASE) || (copy_move && m_last);
+  assign q_cmd_data[64:0]    = {1'b0, src_lba, seg};
+  assign q_cmd_data[129:65]  = CP_VERIFY_PHASE ? {1'b0, dst_lba, seg} : {1'b1, m_dst_lba, m_sectors};
+
+  assign q_sts_ren   = ~q_sts_empty;
+  assign cmd_dec     = {1'b0, q_sts_ren[0]} + {1'b0, q_sts_ren[1]};
+
+  // segments complete in order and all but the last are CMD_SECTORS long
+  assign copy_rest   = total - CP_COPIED;
+  assign verify_rest = total - CP_VERIFIED;
+  assign copy_step   = (copy_rest < CMD_SECTORS) ? copy_rest[15:0] : CMD_SECTORS;
+  assign verify_step = (verify_rest < CMD_SECTORS) ? verify_rest[15:0] : CMD_SECTORS;
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      cmd_out          <= 16'd0;
+      CP_ERROR         <= 1'b0;
+      CP_ERR_STATUS    <= 8'd0;
+      CP_COPIED        <= 48'd0;
+      CP_VERIFIED      <= 48'd0;
+      CP_ELAPSED       <= 48'd0;
+      CP_RATE          <= 32'd0;
+      window_count     <= 32'd0;
+      window_sectors   <= 32'd0;
+    end
+    else begin
+      cmd_out          <= cmd_out + q_cmd_wen[0] + q_cmd_wen[1] - cmd_dec;
+
+      if(state == C_IDLE && CP_START) begin
+        CP_ERROR         <= 1'b0;
+        CP_ERR_STATUS    <= 8'd0;
+        CP_COPIED        <= 48'd0;
+        CP_VERIFIED      <= 48'd0;
+        CP_ELAPSED       <= 48'd0;
+        CP_RATE          <= 32'd0;
+        window_count     <= 32'd0;
+        window_sectors   <= 32'd0;
+      end
+      else begin
+        if(CP_BUSY) begin
+          CP_ELAPSED       <= CP_ELAPSED + 1'b1;
+        end
+
+        if((q_sts_ren[0] && q_sts_data[16]) || (q_sts_ren[1] && q_sts_data[33])) begin
+          CP_ERROR         <= 1'b1;
+          if(!CP_ERROR) begin
+            CP_ERR_STATUS    <= (q_sts_ren[0] && q_sts_data[16]) ? q_sts_data[7:0] : q_sts_data[24:17];
+          end
+        end
+
+        // destination write acknowledged / segment compared
+        if(q_sts_ren[1] && !q_sts_data[33] && !CP_VERIFY_PHASE) begin
+          CP_COPIED        <= CP_COPIED + copy_step;
+        end
+        if(cmp_move && m_last) begin
+          CP_VERIFIED      <= CP_VERIFIED + verify_step;
+        end
+
+        if(window_count == RATE_WINDOW - 1) begin
+          window_count     <= 32'd0;
+          window_sectors   <= 32'd0;
+          CP_RATE          <= window_sectors;
+        end
+        else begin
+          window_count     <= window_count + 1'b1;
+          if(q_sts_ren[1] && !q_sts_data[33] && !CP_VERIFY_PHASE) begin
+            window_sectors   <= window_sectors + copy_step;
+          end
+          else if(cmp_move && m_last) begin
+            window_sectors   <= window_sectors + verify_step;
+          end
+        end
+      end
+    end
+  end
+
+  //******************************** drive ports ****************************************
+  SATA_DRIVE_PORT #(
+    .STAGE_ADDR_WIDTH  (STAGE_ADDR_WIDTH)
+    )
+  src_port (
+    .CLK               (CLK),
+    .RESET             (RESET),
+    .Q_CMD_WEN         (q_cmd_wen[0]),
+    .Q_CMD_DATA        (q_cmd_data[64:0]),
+    .Q_CMD_FULL        (q_cmd_full[0]),
+    .Q_STS_REN         (q_sts_ren[0]),
+    .Q_STS_DATA        (q_sts_data[16:0]),
+    .Q_STS_EMPTY       (q_sts_empty[0]),
+    .TX_DATA           (32'd0),
+    .TX_WEN            (1'b0),
+    .TX_FULL           (),
+    .TX_COUNT          (),
+    .RX_DATA           (stg_rx_data[31:0]),
+    .RX_REN            (stg_rx_ren[0]),
+    .RX_EMPTY          (stg_rx_empty[0]),
+    .PORT_CLK          (PORT_CLK[0]),
+    .LINKUP            (LINKUP[0]),
+    .HOST_READ_EN      (HOST_READ_EN[0]),
+    .HOST_WRITE_EN     (HOST_WRITE_EN[0]),
+    .HOST_ADDR_REG     (HOST_ADDR_REG[4:0]),
+    .HOST_DATA_IN      (HOST_DATA_IN[31:0]),
+    .HOST_DATA_OUT     (HOST_DATA_OUT[31:0]),
+    .DMA_TX_DATA_IN    (DMA_TX_DATA_IN[31:0]),
+    .DMA_TX_WEN        (DMA_TX_WEN[0]),
+    .WRITE_HOLD_U      (WRITE_HOLD_U[0]),
+    .DMA_RX_DATA_OUT   (DMA_RX_DATA_OUT[31:0]),
+    .DMA_RX_REN        (DMA_RX_REN[0]),
+    .READ_HOLD_U       (READ_HOLD_U[0]),
+    .TX_FIFO_RESET     (TX_FIFO_RESET[0]),
+    .RX_FIFO_RESET     (RX_FIFO_RESET[0])
+    );
+
+  SATA_DRIVE_PORT #(
+    .STAGE_ADDR_WIDTH  (STAGE_ADDR_WIDTH)
+    )
+  dst_port (
+    .CLK               (CLK),
+    .RESET             (RESET),
+    .Q_CMD_WEN         (q_cmd_wen[1]),
+    .Q_CMD_DATA        (q_cmd_data[129:65]),
+    .Q_CMD_FULL        (q_cmd_full[1]),
+    .Q_STS_REN         (q_sts_ren[1]),
+    .Q_STS_DATA        (q_sts_data[33:17]),
+    .Q_STS_EMPTY       (q_sts_empty[1]),
+    .TX_DATA           (stg_rx_data[31:0]),
+    .TX_WEN            (copy_move),
+    .TX_FULL           (stg_tx_full),
+    .TX_COUNT          (),
+    .RX_DATA           (stg_rx_data[63:32]),
+    .RX_REN            (stg_rx_ren[1]),
+    .RX_EMPTY          (stg_rx_empty[1]),
+    .PORT_CLK          (PORT_CLK[1]),
+    .LINKUP            (LINKUP[1]),
+    .HOST_READ_EN      (HOST_READ_EN[1]),
+    .HOST_WRITE_EN     (HOST_WRITE_EN[1]),
+    .HOST_ADDR_REG     (HOST_ADDR_REG[9:5]),
+    .HOST_DATA_IN      (HOST_DATA_IN[63:32]),
+    .HOST_DATA_OUT     (HOST_DATA_OUT[63:32]),
+    .DMA_TX_DATA_IN    (DMA_TX_DATA_IN[63:32]),
+    .DMA_TX_WEN        (DMA_TX_WEN[1]),
+    .WRITE_HOLD_U      (WRITE_HOLD_U[1]),
+    .DMA_RX_DATA_OUT   (DMA_RX_DATA_OUT[63:32]),
+    .DMA_RX_REN        (DMA_RX_REN[1]),
+    .READ_HOLD_U       (READ_HOLD_U[1]),
+    .TX_FIFO_RESET     (TX_FIFO_RESET[1]),
+    .RX_FIFO_RESET     (RX_FIFO_RESET[1])
+    );
+
+endmodule
@@ -0,0 +1,342 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : Extent list (LBA scatter-gather) engine
+//  File name   : extent_engine.v
+//  Note        : Executes a list of (LBA, sector count, buffer offset)
+//                extents back to back, one READ / WRITE DMA EXT per extent
+//                through SATA_CMD_ISSUE, without firmware in between.
+//                The list is written into an internal RAM, four words per
+//                entry :
+//                  word 0 : LBA[31:0]
+//                  word 1 : {sector count[15:0], LBA[47:32]}
+//                  word 2 : buffer offset in bytes
+//                  word 3 : reserved
+//                Extents with a sector count of 0 are skipped.
+//                User data is one contiguous stream through the USR_TX /
+//                USR_RX ports; USR_TX_OFFSET / USR_RX_OFFSET give the buffer
+//                offset of the word at the port, so it can be placed in a
+//                user buffer. The data side walks the list on its own so a
+//                slow reader does not hold back the command side. In the
+//                write direction it takes the words of an extent only once
+//                the command side is on that extent (CMD_DONE of the one
+//                before), the transport ends a Data FIS on an empty TX FIFO
+//                only, so words of the next extent must not be queued
+//                behind a command still in flight.
+//                Per extent status is kept in a status RAM, read through
+//                EXT_STAT_ADDR / EXT_STAT_DATA (one clock latency) :
+//                  {valid, 14'd0, error, error register, status register}
+//                valid is only set for extents executed in the last run.
+//                All ports are in the controller clock (CLK_OUT) domain,
+//                DMA_CLK_IN of SATA_CONTROLLER must be driven by the same
+//                clock and DMA_RQST held at 1.
+//  Design ref. : -
+//  Dependencies   : SATA_CMD_ISSUE
+//////////////////////////////////////////////////////////////////////////////
+
+module EXTENT_ENGINE #(
+    parameter  LIST_ADDR_WIDTH = 8                     // up to 2**LIST_ADDR_WIDTH extents
+    )
+    (
+    input                            CLK,              // controller clock
+    input                            RESET,
+
+    // extent list RAM write port
+    input                            EXT_WR_EN,
+    input      [LIST_ADDR_WIDTH+1:0] EXT_WR_ADDR,      // {entry, word}
+    input      [31:0]                EXT_WR_DATA,
+
+    // control / status
+    input                            EXT_START,        // pulse
+    input                            EXT_DIR,          // 1 : write (user to disk), 0 : read
+    input      [LIST_ADDR_WIDTH:0]   EXT_COUNT,        // number of list entries to execute
+    input                            EXT_STOP_ON_ERR,  // 1 : abort the list at the first failing extent
+    output reg                       EXT_BUSY,
+    output reg                       EXT_DONE,         // one clock pulse after the last extent
+    output reg                       EXT_ERROR,        // at least one extent failed
+    output reg [LIST_ADDR_WIDTH:0]   EXT_INDEX,        // extent being executed
+    input      [LIST_ADDR_WIDTH-1:0] EXT_STAT_ADDR,
+    output     [31:0]                EXT_STAT_DATA,
+
+    // user data, write direction
+    input      [31:0]                USR_TX_DATA,
+    input                            USR_TX_WEN,
+    output                           USR_TX_HOLD,
+    output     [31:0]                USR_TX_OFFSET,
+    // user data, read direction
+    output     [31:0]                USR_RX_DATA,
+    input                            USR_RX_REN,
+    output                           USR_RX_EMPTY,
+    output     [31:0]                USR_RX_OFFSET,
+
+    // to SATA_CMD_ISSUE
+    output reg                       CMD_REQ,
+    input                            CMD_READY,
+    output     [7:0]                 CMD_CODE,
+    output     [15:0]                CMD_FEATURES,
+    output reg [47:0]                CMD_LBA,
+    output reg [15:0]                CMD_SECTORS,
+    input                            CMD_DONE,
+    input                            CMD_ERROR,
+    input      [7:0]                 CMD_STATUS,
+    input      [7:0]                 CMD_ERR_REG,
+
+    // to SATA_CONTROLLER DMA ports
+    output     [31:0]                DMA_TX_DATA_IN,
+    output                           DMA_TX_WEN,
+    input                            WRITE_HOLD_U,
+    input      [31:0]                DMA_RX_DATA_OUT,
+    output                           DMA_RX_REN,
+    input                            READ_HOLD_U
+    );
+
+  parameter  E_IDLE        = 4'h0;
+  parameter  E_RD_W0       = 4'h1;
+  parameter  E_RD_W1       = 4'h2;
+  parameter  E_RD_W2       = 4'h3;
+  parameter  E_CHECK       = 4'h4;
+  parameter  E_ISSUE       = 4'h5;
+  parameter  E_CMD_WAIT    = 4'h6;
+  parameter  E_NEXT        = 4'h7;
+  parameter  E_END         = 4'h8;
+
+  parameter  READ_DMA_EXT  = 8'h25;
+  parameter  WRITE_DMA_EXT = 8'h35;
+
+  // list RAM, one copy for the command side and one for the data side
+  reg   [31:0]                  cmd_list  [0:(4<<LIST_ADDR_WIDTH)-1];
+  reg   [31:0]                  data_list [0:(4<<LIST_ADDR_WIDTH)-1];
+  reg   [31:0]                  stat_ram  [0:(1<<LIST_ADDR_WIDTH)-1];
+
+  reg   [3:0]                   state;
+  reg   [LIST_ADDR_WIDTH+1:0]   cmd_list_addr;
+  reg   [31:0]                  cmd_list_dout;
+  reg                           dir;
+  reg                           run_gen;               // toggles every run, marks valid status words
+  reg                           stat_wen;
+  reg   [31:0]                  stat_din;
+  reg   [31:0]                  stat_dout;
+
+  // data side
+  reg   [3:0]                   dstate;
+  reg   [LIST_ADDR_WIDTH:0]     data_index;
+  reg   [LIST_ADDR_WIDTH+1:0]   data_list_addr;
+  reg   [31:0]                  data_list_dout;
+  reg   [22:0]                  data_words_left;
+  reg   [31:0]                  data_offset;
+  reg                           data_ready;
+  reg                           data_abort;
+  wire                          data_move;
+
+  assign CMD_CODE      = dir ? WRITE_DMA_EXT : READ_DMA_EXT;
+  assign CMD_FEATURES  = 16'd0;
+
+  //******************************** list / status RAMs *********************************
+  always @(posedge CLK)
+  begin
+    if(EXT_WR_EN) begin
+      cmd_list[EXT_WR_ADDR]  <= EXT_WR_DATA;
+      data_list[EXT_WR_ADDR] <= EXT_WR_DATA;
+    end
+    cmd_list_dout  <= cmd_list[cmd_list_addr];
+    data_list_dout <= data_list[data_list_addr];
+  end
+
+  always @(posedge CLK)
+  begin
+    if(stat_wen) begin
+      stat_ram[EXT_INDEX[LIST_ADDR_WIDTH-1:0]] <= stat_din;
+    end
+    stat_dout <= stat_ram[EXT_STAT_ADDR];
+  end
+
+  assign EXT_STAT_DATA = {(stat_dout[31] == run_gen), stat_dout[30:0]};
+
+  //******************************** command side ***************************************
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      state          <= E_IDLE;
+      cmd_list_addr  <= 'd0;
+      dir            <= 1'b0;
+      run_gen        <= 1'b0;
+      stat_wen       <= 1'b0;
+      stat_din       <= 32'd0;
+      data_abort     <= 1'b0;
+      CMD_REQ        <= 1'b0;
+      CMD_LBA        <= 48'd0;
+      CMD_SECTORS    <= 16'd0;
+      EXT_BUSY       <= 1'b0;
+      EXT_DONE       <= 1'b0;
+      EXT_ERROR      <= 1'b0;
+      EXT_INDEX      <= 'd0;
+    end
+    else begin
+      EXT_DONE       <= 1'b0;
+      stat_wen       <= 1'b0;
+      data_abort     <= 1'b0;
+      case(state)
+        E_IDLE: begin
+          if(EXT_START) begin
+            dir            <= EXT_DIR;
+            run_gen        <= !run_gen;
+            EXT_BUSY       <= 1'b1;
+            EXT_ERROR      <= 1'b0;
+            EXT_INDEX      <= 'd0;
+            cmd_list_addr  <= 'd0;
+            state          <= E_RD_W0;
+          end
+        end
+        E_RD_W0: begin                                   // address of word 0 is on the RAM
+          if(EXT_INDEX == EXT_COUNT) begin
+            state          <= E_END;
+          end
+          else begin
+            cmd_list_addr  <= {EXT_INDEX[LIST_ADDR_WIDTH-1:0], 2'd1};
+            state          <= E_RD_W1;
+          end
+        end
+        E_RD_W1: begin
+          CMD_LBA[31:0]  <= cmd_list_dout;
+          state          <= E_RD_W2;
+        end
+        E_RD_W2: begin
+          CMD_LBA[47:32] <= cmd_list_dout[15:0];
+          CMD_SECTORS    <= cmd_list_dout[31:16];
+          state          <= E_CHECK;
+        end
+        E_CHECK: begin
+          if(CMD_SECTORS == 16'd0) begin                 // empty extent, nothing to do
+            EXT_INDEX      <= EXT_INDEX + 1'b1;
+            cmd_list_addr  <= {EXT_INDEX[LIST_ADDR_WIDTH-1:0] + 1'b1, 2'd0};
+            state          <= E_RD_W0;
+          end
+          else begin
+            state          <= E_ISSUE;
+          end
+        end
+        E_ISSUE: begin
+          CMD_REQ        <= 1'b1;
+          if(CMD_REQ && CMD_READY) begin
+            CMD_REQ        <= 1'b0;
+            state          <= E_CMD_WAIT;
+          end
+        end
+        E_CMD_WAIT: begin
+          if(CMD_DONE) begin
+            stat_wen       <= 1'b1;
+            stat_din       <= {run_gen, 14'd0, CMD_ERROR, CMD_ERR_REG, CMD_STATUS};
+            if(CMD_ERROR) begin
+              EXT_ERROR      <= 1'b1;
+            end
+            if(CMD_ERROR && EXT_STOP_ON_ERR) begin
+              data_abort     <= 1'b1;
+              state          <= E_END;
+            end
+            else begin
+              state          <= E_NEXT;
+            end
+          end
+        end
+        E_NEXT: begin                                    // status word of this extent is written now
+          EXT_INDEX      <= EXT_INDEX + 1'b1;
+          cmd_list_addr  <= {EXT_INDEX[LIST_ADDR_WIDTH-1:0] + 1'b1, 2'd0};
+          state          <= E_RD_W0;
+        end
+        E_END: begin
+          EXT_BUSY       <= 1'b0;
+          EXT_DONE       <= 1'b1;
+          state          <= E_IDLE;
+        end
+        default: begin
+          state          <= E_IDLE;
+        end
+      endcase
+    end
+  end
+
+  //******************************** data side ******************************************
+  // walks the same list and counts the words of each extent through the user port
+  assign data_move      = dir ? DMA_TX_WEN : DMA_RX_REN;
+
+  assign USR_TX_HOLD    = WRITE_HOLD_U || !data_ready || !dir;
+  assign USR_TX_OFFSET  = data_offset;
+  assign DMA_TX_DATA_IN = USR_TX_DATA;
+  assign DMA_TX_WEN     = USR_TX_WEN && !USR_TX_HOLD;
+
+  assign USR_RX_EMPTY   = READ_HOLD_U || !data_ready || dir;
+  assign USR_RX_OFFSET  = data_offset;
+  assign USR_RX_DATA    = DMA_RX_DATA_OUT;
+  assign DMA_RX_REN     = USR_RX_REN && !USR_RX_EMPTY;
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      dstate           <= E_IDLE;
+      data_index       <= 'd0;
+      data_list_addr   <= 'd0;
+      data_words_left  <= 23'd0;
+      data_offset      <= 32'd0;
+      data_ready       <= 1'b0;
+    end
+    else if(data_abort) begin
+      dstate           <= E_IDLE;
+      data_ready       <= 1'b0;
+    end
+    else begin
+      case(dstate)
+        E_IDLE: begin
+          if(state == E_IDLE && EXT_START) begin
+            data_index       <= 'd0;
+            data_list_addr   <= {{LIST_ADDR_WIDTH{1'b0}}, 2'd1};
+            dstate           <= E_RD_W0;
+          end
+        end
+        E_RD_W0: begin
+          if(data_index == EXT_COUNT) begin
+            dstate           <= E_IDLE;
+          end
+          else begin
+            data_list_addr   <= {data_index[LIST_ADDR_WIDTH-1:0], 2'd2};
+            dstate           <= E_RD_W1;
+          end
+        end
+        E_RD_W1: begin                                   // word 1 on the RAM output
+          data_words_left  <= {data_list_dout[31:16], 7'd0};
+          dstate           <= E_RD_W2;
+        end
+        E_RD_W2: begin                                   // word 2 on the RAM output
+          data_offset      <= data_list_dout;
+          dstate           <= E_CHECK;
+        end
+        E_CHECK: begin
+          if(data_words_left == 23'd0) begin
+            data_index       <= data_index + 1'b1;
+            data_list_addr   <= {data_index[LIST_ADDR_WIDTH-1:0] + 1'b1, 2'd1};
+            dstate           <= E_RD_W0;
+          end
+          else if(!dir || EXT_INDEX == data_index) begin
+            data_ready       <= 1'b1;
+            dstate           <= E_CMD_WAIT;
+          end
+        end
+        E_CMD_WAIT: begin
+          if(data_move) begin
+            data_offset      <= data_offset + 3'd4;
+            data_words_left  <= data_words_left - 1'b1;
+            if(data_words_left == 23'd1) begin
+              data_ready       <= 1'b0;
+              data_index       <= data_index + 1'b1;
+              data_list_addr   <= {data_index[LIST_ADDR_WIDTH-1:0] + 1'b1, 2'd1};
+              dstate           <= E_RD_W0;
+            end
+          end
+        end
+        default: begin
+          dstate           <= E_IDLE;
+        end
+      endcase
+    end
+  end
+
+endmodule
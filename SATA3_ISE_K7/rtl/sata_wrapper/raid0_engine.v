@@ -0,0 +1,363 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : RAID-0 striping engine
+//  File name   : raid0_engine.v
+//  Note        : Stripes one logical LBA range over NUM_DRIVES ports of
+//                SATA_CONTROLLER_MP. The logical space is cut in chunks of
+//                2**R0_CHUNK_SHIFT sectors, chunk c lives on drive c mod N at
+//                drive LBA (c / N) * chunk + offset in chunk.
+//                A transfer is cut into one segment per chunk, each segment
+//                is one DMA EXT command on its drive. The user data is one
+//                stream in logical order : on writes every segment is put in
+//                the staging FIFO of its drive and its command queued as
+//                soon as the segment is complete, so all drives write in
+//                parallel while the stream moves on to the next chunk; on
+//                reads all commands are queued up front and the stream takes
+//                the segments back from the drive staging FIFOs in logical
+//                order.
+//                A chunk must fit in the staging FIFO, R0_CHUNK_SHIFT is
+//                limited to STAGE_ADDR_WIDTH - 7 (64 KB chunks by default).
+//                The user port moves 4 bytes per CLK, run CLK fast enough
+//                for the drive count (e.g. 250 MHz for 4 SATA3 drives).
+//                A failing segment does not stop the transfer, its data is
+//                dropped (write) or read as zeros; R0_ERROR / R0_ERR_MASK
+//                tell which drive failed.
+//  Design ref. : -
+//  Dependencies   : SATA_DRIVE_PORT
+//////////////////////////////////////////////////////////////////////////////
+
+module RAID0_ENGINE #(
+    parameter  NUM_DRIVES       = 4,                   // 2 to 4
+    parameter  STAGE_ADDR_WIDTH = 14                   // per drive staging FIFO, 2**STAGE_ADDR_WIDTH words
+    )
+    (
+    input                            CLK,              // engine / user clock
+    input                            RESET,
+
+    // control / status
+    input                            R0_START,         // pulse
+    input                            R0_DIR,           // 1 : write, 0 : read
+    input      [47:0]                R0_LBA,           // logical start LBA
+    input      [31:0]                R0_SECTORS,       // logical length
+    input      [3:0]                 R0_CHUNK_SHIFT,   // chunk = 2**R0_CHUNK_SHIFT sectors
+    output reg                       R0_BUSY,
+    output reg                       R0_DONE,          // one clock pulse, all segments completed
+    output reg                       R0_ERROR,
+    output reg [NUM_DRIVES-1:0]      R0_ERR_MASK,      // drives with a failed segment
+
+    // user data, logical order
+    input      [31:0]                USR_TX_DATA,
+    input                            USR_TX_WEN,
+    output                           USR_TX_HOLD,
+    output     [31:0]                USR_RX_DATA,
+    input                            USR_RX_REN,
+    output                           USR_RX_EMPTY,
+
+    // to the SATA_CONTROLLER_MP ports, port n on bit n / slice n
+    input      [NUM_DRIVES-1:0]      PORT_CLK,         // CLK_OUT, also DMA_CLK_IN of the port
+    input      [NUM_DRIVES-1:0]      LINKUP,
+    output     [NUM_DRIVES-1:0]      HOST_READ_EN,
+    output     [NUM_DRIVES-1:0]      HOST_WRITE_EN,
+    output     [NUM_DRIVES*5-1:0]    HOST_ADDR_REG,
+    output     [NUM_DRIVES*32-1:0]   HOST_DATA_IN,
+    input      [NUM_DRIVES*32-1:0]   HOST_DATA_OUT,
+    output     [NUM_DRIVES*32-1:0]   DMA_TX_DATA_IN,
+    output     [NUM_DRIVES-1:0]      DMA_TX_WEN,
+    input      [NUM_DRIVES-1:0]      WRITE_HOLD_U,
+    input      [NUM_DRIVES*32-1:0]   DMA_RX_DATA_OUT,
+    output     [NUM_DRIVES-1:0]      DMA_RX_REN,
+    input      [NUM_DRIVES-1:0]      READ_HOLD_U,
+    output     [NUM_DRIVES-1:0]      TX_FIFO_RESET,
+    output     [NUM_DRIVES-1:0]      RX_FIFO_RESET
+    );
+
+  parameter  G_IDLE        = 2'h0;
+  parameter  G_DIV         = 2'h1;
+  parameter  G_SEG         = 2'h2;
+  parameter  G_WAIT        = 2'h3;
+
+  localparam MAX_SHIFT     = STAGE_ADDR_WIDTH - 7;
+
+  // segment generator
+  reg   [1:0]                  state;
+  reg                          dir;
+  reg   [3:0]                  shift;
+  reg   [47:0]                 lba;
+  reg   [31:0]                 left;
+  reg   [47:0]                 row;                  // chunk row of the current drive
+  reg   [1:0]                  drive;
+  reg   [47:0]                 div_q;                // chunk number in, row out
+  reg   [2:0]                  div_rem;
+  reg   [5:0]                  div_count;
+  reg   [31:0]                 seg_total;
+  reg   [31:0]                 sts_total;
+
+  wire  [47:0]                 chunk_mask;
+  wire  [47:0]                 chunk_off;
+  wire  [16:0]                 chunk_room;
+  wire  [15:0]                 seg_sectors;
+  wire  [47:0]                 seg_lba;
+  wire  [2:0]                  div_try;
+  wire                         gen_push;
+
+  // segment order queue, generator to data side
+  wire                         ord_full;
+  wire                         ord_empty;
+  wire  [65:0]                 ord_dout;
+  wire                         ord_ren;
+
+  // data side
+  reg                          d_active;
+  reg   [1:0]                  d_drive;
+  reg   [47:0]                 d_lba;
+  reg   [15:0]                 d_sectors;
+  reg   [22:0]                 d_left;
+  wire                         tx_accept;
+  wire                         rx_accept;
+  wire                         d_last;
+
+  // drive ports
+  wire  [NUM_DRIVES-1:0]       q_cmd_wen;
+  wire  [NUM_DRIVES-1:0]       q_cmd_full;
+  wire  [64:0]                 q_cmd_data;
+  reg   [NUM_DRIVES-1:0]       q_sts_ren;
+  wire  [NUM_DRIVES*17-1:0]    q_sts_data;
+  wire  [NUM_DRIVES-1:0]       q_sts_empty;
+  wire  [NUM_DRIVES-1:0]       stg_tx_wen;
+  wire  [NUM_DRIVES-1:0]       stg_tx_full;
+  wire  [NUM_DRIVES*32-1:0]    stg_rx_data;
+  wire  [NUM_DRIVES-1:0]       stg_rx_ren;
+  wire  [NUM_DRIVES-1:0]       stg_rx_empty;
+
+  integer                      k;
+
+  //******************************** segment generator **********************************
+  assign chunk_mask   = ~({48{1'b1}} << shift);
+  assign chunk_off    = lba & chunk_mask;
+  assign chunk_room   = (17'd1 << shift) - chunk_off[15:0];
+  assign seg_sectors  = (left < chunk_room) ? left[15:0] : chunk_room[15:0];
+  assign seg_lba      = (row << shift) | chunk_off;
+  assign div_try      = {div_rem[1:0], div_q[47]};
+  assign gen_push     = (state == G_SEG) && (left != 32'd0) && !ord_full && (dir || !q_cmd_full[drive]);
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      state        <= G_IDLE;
+      dir          <= 1'b0;
+      shift        <= 4'd0;
+      lba          <= 48'd0;
+      left         <= 32'd0;
+      row          <= 48'd0;
+      drive        <= 2'd0;
+      div_q        <= 48'd0;
+      div_rem      <= 3'd0;
+      div_count    <= 6'd0;
+      seg_total    <= 32'd0;
+      R0_BUSY      <= 1'b0;
+      R0_DONE      <= 1'b0;
+    end
+    else begin
+      R0_DONE      <= 1'b0;
+      case(state)
+        G_IDLE: begin
+          if(R0_START) begin
+            dir          <= R0_DIR;
+            shift        <= (R0_CHUNK_SHIFT > MAX_SHIFT) ? MAX_SHIFT : R0_CHUNK_SHIFT;
+            lba          <= R0_LBA;
+            left         <= R0_SECTORS;
+            div_q        <= R0_LBA >> ((R0_CHUNK_SHIFT > MAX_SHIFT) ? MAX_SHIFT : R0_CHUNK_SHIFT);
+            div_rem      <= 3'd0;
+            div_count    <= 6'd0;
+            seg_total    <= 32'd0;
+            R0_BUSY      <= 1'b1;
+            state        <= G_DIV;
+          end
+        end
+        G_DIV: begin                                     // chunk / NUM_DRIVES, one bit per clock
+          if(div_count == 6'd48) begin
+            row          <= div_q;
+            drive        <= div_rem[1:0];
+            state        <= G_SEG;
+          end
+          else begin
+            div_count    <= div_count + 1'b1;
+            if(div_try >= NUM_DRIVES) begin
+              div_rem      <= div_try - NUM_DRIVES;
+              div_q        <= {div_q[46:0], 1'b1};
+            end
+            else begin
+              div_rem      <= div_try;
+              div_q        <= {div_q[46:0], 1'b0};
+            end
+          end
+        end
+        G_SEG: begin
+          if(left == 32'd0) begin
+            state        <= G_WAIT;
+          end
+          else if(gen_push) begin
+            seg_total    <= seg_total + 1'b1;
+            lba          <= lba + seg_sectors;
+            left         <= left - seg_sectors;
+            if(drive == NUM_DRIVES - 1) begin
+              drive        <= 2'd0;
+              row          <= row + 1'b1;
+            end
+            else begin
+              drive        <= drive + 1'b1;
+            end
+          end
+        end
+        G_WAIT: begin
+          if(sts_total == seg_total && ord_empty && !d_active) begin
+            R0_BUSY      <= 1'b0;
+            R0_DONE      <= 1'b1;
+            state        <= G_IDLE;
+          end
+        end
+        default: begin
+          state        <= G_IDLE;
+        end
+      endcase
+    end
+  end
+
+  sata_async_fifo #(
+    .DATA_WIDTH  (66),
+    .ADDR_WIDTH  (4)
+    )
+  order_queue (
+    .rst         (RESET),
+    .wr_clk      (CLK),
+    .wr_en       (gen_push),
+    .din         ({drive, seg_lba, seg_sectors}),
+    .full        (ord_full),
+    .wr_count    (),
+    .rd_clk      (CLK),
+    .rd_en       (ord_ren),
+    .dout        (ord_dout),
+    .empty       (ord_empty),
+    .rd_count    ()
+    );
+
+  //******************************** ending status **************************************
+  always @(*)
+  begin
+    q_sts_ren = {NUM_DRIVES{1'b0}};
+    for(k = NUM_DRIVES-1; k >= 0; k = k - 1) begin
+      if(!q_sts_empty[k]) begin
+        q_sts_ren    = {NUM_DRIVES{1'b0}};
+        q_sts_ren[k] = 1'b1;
+      end
+    end
+  end
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      sts_total    <= 32'd0;
+      R0_ERROR     <= 1'b0;
+      R0_ERR_MASK  <= {NUM_DRIVES{1'b0}};
+    end
+    else if(state == G_IDLE && R0_START) begin
+      sts_total    <= 32'd0;
+      R0_ERROR     <= 1'b0;
+      R0_ERR_MASK  <= {NUM_DRIVES{1'b0}};
+    end
+    else begin
+      for(k = 0; k < NUM_DRIVES; k = k + 1) begin
+        if(q_sts_ren[k]) begin
+          sts_total    <= sts_total + 1'b1;
+          if(q_sts_data[k*17+16]) begin
+            R0_ERROR       <= 1'b1;
+            R0_ERR_MASK[k] <= 1'b1;
+          end
+        end
+      end
+    end
+  end
+
+  //******************************** data side ******************************************
+  assign ord_ren       = !d_active && !ord_empty;
+  assign d_last        = (d_left == 23'd1);
+
+  assign USR_TX_HOLD   = !d_active || !dir || stg_tx_full[d_drive] || (d_last && q_cmd_full[d_drive]);
+  assign tx_accept     = USR_TX_WEN && !USR_TX_HOLD;
+  assign USR_RX_EMPTY  = !d_active || dir || stg_rx_empty[d_drive];
+  assign USR_RX_DATA   = stg_rx_data[d_drive*32 +: 32];
+  assign rx_accept     = USR_RX_REN && !USR_RX_EMPTY;
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      d_active     <= 1'b0;
+      d_drive      <= 2'd0;
+      d_lba        <= 48'd0;
+      d_sectors    <= 16'd0;
+      d_left       <= 23'd0;
+    end
+    else if(ord_ren) begin
+      d_active     <= 1'b1;
+      {d_drive, d_lba, d_sectors} <= ord_dout;
+      d_left       <= {ord_dout[15:0], 7'd0};
+    end
+    else if(tx_accept || rx_accept) begin
+      d_left       <= d_left - 1'b1;
+      if(d_last) begin
+        d_active     <= 1'b0;
+      end
+    end
+  end
+
+  // write commands are queued behind their last data word, read commands by the generator
+  assign q_cmd_data    = dir ? {1'b1, d_lba, d_sectors} : {1'b0, seg_lba, seg_sectors};
+
+  //******************************** drive ports ****************************************
+  genvar n;
+  generate
+    for(n = 0; n < NUM_DRIVES; n = n + 1) begin : drv
+      assign q_cmd_wen[n]  = dir ? (tx_accept && d_last && d_drive == n) : (gen_push && drive == n);
+      assign stg_tx_wen[n] = tx_accept && (d_drive == n);
+      assign stg_rx_ren[n] = rx_accept && (d_drive == n);
+
+      SATA_DRIVE_PORT #(
+        .STAGE_ADDR_WIDTH  (STAGE_ADDR_WIDTH)
+        )
+      port_i (
+        .CLK               (CLK),
+        .RESET             (RESET),
+        .Q_CMD_WEN         (q_cmd_wen[n]),
+        .Q_CMD_DATA        (q_cmd_data),
+        .Q_CMD_FULL        (q_cmd_full[n]),
+        .Q_STS_REN         (q_sts_ren[n]),
+        .Q_STS_DATA        (q_sts_data[n*17+16:n*17]),
+        .Q_STS_EMPTY       (q_sts_empty[n]),
+        .TX_DATA           (USR_TX_DATA),
+        .TX_WEN            (stg_tx_wen[n]),
+        .TX_FULL           (stg_tx_full[n]),
+        .TX_COUNT          (),
+        .RX_DATA           (stg_rx_data[n*32+31:n*32]),
+        .RX_REN            (stg_rx_ren[n]),
+        .RX_EMPTY          (stg_rx_empty[n]),
+        .PORT_CLK          (PORT_CLK[n]),
+        .LINKUP            (LINKUP[n]),
+        .HOST_READ_EN      (HOST_READ_EN[n]),
+        .HOST_WRITE_EN     (HOST_WRITE_EN[n]),
+        .HOST_ADDR_REG     (HOST_ADDR_REG[n*5+4:n*5]),
+        .HOST_DATA_IN      (HOST_DATA_IN[n*32+31:n*32]),
+        .HOST_DATA_OUT     (HOST_DATA_OUT[n*32+31:n*32]),
+        .DMA_TX_DATA_IN    (DMA_TX_DATA_IN[n*32+31:n*32]),
+        .DMA_TX_WEN        (DMA_TX_WEN[n]),
+        .WRITE_HOLD_U      (WRITE_HOLD_U[n]),
+        .DMA_RX_DATA_OUT   (DMA_RX_DATA_OUT[n*32+31:n*32]),
+        .DMA_RX_REN        (DMA_RX_REN[n]),
+        .READ_HOLD_U       (READ_HOLD_U[n]),
+        .TX_FIFO_RESET     (TX_FIFO_RESET[n]),
+        .RX_FIFO_RESET     (RX_FIFO_RESET[n])
+        );
+    end
+  endgenerate
+
+endmodule
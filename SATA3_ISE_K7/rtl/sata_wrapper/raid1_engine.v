@@ -0,0 +1,543 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : RAID-1 mirroring engine
+//  File name   : raid1_engine.v
+//  Note        : Mirrors one LBA range on two ports of SATA_CONTROLLER_MP
+//                (drive 0 and drive 1).
+//                Foreground transfers (R1_*) are cut in segments of
+//                SEG_SECTORS. Write data is copied into the staging FIFO of
+//                every mirror in service and the segment is queued on all of
+//                them; the transfer ends when every mirror has answered.
+//                With R1_DEGRADED_OK a mirror that fails a write is marked
+//                in R1_FAILED and taken out of service, the transfer only
+//                fails when no mirror is left. Each read segment goes to the
+//                in service mirror with the fewest read commands
+//                outstanding (alternating on a tie).
+//                Background resync (RS_*) copies a range from RS_SRC to the
+//                other drive, a segment at a time, while foreground I/O
+//                goes on; the two share the command queues segment by
+//                segment. During a resync foreground writes also go to the
+//                target, reads never use it. A resync read is only queued
+//                when no foreground write is between generation and command
+//                queueing, so a copied segment can not overwrite newer
+//                foreground data on the target. RS_WATERMARK is the first
+//                LBA not yet written to the target.
+//                All data moves through one ordered data side, in the order
+//                the segments were generated.
+//  Design ref. : -
+//  Dependencies   : SATA_DRIVE_PORT, sata_async_fifo
+//////////////////////////////////////////////////////////////////////////////
+
+module RAID1_ENGINE #(
+    parameter  STAGE_ADDR_WIDTH = 14,                  // per drive staging FIFO, 2**STAGE_ADDR_WIDTH words
+    parameter  SEG_SECTORS      = 16'd128              // sectors per command, at most 2**(STAGE_ADDR_WIDTH-7)
+    )
+    (
+    input                     CLK,                     // engine / user clock
+    input                     RESET,
+
+    // foreground control / status
+    input                     R1_START,                // pulse
+    input                     R1_DIR,                  // 1 : write, 0 : read
+    input      [47:0]         R1_LBA,
+    input      [31:0]         R1_SECTORS,
+    input      [1:0]          R1_MEMBER_EN,            // mirrors in service
+    input                     R1_DEGRADED_OK,          // 1 : a write survives the loss of one mirror
+    input                     R1_CLEAR_FAILED,
+    output reg                R1_BUSY,
+    output reg                R1_DONE,                 // one clock pulse
+    output reg                R1_ERROR,
+    output reg [1:0]          R1_FAILED,               // sticky, mirror failed a command
+    output reg [31:0]         R1_RD_SEG0,              // read segments served by drive 0
+    output reg [31:0]         R1_RD_SEG1,              // read segments served by drive 1
+
+    // background resync
+    input                     RS_START,                // pulse
+    input                     RS_SRC,                  // source drive, the other one is written
+    input      [47:0]         RS_LBA,
+    input      [47:0]         RS_SECTORS,
+    output reg                RS_BUSY,
+    output reg                RS_DONE,                 // one clock pulse
+    output reg                RS_ERROR,
+    output reg [47:0]         RS_WATERMARK,
+
+    // user data
+    input      [31:0]         USR_TX_DATA,
+    input                     USR_TX_WEN,
+    output                    USR_TX_HOLD,
+    output     [31:0]         USR_RX_DATA,
+    input                     USR_RX_REN,
+    output                    USR_RX_EMPTY,
+
+    // to the SATA_CONTROLLER_MP ports, port n on bit n / slice n
+    input      [1:0]          PORT_CLK,
+    input      [1:0]          LINKUP,
+    output     [1:0]          HOST_READ_EN,
+    output     [1:0]          HOST_WRITE_EN,
+    output     [9:0]          HOST_ADDR_REG,
+    output     [63:0]         HOST_DATA_IN,
+    input      [63:0]         HOST_DATA_OUT,
+    output     [63:0]         DMA_TX_DATA_IN,
+    output     [1:0]          DMA_TX_WEN,
+    input      [1:0]          WRITE_HOLD_U,
+    input      [63:0]         DMA_RX_DATA_OUT,
+    output     [1:0]          DMA_RX_REN,
+    input      [1:0]          READ_HOLD_U,
+    output     [1:0]          TX_FIFO_RESET,
+    output     [1:0]          RX_FIFO_RESET
+    );
+
+  parameter  F_IDLE        = 2'h0;
+  parameter  F_SEG         = 2'h1;
+  parameter  F_WAIT        = 2'h2;
+
+  // segment types in the order queue
+  parameter  T_READ        = 2'h0;
+  parameter  T_WRITE       = 2'h1;
+  parameter  T_COPY        = 2'h2;
+
+  // command tags, kept per drive in command order
+  parameter  G_FG_READ     = 2'h0;
+  parameter  G_FG_WRITE    = 2'h1;
+  parameter  G_RS_READ     = 2'h2;
+  parameter  G_RS_WRITE    = 2'h3;
+
+  // foreground generator
+  reg   [1:0]                  state;
+  reg                          dir;
+  reg   [47:0]                 lba;
+  reg   [31:0]                 left;
+  reg   [15:0]                 fg_wr_pending;        // write segments generated, commands not queued yet
+  reg   [15:0]                 fg_seg_pending;       // foreground segments not finished by the data side
+  reg   [15:0]                 fg_cmd_out;           // foreground commands without status
+  reg                          last_pick;
+  reg                          rs_turn;
+
+  // resync generator
+  reg                          rs_src;
+  reg   [47:0]                 rs_lba;
+  reg   [47:0]                 rs_left;
+  reg   [15:0]                 rs_cmd_out;
+  reg   [15:0]                 rs_seg_pending;       // copy segments not finished by the data side
+
+  reg   [15:0]                 rd_out0, rd_out1;     // read commands outstanding per drive
+
+  wire  [1:0]                  rs_tgt_mask;
+  wire  [1:0]                  wr_mask;
+  wire  [1:0]                  rd_mask;
+  wire                         pick;
+  wire  [15:0]                 fg_seg;
+  wire  [15:0]                 rs_seg;
+  wire                         fg_want;
+  wire                         rs_want;
+  wire                         fg_push;
+  wire                         rs_push;
+  wire  [1:0]                  fg_mask;
+
+  // order queue {type, mask, lba, sectors}
+  wire                         ord_wen;
+  wire  [67:0]                 ord_din;
+  wire                         ord_full;
+  wire                         ord_empty;
+  wire  [67:0]                 ord_dout;
+  wire                         ord_ren;
+
+  // data side
+  reg                          d_active;
+  reg   [1:0]                  d_type;
+  reg   [1:0]                  d_mask;
+  reg   [47:0]                 d_lba;
+  reg   [15:0]                 d_sectors;
+  reg   [22:0]                 d_left;
+  wire                         d_last;
+  wire                         d_src;
+  wire                         d_tgt;
+  wire                         tx_accept;
+  wire                         rx_accept;
+  wire                         copy_move;
+  wire                         d_move;
+  wire  [1:0]                  ds_cmd_wen;
+  wire                         ds_cmd_any;
+
+  // drive ports
+  wire  [1:0]                  q_cmd_wen;
+  wire  [129:0]                q_cmd_data;
+  wire  [1:0]                  q_cmd_full;
+  wire  [1:0]                  q_sts_ren;
+  wire  [33:0]                 q_sts_data;
+  wire  [1:0]                  q_sts_empty;
+  wire  [1:0]                  stg_tx_wen;
+  wire  [1:0]                  stg_tx_full;
+  wire  [31:0]                 stg_tx_din;
+  wire  [63:0]                 stg_rx_data;
+  wire  [1:0]                  stg_rx_ren;
+  wire  [1:0]                  stg_rx_empty;
+  wire  [35:0]                 tag_din;
+  wire  [35:0]                 tag_dout;
+  wire  [1:0]                  sts_err;
+  wire  [1:0]                  sts_tag0, sts_tag1;
+
+  // per clock counter updates
+  wire  [1:0]                  fg_cmd_inc, fg_cmd_dec;
+  wire  [1:0]                  rs_cmd_inc, rs_cmd_dec;
+  wire                         rd0_inc, rd0_dec, rd1_inc, rd1_dec;
+
+  //******************************** segment generators *********************************
+  assign rs_tgt_mask  = RS_BUSY ? (rs_src ? 2'b01 : 2'b10) : 2'b00;
+  assign wr_mask      = (R1_MEMBER_EN & ~R1_FAILED) | rs_tgt_mask;
+  assign rd_mask      = R1_MEMBER_EN & ~R1_FAILED & ~rs_tgt_mask;
+  assign pick         = (rd_mask == 2'b01) ? 1'b0 :
+                        (rd_mask == 2'b10) ? 1'b1 :
+                        (rd_out0 < rd_out1) ? 1'b0 :
+                        (rd_out1 < rd_out0) ? 1'b1 : !last_pick;
+  assign fg_mask      = dir ? wr_mask : (rd_mask == 2'b00) ? 2'b00 : (pick ? 2'b10 : 2'b01);
+
+  assign fg_seg       = (left < SEG_SECTORS) ? left[15:0] : SEG_SECTORS;
+  assign rs_seg       = (rs_left < SEG_SECTORS) ? rs_left[15:0] : SEG_SECTORS;
+
+  // the data side has the command queues first, a generator waits one clock
+  assign fg_want      = (state == F_SEG) && (left != 32'd0) && (fg_mask != 2'b00) && !ord_full && !ds_cmd_any &&
+                        (dir || !q_cmd_full[pick]);
+  assign rs_want      = RS_BUSY && (rs_left != 48'd0) && !RS_ERROR && (fg_wr_pending == 16'd0) &&
+                        !ord_full && !ds_cmd_any && !q_cmd_full[rs_src];
+  assign fg_push      = fg_want && (!rs_want || !rs_turn);
+  assign rs_push      = rs_want && (!fg_want || rs_turn);
+
+  assign ord_wen      = fg_push || rs_push;
+  assign ord_din      = rs_push ? {T_COPY, (rs_src ? 2'b10 : 2'b01), rs_lba, rs_seg} :
+                                  {(dir ? T_WRITE : T_READ), fg_mask, lba, fg_seg};
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      state        <= F_IDLE;
+      dir          <= 1'b0;
+      lba          <= 48'd0;
+      left         <= 32'd0;
+      last_pick    <= 1'b0;
+      rs_turn      <= 1'b0;
+      R1_BUSY      <= 1'b0;
+      R1_DONE      <= 1'b0;
+      R1_RD_SEG0   <= 32'd0;
+      R1_RD_SEG1   <= 32'd0;
+    end
+    else begin
+      R1_DONE      <= 1'b0;
+      if(fg_want && rs_want) begin
+        rs_turn      <= !rs_turn;
+      end
+      case(state)
+        F_IDLE: begin
+          if(R1_START) begin
+            dir          <= R1_DIR;
+            lba          <= R1_LBA;
+            left         <= R1_SECTORS;
+            R1_BUSY      <= 1'b1;
+            state        <= F_SEG;
+          end
+        end
+        F_SEG: begin
+          if(left == 32'd0 || fg_mask == 2'b00) begin    // no mirror left, the error is flagged below
+            state        <= F_WAIT;
+          end
+          else if(fg_push) begin
+            lba          <= lba + fg_seg;
+            left         <= left - fg_seg;
+            if(!dir) begin
+              last_pick    <= pick;
+              if(pick) begin
+                R1_RD_SEG1   <= R1_RD_SEG1 + 1'b1;
+              end
+              else begin
+                R1_RD_SEG0   <= R1_RD_SEG0 + 1'b1;
+              end
+            end
+          end
+        end
+        F_WAIT: begin
+          if(fg_seg_pending == 16'd0 && fg_cmd_out == 16'd0) begin
+            R1_BUSY      <= 1'b0;
+            R1_DONE      <= 1'b1;
+            state        <= F_IDLE;
+          end
+        end
+        default: begin
+          state        <= F_IDLE;
+        end
+      endcase
+    end
+  end
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      rs_src       <= 1'b0;
+      rs_lba       <= 48'd0;
+      rs_left      <= 48'd0;
+      RS_BUSY      <= 1'b0;
+      RS_DONE      <= 1'b0;
+    end
+    else begin
+      RS_DONE      <= 1'b0;
+      if(!RS_BUSY) begin
+        if(RS_START) begin
+          rs_src       <= RS_SRC;
+          rs_lba       <= RS_LBA;
+          rs_left      <= RS_SECTORS;
+          RS_BUSY      <= 1'b1;
+        end
+      end
+      else if(rs_push) begin
+        rs_lba       <= rs_lba + rs_seg;
+        rs_left      <= rs_left - rs_seg;
+      end
+      else if((rs_left == 48'd0 || RS_ERROR) && rs_seg_pending == 16'd0 && rs_cmd_out == 16'd0) begin
+        RS_BUSY      <= 1'b0;
+        RS_DONE      <= 1'b1;
+      end
+    end
+  end
+
+  sata_async_fifo #(
+    .DATA_WIDTH  (68),
+    .ADDR_WIDTH  (4)
+    )
+  order_queue (
+    .rst         (RESET),
+    .wr_clk      (CLK),
+    .wr_en       (ord_wen),
+    .din         (ord_din),
+    .full        (ord_full),
+    .wr_count    (),
+    .rd_clk      (CLK),
+    .rd_en       (ord_ren),
+    .dout        (ord_dout),
+    .empty       (ord_empty),
+    .rd_count    ()
+    );
+
+  //******************************** data side ******************************************
+  assign ord_ren       = !d_active && !ord_empty;
+  assign d_last        = (d_left == 23'd1);
+  assign d_src         = d_mask[1];                      // read drive / copy source
+  assign d_tgt         = !d_mask[1];                     // copy target
+
+  assign USR_TX_HOLD   = !d_active || (d_type != T_WRITE) || ((stg_tx_full & d_mask) != 2'b00) ||
+                         (d_last && ((q_cmd_full & d_mask) != 2'b00));
+  assign tx_accept     = USR_TX_WEN && !USR_TX_HOLD;
+  assign USR_RX_EMPTY  = !d_active || (d_type != T_READ) || stg_rx_empty[d_src];
+  assign USR_RX_DATA   = d_src ? stg_rx_data[63:32] : stg_rx_data[31:0];
+  assign rx_accept     = USR_RX_REN && !USR_RX_EMPTY;
+  assign copy_move     = d_active && (d_type == T_COPY) && !stg_rx_empty[d_src] && !stg_tx_full[d_tgt] &&
+                         !(d_last && q_cmd_full[d_tgt]);
+  assign d_move        = tx_accept || rx_accept || copy_move;
+
+  assign stg_tx_din    = (d_type == T_COPY) ? (d_src ? stg_rx_data[63:32] : stg_rx_data[31:0]) : USR_TX_DATA;
+  assign stg_tx_wen[0] = (tx_accept && d_mask[0]) || (copy_move && !d_tgt);
+  assign stg_tx_wen[1] = (tx_accept && d_mask[1]) || (copy_move && d_tgt);
+  assign stg_rx_ren[0] = (rx_accept || copy_move) && !d_src;
+  assign stg_rx_ren[1] = (rx_accept || copy_move) && d_src;
+
+  // write commands follow their last data word
+  assign ds_cmd_wen[0] = d_last && ((tx_accept && d_mask[0]) || (copy_move && !d_tgt));
+  assign ds_cmd_wen[1] = d_last && ((tx_accept && d_mask[1]) || (copy_move && d_tgt));
+  assign ds_cmd_any    = d_active && d_last && (d_type != T_READ);
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      d_active       <= 1'b0;
+      d_type         <= 2'd0;
+      d_mask         <= 2'd0;
+      d_lba          <= 48'd0;
+      d_sectors      <= 16'd0;
+      d_left         <= 23'd0;
+      fg_wr_pending  <= 16'd0;
+      fg_seg_pending <= 16'd0;
+      rs_seg_pending <= 16'd0;
+    end
+    else begin
+      if(ord_ren) begin
+        d_active       <= 1'b1;
+        {d_type, d_mask, d_lba, d_sectors} <= ord_dout;
+        d_left         <= {ord_dout[15:0], 7'd0};
+      end
+      else if(d_move) begin
+        d_left         <= d_left - 1'b1;
+        if(d_last) begin
+          d_active       <= 1'b0;
+        end
+      end
+
+      if(fg_push && dir && !(d_move && d_last && d_type == T_WRITE)) begin
+        fg_wr_pending  <= fg_wr_pending + 1'b1;
+      end
+      else if(!(fg_push && dir) && d_move && d_last && d_type == T_WRITE) begin
+        fg_wr_pending  <= fg_wr_pending - 1'b1;
+      end
+
+      if(fg_push && !(d_move && d_last && d_type != T_COPY)) begin
+        fg_seg_pending <= fg_seg_pending + 1'b1;
+      end
+      else if(!fg_push && d_move && d_last && d_type != T_COPY) begin
+        fg_seg_pending <= fg_seg_pending - 1'b1;
+      end
+
+      if(rs_push && !(d_move && d_last && d_type == T_COPY)) begin
+        rs_seg_pending <= rs_seg_pending + 1'b1;
+      end
+      else if(!rs_push && d_move && d_last && d_type == T_COPY) begin
+        rs_seg_pending <= rs_seg_pending - 1'b1;
+      end
+    end
+  end
+
+  //******************************** command queues / ending status *********************
+  assign q_cmd_wen[0]  = ds_cmd_wen[0] || (fg_push && !dir && !pick) || (rs_push && !rs_src);
+  assign q_cmd_wen[1]  = ds_cmd_wen[1] || (fg_push && !dir && pick)  || (rs_push && rs_src);
+  assign q_cmd_data[64:0]   = ds_cmd_wen[0] ? {1'b1, d_lba, d_sectors} :
+                              rs_push       ? {1'b0, rs_lba, rs_seg} : {1'b0, lba, fg_seg};
+  assign q_cmd_data[129:65] = ds_cmd_wen[1] ? {1'b1, d_lba, d_sectors} :
+                              rs_push       ? {1'b0, rs_lba, rs_seg} : {1'b0, lba, fg_seg};
+  assign tag_din[17:0]      = ds_cmd_wen[0] ? {((d_type == T_COPY) ? G_RS_WRITE : G_FG_WRITE), d_sectors} :
+                              rs_push       ? {G_RS_READ, rs_seg} : {G_FG_READ, fg_seg};
+  assign tag_din[35:18]     = ds_cmd_wen[1] ? {((d_type == T_COPY) ? G_RS_WRITE : G_FG_WRITE), d_sectors} :
+                              rs_push       ? {G_RS_READ, rs_seg} : {G_FG_READ, fg_seg};
+
+  assign q_sts_ren     = ~q_sts_empty;
+  assign sts_err       = {q_sts_data[33], q_sts_data[16]};
+  assign sts_tag0      = tag_dout[17:16];
+  assign sts_tag1      = tag_dout[35:34];
+
+  assign fg_cmd_inc    = {1'b0, q_cmd_wen[0] && (tag_din[17:16] == G_FG_READ || tag_din[17:16] == G_FG_WRITE)} +
+                         {1'b0, q_cmd_wen[1] && (tag_din[35:34] == G_FG_READ || tag_din[35:34] == G_FG_WRITE)};
+  assign fg_cmd_dec    = {1'b0, q_sts_ren[0] && !sts_tag0[1]} + {1'b0, q_sts_ren[1] && !sts_tag1[1]};
+  assign rs_cmd_inc    = {1'b0, q_cmd_wen[0] && tag_din[17]} + {1'b0, q_cmd_wen[1] && tag_din[35]};
+  assign rs_cmd_dec    = {1'b0, q_sts_ren[0] && sts_tag0[1]} + {1'b0, q_sts_ren[1] && sts_tag1[1]};
+  assign rd0_inc       = q_cmd_wen[0] && !tag_din[16];
+  assign rd1_inc       = q_cmd_wen[1] && !tag_din[34];
+  assign rd0_dec       = q_sts_ren[0] && !sts_tag0[0];
+  assign rd1_dec       = q_sts_ren[1] && !sts_tag1[0];
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      fg_cmd_out     <= 16'd0;
+      rs_cmd_out     <= 16'd0;
+      rd_out0        <= 16'd0;
+      rd_out1        <= 16'd0;
+      R1_ERROR       <= 1'b0;
+      R1_FAILED      <= 2'b00;
+      RS_ERROR       <= 1'b0;
+      RS_WATERMARK   <= 48'd0;
+    end
+    else begin
+      fg_cmd_out     <= fg_cmd_out + fg_cmd_inc - fg_cmd_dec;
+      rs_cmd_out     <= rs_cmd_out + rs_cmd_inc - rs_cmd_dec;
+      rd_out0        <= rd_out0 + rd0_inc - rd0_dec;
+      rd_out1        <= rd_out1 + rd1_inc - rd1_dec;
+
+      if(state == F_IDLE && R1_START) begin
+        R1_ERROR       <= 1'b0;
+      end
+      else if(state == F_SEG && left != 32'd0 && fg_mask == 2'b00) begin
+        R1_ERROR       <= 1'b1;
+      end
+      if(R1_CLEAR_FAILED) begin
+        R1_FAILED      <= 2'b00;
+      end
+      if(!RS_BUSY && RS_START) begin
+        RS_ERROR       <= 1'b0;
+        RS_WATERMARK   <= RS_LBA;
+      end
+
+      // a read error always fails the transfer, the data was zero filled
+      if(q_sts_ren[0] && sts_err[0]) begin
+        case(sts_tag0)
+          G_FG_READ : begin R1_FAILED[0] <= 1'b1; R1_ERROR <= 1'b1; end
+          G_FG_WRITE: begin R1_FAILED[0] <= 1'b1; R1_ERROR <= R1_ERROR || !R1_DEGRADED_OK || !wr_mask[1]; end
+          default   : begin RS_ERROR <= 1'b1; end
+        endcase
+      end
+      if(q_sts_ren[1] && sts_err[1]) begin
+        case(sts_tag1)
+          G_FG_READ : begin R1_FAILED[1] <= 1'b1; R1_ERROR <= 1'b1; end
+          G_FG_WRITE: begin R1_FAILED[1] <= 1'b1; R1_ERROR <= R1_ERROR || !R1_DEGRADED_OK || !wr_mask[0]; end
+          default   : begin RS_ERROR <= 1'b1; end
+        endcase
+      end
+
+      // target writes complete in LBA order
+      if(q_sts_ren[0] && !sts_err[0] && sts_tag0 == G_RS_WRITE) begin
+        RS_WATERMARK   <= RS_WATERMARK + tag_dout[15:0];
+      end
+      else if(q_sts_ren[1] && !sts_err[1] && sts_tag1 == G_RS_WRITE) begin
+        RS_WATERMARK   <= RS_WATERMARK + tag_dout[33:18];
+      end
+    end
+  end
+
+  //******************************** drive ports ****************************************
+  genvar n;
+  generate
+    for(n = 0; n < 2; n = n + 1) begin : drv
+
+      // command tags, same order as the command queue
+      sata_async_fifo #(
+        .DATA_WIDTH  (18),
+        .ADDR_WIDTH  (5)
+        )
+      tag_queue (
+        .rst         (RESET),
+        .wr_clk      (CLK),
+        .wr_en       (q_cmd_wen[n]),
+        .din         (tag_din[n*18+17:n*18]),
+        .full        (),
+        .wr_count    (),
+        .rd_clk      (CLK),
+        .rd_en       (q_sts_ren[n]),
+        .dout        (tag_dout[n*18+17:n*18]),
+        .empty       (),
+        .rd_count    ()
+        );
+
+      SATA_DRIVE_PORT #(
+        .STAGE_ADDR_WIDTH  (STAGE_ADDR_WIDTH)
+        )
+      port_i (
+        .CLK               (CLK),
+        .RESET             (RESET),
+        .Q_CMD_WEN         (q_cmd_wen[n]),
+        .Q_CMD_DATA        (q_cmd_data[n*65+64:n*65]),
+        .Q_CMD_FULL        (q_cmd_full[n]),
+        .Q_STS_REN         (q_sts_ren[n]),
+        .Q_STS_DATA        (q_sts_data[n*17+16:n*17]),
+        .Q_STS_EMPTY       (q_sts_empty[n]),
+        .TX_DATA           (stg_tx_din),
+        .TX_WEN            (stg_tx_wen[n]),
+        .TX_FULL           (stg_tx_full[n]),
+        .TX_COUNT          (),
+        .RX_DATA           (stg_rx_data[n*32+31:n*32]),
+        .RX_REN            (stg_rx_ren[n]),
+        .RX_EMPTY          (stg_rx_empty[n]),
+        .PORT_CLK          (PORT_CLK[n]),
+        .LINKUP            (LINKUP[n]),
+        .HOST_READ_EN      (HOST_READ_EN[n]),
+        .HOST_WRITE_EN     (HOST_WRITE_EN[n]),
+        .HOST_ADDR_REG     (HOST_ADDR_REG[n*5+4:n*5]),
+        .HOST_DATA_IN      (HOST_DATA_IN[n*32+31:n*32]),
+        .HOST_DATA_OUT     (HOST_DATA_OUT[n*32+31:n*32]),
+        .DMA_TX_DATA_IN    (DMA_TX_DATA_IN[n*32+31:n*32]),
+        .DMA_TX_WEN        (DMA_TX_WEN[n]),
+        .WRITE_HOLD_U      (WRITE_HOLD_U[n]),
+        .DMA_RX_DATA_OUT   (DMA_RX_DATA_OUT[n*32+31:n*32]),
+        .DMA_RX_REN        (DMA_RX_REN[n]),
+        .READ_HOLD_U       (READ_HOLD_U[n]),
+        .TX_FIFO_RESET     (TX_FIFO_RESET[n]),
+        .RX_FIFO_RESET     (RX_FIFO_RESET[n])
+        );
+    end
+  endgenerate
+
+endmodule
@@ -0,0 +1,693 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : RAID-5 parity engine
+//  File name   : raid5_engine.v
+//  Note        : Distributed parity over NUM_DRIVES (3 or 4) ports of
+//                SATA_CONTROLLER_MP. Chunks are 2**CHUNK_SHIFT sectors, a
+//                stripe is NUM_DRIVES-1 data chunks and one parity chunk;
+//                the parity of stripe s is on drive N-1-(s mod N), data
+//                chunk j on drive (parity + 1 + j) mod N, all at drive LBA
+//                s * chunk + offset (left symmetric).
+//                Writes :
+//                  full stripe : the data chunks go straight to their drives
+//                  while the parity is XOR accumulated in a BRAM stripe
+//                  buffer (two banks, the parity of one stripe is written
+//                  out while the next one is accumulated), no reads.
+//                  partial stripe : read-modify-write per segment, old data
+//                  and old parity are read and new parity = old parity ^
+//                  old data ^ new data is formed on the fly.
+//                Degraded mode (R5_FAIL_EN) : reads of the failed drive are
+//                rebuilt from the XOR of the other drives, writes skip the
+//                failed drive (reconstruct-write when its data changes).
+//                Verify (R5_OP = 2) reads all drives over a drive LBA range
+//                and counts the words whose XOR is not 0.
+//                A partial stripe segment waits until all earlier write
+//                commands are queued, so it never reads stale parity.
+//  Design ref. : -
+//  Dependencies   : SATA_DRIVE_PORT, sata_async_fifo
+//////////////////////////////////////////////////////////////////////////////
+
+module RAID5_ENGINE #(
+    parameter  NUM_DRIVES       = 4,                   // 3 or 4
+    parameter  CHUNK_SHIFT      = 5,                   // chunk = 2**CHUNK_SHIFT sectors (16 KB)
+    parameter  STAGE_ADDR_WIDTH = 14                   // per drive staging FIFO, at least CHUNK_SHIFT + 7
+    )
+    (
+    input                            CLK,              // engine / user clock
+    input                            RESET,
+
+    // control / status
+    input                            R5_START,         // pulse
+    input      [1:0]                 R5_OP,            // 0 : read, 1 : write, 2 : verify
+    input      [47:0]                R5_LBA,           // logical LBA, drive LBA for verify
+    input      [31:0]                R5_SECTORS,
+    input                            R5_FAIL_EN,       // degraded mode
+    input      [1:0]                 R5_FAIL_DRIVE,    // failed drive
+    output reg                       R5_BUSY,
+    output reg                       R5_DONE,          // one clock pulse
+    output reg                       R5_ERROR,
+    output reg [NUM_DRIVES-1:0]      R5_ERR_MASK,      // drives with a failed command
+    output reg [31:0]                R5_FULL_STRIPES,  // full stripe writes
+    output reg [31:0]                R5_RMW_SEGS,      // read-modify-write segments
+    output reg [31:0]                R5_MISMATCH,      // verify, words with parity mismatch
+
+    // user data, logical order
+    input      [31:0]                USR_TX_DATA,
+    input                            USR_TX_WEN,
+    output                           USR_TX_HOLD,
+    output     [31:0]                USR_RX_DATA,
+    input                            USR_RX_REN,
+    output                           USR_RX_EMPTY,
+
+    // to the SATA_CONTROLLER_MP ports, port n on bit n / slice n
+    input      [NUM_DRIVES-1:0]      PORT_CLK,
+    input      [NUM_DRIVES-1:0]      LINKUP,
+    output     [NUM_DRIVES-1:0]      HOST_READ_EN,
+    output     [NUM_DRIVES-1:0]      HOST_WRITE_EN,
+    output     [NUM_DRIVES*5-1:0]    HOST_ADDR_REG,
+    output     [NUM_DRIVES*32-1:0]   HOST_DATA_IN,
+    input      [NUM_DRIVES*32-1:0]   HOST_DATA_OUT,
+    output     [NUM_DRIVES*32-1:0]   DMA_TX_DATA_IN,
+    output     [NUM_DRIVES-1:0]      DMA_TX_WEN,
+    input      [NUM_DRIVES-1:0]      WRITE_HOLD_U,
+    input      [NUM_DRIVES*32-1:0]   DMA_RX_DATA_OUT,
+    output     [NUM_DRIVES-1:0]      DMA_RX_REN,
+    input      [NUM_DRIVES-1:0]      READ_HOLD_U,
+    output     [NUM_DRIVES-1:0]      TX_FIFO_RESET,
+    output     [NUM_DRIVES-1:0]      RX_FIFO_RESET
+    );
+
+  parameter  G_IDLE        = 3'h0;
+  parameter  G_DIV1        = 3'h1;                     // chunk / data drives
+  parameter  G_DIV2        = 3'h2;                     // stripe mod drives
+  parameter  G_SEG         = 3'h3;
+  parameter  G_WAIT        = 3'h4;
+
+  parameter  OP_READ       = 2'h0;
+  parameter  OP_WRITE      = 2'h1;
+  parameter  OP_VERIFY     = 2'h2;
+
+  // segment types
+  parameter  T_READ        = 3'h0;                     // user <- data drive
+  parameter  T_RECON       = 3'h1;                     // user <- XOR of the other drives
+  parameter  T_FULL        = 3'h2;                     // user -> data drive, parity accumulated
+  parameter  T_RMW         = 3'h3;                     // user, old data, old parity -> data, parity
+  parameter  T_RCW         = 3'h4;                     // user, other data -> parity (data drive failed)
+  parameter  T_WDATA       = 3'h5;                     // user -> data drive (parity drive failed)
+  parameter  T_VERIFY      = 3'h6;                     // XOR of all drives must be 0
+
+  localparam N             = NUM_DRIVES;
+  localparam D             = NUM_DRIVES - 1;
+  localparam CHUNK_WORDS   = (1 << (CHUNK_SHIFT + 7));
+  localparam ALL           = (1 << NUM_DRIVES) - 1;
+
+  // segment generator
+  reg   [2:0]                  state;
+  reg   [1:0]                  op;
+  reg   [N-1:0]                fmask;                // failed drive, one hot
+  reg   [47:0]                 vlba;                 // verify drive LBA
+  reg   [47:0]                 stripe;
+  reg   [1:0]                  j;                    // data chunk in the stripe
+  reg   [1:0]                  pr;                   // stripe mod N
+  reg   [15:0]                 off;                  // sector offset in the chunk
+  reg   [31:0]                 left;
+  reg                          full_run;
+  reg   [47:0]                 div_q;
+  reg   [2:0]                  div_rem;
+  reg   [2:0]                  div_den;
+  reg   [5:0]                  div_count;
+  reg   [15:0]                 wr_pending;           // write segments whose commands are not queued yet
+  reg   [15:0]                 seg_pending;          // segments not finished by the data side
+  reg   [15:0]                 cmd_out;
+
+  wire  [2:0]                  div_try;
+  wire  [1:0]                  pd;                   // parity drive
+  wire  [2:0]                  dd_sum;
+  wire  [1:0]                  dd;                   // data drive
+  wire  [N-1:0]                pd_hot;
+  wire  [N-1:0]                dd_hot;
+  wire  [15:0]                 room;
+  wire  [15:0]                 seg;
+  wire  [15:0]                 vroom;
+  wire                         full_start;
+  wire                         is_full;
+  wire  [2:0]                  g_type;
+  wire  [N-1:0]                g_rd_mask;            // drives read for this segment
+  wire  [47:0]                 g_lba;
+  wire  [15:0]                 g_seg;
+  wire                         g_last;
+  wire                         g_rmw;
+  wire                         gen_push;
+
+  // order queue {type, dd, pd, last, rd mask, lba, sectors}
+  wire  [71+N:0]               ord_din;
+  wire  [71+N:0]               ord_dout;
+  wire                         ord_full;
+  wire                         ord_empty;
+  wire                         ord_ren;
+
+  // data side
+  reg                          d_active;
+  reg   [2:0]                  d_type;
+  reg   [1:0]                  d_dd;
+  reg   [1:0]                  d_pd;
+  reg                          d_lastseg;
+  reg   [N-1:0]                d_rx_mask;
+  reg   [47:0]                 d_lba;
+  reg   [15:0]                 d_sectors;
+  reg   [22:0]                 d_left;
+  reg   [22:0]                 d_widx;
+  reg   [31:0]                 rx_xor;
+  reg   [N-1:0]                d_tx_mask;
+  wire  [N-1:0]                d_dd_hot;
+  wire  [N-1:0]                d_pd_hot;
+  wire                         d_last;
+  wire                         d_wr_type;
+  wire                         d_rd_type;
+  wire                         rx_ok;
+  wire                         tx_ok;
+  wire                         d_go;
+  wire                         tx_accept;
+  wire                         rx_accept;
+  wire                         vf_move;
+  wire                         d_move;
+  wire                         d_end;
+  wire  [N-1:0]                ds_cmd_wen;
+
+  // parity stripe buffer, two banks
+  reg   [31:0]                 par0 [0:CHUNK_WORDS-1];
+  reg   [31:0]                 par1 [0:CHUNK_WORDS-1];
+  reg   [31:0]                 par0_q, par1_q;
+  reg                          acc_bank;
+  reg                          acc_we2;
+  reg                          acc_bank2;
+  reg                          acc_first2;
+  reg   [CHUNK_SHIFT+6:0]      acc_addr2;
+  reg   [31:0]                 acc_data2;
+  wire                         acc_rd;
+  wire  [31:0]                 acc_wdata;
+
+  // parity drain
+  reg                          dr_active;
+  reg                          dr_bank;
+  reg   [1:0]                  dr_drive;
+  reg                          dr_skip;
+  reg   [47:0]                 dr_lba;
+  reg   [CHUNK_SHIFT+7:0]      dr_rd_left;
+  reg   [CHUNK_SHIFT+7:0]      dr_wr_left;
+  reg   [CHUNK_SHIFT+6:0]      dr_addr;
+  reg                          dr_valid;
+  wire                         dr_rd;
+  wire                         dr_wen;
+  wire  [31:0]                 dr_data;
+  wire                         dr_last;
+  wire  [N-1:0]                dr_hot;
+  wire  [N-1:0]                dr_cmd_wen;
+  wire                         dr_trigger;
+
+  // drive ports
+  wire  [N-1:0]                q_cmd_wen;
+  wire  [N*65-1:0]             q_cmd_data;
+  wire  [N-1:0]                q_cmd_full;
+  wire  [N-1:0]                q_sts_ren;
+  wire  [N*17-1:0]             q_sts_data;
+  wire  [N-1:0]                q_sts_empty;
+  wire  [N-1:0]                stg_tx_wen;
+  wire  [N*32-1:0]             stg_tx_din;
+  wire  [N-1:0]                stg_tx_full;
+  wire  [N*32-1:0]             stg_rx_data;
+  wire  [N-1:0]                stg_rx_ren;
+  wire  [N-1:0]                stg_rx_empty;
+
+  reg   [2:0]                  cmd_inc;
+  reg   [2:0]                  cmd_dec;
+  integer                      k;
+
+  //******************************** segment generator **********************************
+  assign div_try    = {div_rem[1:0], div_q[47]};
+  assign pd         = N - 1 - pr;
+  assign dd_sum     = pd + 1 + j;
+  assign dd         = (dd_sum >= N) ? dd_sum - N : dd_sum;
+  assign pd_hot     = 1 << pd;
+  assign dd_hot     = 1 << dd;
+  assign room       = (16'd1 << CHUNK_SHIFT) - off;
+  assign seg        = (left < room) ? left[15:0] : room;
+  assign vroom      = (16'd1 << CHUNK_SHIFT) - (vlba[15:0] & ((16'd1 << CHUNK_SHIFT) - 1'b1));
+
+  assign full_start = (op == OP_WRITE) && (j == 2'd0) && (off == 16'd0) && (left >= (D << CHUNK_SHIFT));
+  assign is_full    = full_run || full_start;
+  assign g_rmw      = (op == OP_WRITE) && !is_full && ((fmask & pd_hot) == 0);
+
+  assign g_type     = (op == OP_VERIFY)     ? T_VERIFY :
+                      (op == OP_READ)       ? (((fmask & dd_hot) != 0) ? T_RECON : T_READ) :
+                      is_full               ? T_FULL :
+                      ((fmask & pd_hot) != 0) ? T_WDATA :
+                      ((fmask & dd_hot) != 0) ? T_RCW : T_RMW;
+  assign g_rd_mask  = (g_type == T_READ)   ? dd_hot :
+                      (g_type == T_RECON)  ? (ALL & ~fmask) :
+                      (g_type == T_RMW)    ? (dd_hot | pd_hot) :
+                      (g_type == T_RCW)    ? (ALL & ~fmask & ~pd_hot) :
+                      (g_type == T_VERIFY) ? ALL : {N{1'b0}};
+  assign g_lba      = (op == OP_VERIFY) ? vlba : ((stripe << CHUNK_SHIFT) | off);
+  assign g_seg      = (op == OP_VERIFY) ? ((left < vroom) ? left[15:0] : vroom) : seg;
+  assign g_last     = (j == D - 1);
+
+  // reads are queued here, writes behind their data; RMW / RCW wait for older writes
+  assign gen_push   = (state == G_SEG) && (left != 32'd0) && !ord_full &&
+                      (ds_cmd_wen == 0) && (dr_cmd_wen == 0) && ((q_cmd_full & g_rd_mask) == 0) &&
+                      !((g_type == T_RMW || g_type == T_RCW) && wr_pending != 16'd0);
+
+  assign ord_din    = {g_type, dd, pd, g_last, g_rd_mask, g_lba, g_seg};
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      state           <= G_IDLE;
+      op              <= OP_READ;
+      fmask           <= {N{1'b0}};
+      vlba            <= 48'd0;
+      stripe          <= 48'd0;
+      j               <= 2'd0;
+      pr              <= 2'd0;
+      off             <= 16'd0;
+      left            <= 32'd0;
+      full_run        <= 1'b0;
+      div_q           <= 48'd0;
+      div_rem         <= 3'd0;
+      div_den         <= 3'd0;
+      div_count       <= 6'd0;
+      R5_BUSY         <= 1'b0;
+      R5_DONE         <= 1'b0;
+      R5_FULL_STRIPES <= 32'd0;
+      R5_RMW_SEGS     <= 32'd0;
+    end
+    else begin
+      R5_DONE         <= 1'b0;
+      case(state)
+        G_IDLE: begin
+          if(R5_START) begin
+            op              <= R5_OP;
+            fmask           <= R5_FAIL_EN ? (1 << R5_FAIL_DRIVE) : {N{1'b0}};
+            vlba            <= R5_LBA;
+            off             <= R5_LBA[15:0] & ((16'd1 << CHUNK_SHIFT) - 1'b1);
+            left            <= R5_SECTORS;
+            full_run        <= 1'b0;
+            div_q           <= R5_LBA >> CHUNK_SHIFT;
+            div_rem         <= 3'd0;
+            div_den         <= D;
+            div_count       <= 6'd0;
+            R5_BUSY         <= 1'b1;
+            state           <= (R5_OP == OP_VERIFY) ? G_SEG : G_DIV1;
+          end
+        end
+        G_DIV1, G_DIV2: begin                            // bit serial division, 48 clocks each
+          if(div_count == 6'd48) begin
+            div_count       <= 6'd0;
+            div_rem         <= 3'd0;
+            if(state == G_DIV1) begin
+              stripe          <= div_q;
+              j               <= div_rem[1:0];
+              div_den         <= N;
+              state           <= G_DIV2;
+            end
+            else begin
+              pr              <= div_rem[1:0];
+              state           <= G_SEG;
+            end
+          end
+          else begin
+            div_count       <= div_count + 1'b1;
+            if(div_try >= div_den) begin
+              div_rem         <= div_try - div_den;
+              div_q           <= {div_q[46:0], 1'b1};
+            end
+            else begin
+              div_rem         <= div_try;
+              div_q           <= {div_q[46:0], 1'b0};
+            end
+          end
+        end
+        G_SEG: begin
+          if(left == 32'd0) begin
+            state           <= G_WAIT;
+          end
+          else if(gen_push) begin
+            left            <= left - g_seg;
+            if(op == OP_VERIFY) begin
+              vlba            <= vlba + g_seg;
+            end
+            else begin
+              if(g_type == T_FULL && g_last) begin
+                R5_FULL_STRIPES <= R5_FULL_STRIPES + 1'b1;
+              end
+              if(g_type == T_RMW || g_type == T_RCW) begin
+                R5_RMW_SEGS     <= R5_RMW_SEGS + 1'b1;
+              end
+              full_run        <= is_full && !g_last;
+              if(off + seg == (16'd1 << CHUNK_SHIFT)) begin
+                off             <= 16'd0;
+                if(j == D - 1) begin
+                  j               <= 2'd0;
+                  stripe          <= stripe + 1'b1;
+                  pr              <= (pr == N - 1) ? 2'd0 : pr + 1'b1;
+                end
+                else begin
+                  j               <= j + 1'b1;
+                end
+              end
+              else begin
+                off             <= off + seg;
+              end
+            end
+          end
+        end
+        G_WAIT: begin
+          if(seg_pending == 16'd0 && !dr_active && cmd_out == 16'd0) begin
+            R5_BUSY         <= 1'b0;
+            R5_DONE         <= 1'b1;
+            state           <= G_IDLE;
+          end
+        end
+        default: begin
+          state           <= G_IDLE;
+        end
+      endcase
+    end
+  end
+
+  sata_async_fifo #(
+    .DATA_WIDTH  (72+N),
+    .ADDR_WIDTH  (4)
+    )
+  order_queue (
+    .rst         (RESET),
+    .wr_clk      (CLK),
+    .wr_en       (gen_push),
+    .din         (ord_din),
+    .full        (ord_full),
+    .wr_count    (),
+    .rd_clk      (CLK),
+    .rd_en       (ord_ren),
+    .dout        (ord_dout),
+    .empty       (ord_empty),
+    .rd_count    ()
+    );
+
+  //******************************** data side ******************************************
+  assign ord_ren    = !d_active && !ord_empty;
+  assign d_last     = (d_left == 23'd1);
+  assign d_dd_hot   = 1 << d_dd;
+  assign d_pd_hot   = 1 << d_pd;
+  assign d_wr_type  = (d_type == T_FULL) || (d_type == T_RMW) || (d_type == T_RCW) || (d_type == T_WDATA);
+  assign d_rd_type  = (d_type == T_READ) || (d_type == T_RECON);
+
+  always @(*)
+  begin
+    rx_xor = 32'd0;
+    for(k = 0; k < N; k = k + 1) begin
+      if(d_rx_mask[k]) begin
+        rx_xor = rx_xor ^ stg_rx_data[k*32 +: 32];
+      end
+    end
+    case(d_type)
+      T_FULL, T_WDATA : d_tx_mask = d_dd_hot & ~fmask;
+      T_RMW           : d_tx_mask = d_dd_hot | d_pd_hot;
+      T_RCW           : d_tx_mask = d_pd_hot;
+      default         : d_tx_mask = {N{1'b0}};
+    endcase
+  end
+
+  // the parity drain owns its drive until its command is queued, one drain at a time
+  assign rx_ok      = ((stg_rx_empty & d_rx_mask) == 0);
+  assign tx_ok      = ((stg_tx_full & d_tx_mask) == 0) && !(d_last && ((q_cmd_full & d_tx_mask) != 0));
+  assign d_go       = d_active && !(dr_active && ((d_tx_mask & dr_hot) != 0)) &&
+                      !(d_type == T_FULL && d_lastseg && d_last && dr_active);
+
+  assign USR_TX_HOLD  = !(d_go && d_wr_type && rx_ok && tx_ok);
+  assign tx_accept    = USR_TX_WEN && !USR_TX_HOLD;
+  assign USR_RX_EMPTY = !(d_go && d_rd_type && rx_ok);
+  assign USR_RX_DATA  = rx_xor;
+  assign rx_accept    = USR_RX_REN && !USR_RX_EMPTY;
+  assign vf_move      = d_go && (d_type == T_VERIFY) && rx_ok;
+  assign d_move       = tx_accept || rx_accept || vf_move;
+  assign d_end        = d_move && d_last;
+
+  assign stg_rx_ren   = d_move ? d_rx_mask : {N{1'b0}};
+  assign ds_cmd_wen   = d_end ? d_tx_mask : {N{1'b0}};
+  assign dr_trigger   = d_end && (d_type == T_FULL) && d_lastseg;
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      d_active     <= 1'b0;
+      d_type       <= T_READ;
+      d_dd         <= 2'd0;
+      d_pd         <= 2'd0;
+      d_lastseg    <= 1'b0;
+      d_rx_mask    <= {N{1'b0}};
+      d_lba        <= 48'd0;
+      d_sectors    <= 16'd0;
+      d_left       <= 23'd0;
+      d_widx       <= 23'd0;
+      wr_pending   <= 16'd0;
+      seg_pending  <= 16'd0;
+      R5_MISMATCH  <= 32'd0;
+    end
+    else begin
+      if(ord_ren) begin
+        d_active     <= 1'b1;
+        {d_type, d_dd, d_pd, d_lastseg, d_rx_mask, d_lba, d_sectors} <= ord_dout;
+        d_left       <= {ord_dout[15:0], 7'd0};
+        d_widx       <= 23'd0;
+      end
+      else if(d_move) begin
+        d_left       <= d_left - 1'b1;
+        d_widx       <= d_widx + 1'b1;
+        if(d_last) begin
+          d_active     <= 1'b0;
+        end
+      end
+
+      if(state == G_IDLE && R5_START) begin
+        R5_MISMATCH  <= 32'd0;
+      end
+      else if(vf_move && rx_xor != 32'd0) begin
+        R5_MISMATCH  <= R5_MISMATCH + 1'b1;
+      end
+
+      if(gen_push && g_type != T_READ && g_type != T_RECON && g_type != T_VERIFY) begin
+        if(!(d_end && d_wr_type)) begin
+          wr_pending   <= wr_pending + 1'b1;
+        end
+      end
+      else if(d_end && d_wr_type) begin
+        wr_pending   <= wr_pending - 1'b1;
+      end
+
+      if(gen_push && !d_end) begin
+        seg_pending  <= seg_pending + 1'b1;
+      end
+      else if(!gen_push && d_end) begin
+        seg_pending  <= seg_pending - 1'b1;
+      end
+    end
+  end
+
+  //******************************** parity stripe buffer *******************************
+  assign acc_rd     = d_move && (d_type == T_FULL);
+  assign acc_wdata  = acc_first2 ? acc_data2 : ((acc_bank2 ? par1_q : par0_q) ^ acc_data2);
+
+  always @(posedge CLK)
+  begin
+    if(acc_we2 && !acc_bank2) begin
+      par0[acc_addr2] <= acc_wdata;
+    end
+    if(acc_rd && !acc_bank) begin
+      par0_q          <= par0[d_widx[CHUNK_SHIFT+6:0]];
+    end
+    else if(dr_rd && !dr_bank) begin
+      par0_q          <= par0[dr_addr];
+    end
+  end
+
+  always @(posedge CLK)
+  begin
+    if(acc_we2 && acc_bank2) begin
+      par1[acc_addr2] <= acc_wdata;
+    end
+    if(acc_rd && acc_bank) begin
+      par1_q          <= par1[d_widx[CHUNK_SHIFT+6:0]];
+    end
+    else if(dr_rd && dr_bank) begin
+      par1_q          <= par1[dr_addr];
+    end
+  end
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      acc_bank     <= 1'b0;
+      acc_we2      <= 1'b0;
+      acc_bank2    <= 1'b0;
+      acc_first2   <= 1'b0;
+      acc_addr2    <= 'd0;
+      acc_data2    <= 32'd0;
+    end
+    else begin
+      acc_we2      <= acc_rd;
+      acc_bank2    <= acc_bank;
+      acc_first2   <= (d_dd == ((d_pd == N - 1) ? 2'd0 : d_pd + 1'b1));   // first data chunk of the stripe
+      acc_addr2    <= d_widx[CHUNK_SHIFT+6:0];
+      acc_data2    <= USR_TX_DATA;
+      if(dr_trigger) begin
+        acc_bank     <= !acc_bank;
+      end
+    end
+  end
+
+  //******************************** parity drain ***************************************
+  // the last accumulate write lands one clock after the trigger, the first
+  // drain read is one clock later still
+  assign dr_hot     = dr_active ? (1 << dr_drive) : {N{1'b0}};
+  assign dr_data    = dr_bank ? par1_q : par0_q;
+  assign dr_wen     = dr_valid && (dr_skip || !stg_tx_full[dr_drive]) &&
+                      !(dr_last && !dr_skip && q_cmd_full[dr_drive]);
+  assign dr_rd      = dr_active && (dr_rd_left != 0) && (!dr_valid || dr_wen);
+  assign dr_last    = (dr_wr_left == 1);
+  assign dr_cmd_wen = (dr_wen && dr_last && !dr_skip) ? (1 << dr_drive) : {N{1'b0}};
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      dr_active    <= 1'b0;
+      dr_bank      <= 1'b0;
+      dr_drive     <= 2'd0;
+      dr_skip      <= 1'b0;
+      dr_lba       <= 48'd0;
+      dr_rd_left   <= 'd0;
+      dr_wr_left   <= 'd0;
+      dr_addr      <= 'd0;
+      dr_valid     <= 1'b0;
+    end
+    else if(dr_trigger) begin
+      dr_active    <= 1'b1;
+      dr_bank      <= acc_bank;
+      dr_drive     <= d_pd;
+      dr_skip      <= ((fmask & d_pd_hot) != 0);
+      dr_lba       <= d_lba;
+      dr_rd_left   <= 'd0;                               // reads start next clock
+      dr_wr_left   <= CHUNK_WORDS;
+      dr_addr      <= 'd0;
+      dr_valid     <= 1'b0;
+    end
+    else if(dr_active) begin
+      if(dr_rd_left == 0 && dr_wr_left == CHUNK_WORDS && !dr_valid) begin
+        dr_rd_left   <= CHUNK_WORDS;
+      end
+      if(dr_rd) begin
+        dr_addr      <= dr_addr + 1'b1;
+        dr_rd_left   <= dr_rd_left - 1'b1;
+        dr_valid     <= 1'b1;
+      end
+      else if(dr_wen) begin
+        dr_valid     <= 1'b0;
+      end
+      if(dr_wen) begin
+        dr_wr_left   <= dr_wr_left - 1'b1;
+        if(dr_last) begin
+          dr_active    <= 1'b0;
+        end
+      end
+    end
+  end
+
+  //******************************** ending status **************************************
+  always @(*)
+  begin
+    cmd_inc = 3'd0;
+    cmd_dec = 3'd0;
+    for(k = 0; k < N; k = k + 1) begin
+      cmd_inc = cmd_inc + q_cmd_wen[k];
+      cmd_dec = cmd_dec + q_sts_ren[k];
+    end
+  end
+
+  assign q_sts_ren = ~q_sts_empty;
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      cmd_out      <= 16'd0;
+      R5_ERROR     <= 1'b0;
+      R5_ERR_MASK  <= {N{1'b0}};
+    end
+    else begin
+      cmd_out      <= cmd_out + cmd_inc - cmd_dec;
+      if(state == G_IDLE && R5_START) begin
+        R5_ERROR     <= 1'b0;
+        R5_ERR_MASK  <= {N{1'b0}};
+      end
+      else begin
+        for(k = 0; k < N; k = k + 1) begin
+          if(q_sts_ren[k] && q_sts_data[k*17+16]) begin
+            R5_ERROR       <= 1'b1;
+            R5_ERR_MASK[k] <= 1'b1;
+          end
+        end
+      end
+    end
+  end
+
+  //******************************** drive ports ****************************************
+  genvar n;
+  generate
+    for(n = 0; n < N; n = n + 1) begin : drv
+      assign q_cmd_wen[n]  = ds_cmd_wen[n] || dr_cmd_wen[n] || (gen_push && g_rd_mask[n]);
+      assign q_cmd_data[n*65+64:n*65] = ds_cmd_wen[n] ? {1'b1, d_lba, d_sectors} :
+                                        dr_cmd_wen[n] ? {1'b1, dr_lba, (16'd1 << CHUNK_SHIFT)} :
+                                                        {1'b0, g_lba, g_seg};
+      assign stg_tx_wen[n] = (tx_accept && d_tx_mask[n]) || (dr_wen && !dr_skip && dr_drive == n);
+      assign stg_tx_din[n*32+31:n*32] = (dr_active && dr_drive == n) ? dr_data :
+                                        (d_pd == n && (d_type == T_RMW || d_type == T_RCW)) ? (USR_TX_DATA ^ rx_xor) :
+                                                                                             USR_TX_DATA;
+
+      SATA_DRIVE_PORT #(
+        .STAGE_ADDR_WIDTH  (STAGE_ADDR_WIDTH)
+        )
+      port_i (
+        .CLK               (CLK),
+        .RESET             (RESET),
+        .Q_CMD_WEN         (q_cmd_wen[n]),
+        .Q_CMD_DATA        (q_cmd_data[n*65+64:n*65]),
+        .Q_CMD_FULL        (q_cmd_full[n]),
+        .Q_STS_REN         (q_sts_ren[n]),
+        .Q_STS_DATA        (q_sts_data[n*17+16:n*17]),
+        .Q_STS_EMPTY       (q_sts_empty[n]),
+        .TX_DATA           (stg_tx_din[n*32+31:n*32]),
+        .TX_WEN            (stg_tx_wen[n]),
+        .TX_FULL           (stg_tx_full[n]),
+        .TX_COUNT          (),
+        .RX_DATA           (stg_rx_data[n*32+31:n*32]),
+        .RX_REN            (stg_rx_ren[n]),
+        .RX_EMPTY          (stg_rx_empty[n]),
+        .PORT_CLK          (PORT_CLK[n]),
+        .LINKUP            (LINKUP[n]),
+        .HOST_READ_EN      (HOST_READ_EN[n]),
+        .HOST_WRITE_EN     (HOST_WRITE_EN[n]),
+        .HOST_ADDR_REG     (HOST_ADDR_REG[n*5+4:n*5]),
+        .HOST_DATA_IN      (HOST_DATA_IN[n*32+31:n*32]),
+        .HOST_DATA_OUT     (HOST_DATA_OUT[n*32+31:n*32]),
+        .DMA_TX_DATA_IN    (DMA_TX_DATA_IN[n*32+31:n*32]),
+        .DMA_TX_WEN        (DMA_TX_WEN[n]),
+        .WRITE_HOLD_U      (WRITE_HOLD_U[n]),
+        .DMA_RX_DATA_OUT   (DMA_RX_DATA_OUT[n*32+31:n*32]),
+        .DMA_RX_REN        (DMA_RX_REN[n]),
+        .READ_HOLD_U       (READ_HOLD_U[n]),
+        .TX_FIFO_RESET     (TX_FIFO_RESET[n]),
+        .RX_FIFO_RESET     (RX_FIFO_RESET[n])
+        );
+    end
+  endgenerate
+
+endmodule
@@ -0,0 +1,138 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : Dual clock FIFO
+//  File name   : sata_async_fifo.v
+//  Note        : Inferred block RAM FIFO with gray coded pointers, first
+//                word fall through read side. wr_count / rd_count are the
+//                fill levels seen from each side (pessimistic by the
+//                synchroniser delay).
+//  Design ref. : -
+//  Dependencies   : Nil
+//////////////////////////////////////////////////////////////////////////////
+
+module sata_async_fifo #(
+    parameter DATA_WIDTH = 32,
+    parameter ADDR_WIDTH = 15                           // depth = 2**ADDR_WIDTH
+    )
+    (
+    input                          rst,                 // asynchronous, both sides
+    input                          wr_clk,
+    input                          wr_en,
+    input       [DATA_WIDTH-1:0]   din,
+    output                         full,
+    output reg  [ADDR_WIDTH:0]     wr_count,
+    input                          rd_clk,
+    input                          rd_en,
+    output reg  [DATA_WIDTH-1:0]   dout,
+    output                         empty,
+    output reg  [ADDR_WIDTH:0]     rd_count
+    );
+
+  reg   [DATA_WIDTH-1:0]  mem [0:(1<<ADDR_WIDTH)-1];
+
+  reg   [ADDR_WIDTH:0]    wr_ptr_bin;
+  reg   [ADDR_WIDTH:0]    wr_ptr_gray;
+  reg   [ADDR_WIDTH:0]    rd_ptr_bin;
+  reg   [ADDR_WIDTH:0]    rd_ptr_gray;
+  reg   [ADDR_WIDTH:0]    rd_gray_wr1, rd_gray_wr2;     // read pointer in write clock
+  reg   [ADDR_WIDTH:0]    wr_gray_rd1, wr_gray_rd2;     // write pointer in read clock
+  reg                     dout_valid;
+
+  wire  [ADDR_WIDTH:0]    wr_ptr_bin_next;
+  wire  [ADDR_WIDTH:0]    rd_ptr_bin_next;
+  wire  [ADDR_WIDTH:0]    rd_bin_wr;
+  wire  [ADDR_WIDTH:0]    wr_bin_rd;
+  wire                    mem_empty;
+  wire                    fetch;
+  wire                    dout_valid_next;
+  wire                    wr_ok;
+
+  function [ADDR_WIDTH:0] gray2bin;
+    input [ADDR_WIDTH:0] gray;
+    integer i;
+    begin
+      gray2bin[ADDR_WIDTH] = gray[ADDR_WIDTH];
+      for(i = ADDR_WIDTH-1; i >= 0; i = i - 1)
+        gray2bin[i] = gray2bin[i+1] ^ gray[i];
+    end
+  endfunction
+
+  //********************************* write side *********************************
+  assign rd_bin_wr       = gray2bin(rd_gray_wr2);
+  assign full            = (wr_ptr_gray == {~rd_gray_wr2[ADDR_WIDTH:ADDR_WIDTH-1], rd_gray_wr2[ADDR_WIDTH-2:0]});
+  assign wr_ok           = wr_en && !full;
+  assign wr_ptr_bin_next = wr_ptr_bin + 1'b1;
+
+  always @(posedge wr_clk)
+  begin
+    if(wr_ok) begin
+      mem[wr_ptr_bin[ADDR_WIDTH-1:0]] <= din;
+    end
+  end
+
+  always @(posedge wr_clk, posedge rst)
+  begin
+    if(rst) begin
+      wr_ptr_bin   <= 'd0;
+      wr_ptr_gray  <= 'd0;
+      rd_gray_wr1  <= 'd0;
+      rd_gray_wr2  <= 'd0;
+      wr_count     <= 'd0;
+    end
+    else begin
+      rd_gray_wr1  <= rd_ptr_gray;
+      rd_gray_wr2  <= rd_gray_wr1;
+      if(wr_ok) begin
+        wr_ptr_bin   <= wr_ptr_bin_next;
+        wr_ptr_gray  <= wr_ptr_bin_next ^ (wr_ptr_bin_next >> 1);
+        wr_count     <= wr_ptr_bin_next - rd_bin_wr;
+      end
+      else begin
+        wr_count     <= wr_ptr_bin - rd_bin_wr;
+      end
+    end
+  end
+
+  //********************************* read side **********************************
+  // one word is prefetched into dout, so the block RAM read port is registered
+  assign wr_bin_rd       = gray2bin(wr_gray_rd2);
+  assign mem_empty       = (rd_ptr_gray == wr_gray_rd2);
+  assign fetch           = !mem_empty && (!dout_valid || rd_en);
+  assign empty           = !dout_valid;
+  assign dout_valid_next = fetch || (dout_valid && !rd_en);
+  assign rd_ptr_bin_next = rd_ptr_bin + 1'b1;
+
+  always @(posedge rd_clk)
+  begin
+    if(fetch) begin
+      dout <= mem[rd_ptr_bin[ADDR_WIDTH-1:0]];
+    end
+  end
+
+  always @(posedge rd_clk, posedge rst)
+  begin
+    if(rst) begin
+      rd_ptr_bin   <= 'd0;
+      rd_ptr_gray  <= 'd0;
+      wr_gray_rd1  <= 'd0;
+      wr_gray_rd2  <= 'd0;
+      dout_valid   <= 1'b0;
+      rd_count     <= 'd0;
+    end
+    else begin
+      wr_gray_rd1  <= wr_ptr_gray;
+      wr_gray_rd2  <= wr_gray_rd1;
+      dout_valid   <= dout_valid_next;
+      if(fetch) begin
+        rd_ptr_bin   <= rd_ptr_bin_next;
+        rd_ptr_gray  <= rd_ptr_bin_next ^ (rd_ptr_bin_next >> 1);
+        rd_count     <= wr_bin_rd - rd_ptr_bin_next + dout_valid_next;
+      end
+      else begin
+        rd_count     <= wr_bin_rd - rd_ptr_bin + dout_valid_next;
+      end
+    end
+  end
+
+endmodule
@@ -0,0 +1,198 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : Shadow register command issue
+//  File name   : sata_cmd_issue.v
+//  Note        : Loads the shadow registers of SATA_CONTROLLER for one
+//                48 bit ATA command, writes the command register and polls
+//                the status register until the device clears BSY.
+//                Used by the wrapper level engines (recorder, playback ...)
+//                so none of them needs firmware for per command register
+//                pokes. Runs on the controller clock (CLK_OUT).
+//  Design ref. : SATA3 Specification, ATA8-ACS
+//  Dependencies   : SATA_CONTROLLER
+//////////////////////////////////////////////////////////////////////////////
+
+module SATA_CMD_ISSUE #(
+    parameter        CMD_TIMEOUT = 32'h1000_0000   // command watchdog in CLK cycles, 0 disables
+    )
+    (
+    input                CLK,                      // controller clock (CLK_OUT)
+    input                RESET,
+    input                LINKUP,
+
+    input                CMD_REQ,                  // command request, taken when CMD_READY is high
+    output               CMD_READY,                // link up, device not busy, no command in flight
+    input       [7:0]    CMD_CODE,                 // ATA command code, e.g. 8'h35 WRITE DMA EXT
+    input       [15:0]   CMD_FEATURES,             // {features(exp), features}
+    input       [47:0]   CMD_LBA,                  // 48 bit start LBA
+    input       [15:0]   CMD_SECTORS,              // sector count, 0 means 65536
+    output reg           CMD_DONE,                 // one clock pulse at command completion
+    output reg           CMD_ERROR,                // valid with CMD_DONE : ERR/DF set or watchdog expired
+    output reg  [7:0]    CMD_STATUS,               // ending status register
+    output reg  [7:0]    CMD_ERR_REG,              // ending error register
+
+    output reg           HOST_READ_EN,             // to SATA_CONTROLLER shadow register port
+    output reg           HOST_WRITE_EN,
+    output reg  [4:0]    HOST_ADDR_REG,
+    output reg  [31:0]   HOST_DATA_IN,
+    input       [31:0]   HOST_DATA_OUT
+    );
+
+  // shadow register addresses, same as sata_transport
+  parameter cmd_reg               =  5'd1        ;
+  parameter feature_reg           =  5'd3        ;
+  parameter stuts_reg             =  5'd4        ;
+  parameter head_reg              =  5'd5        ;
+  parameter error_reg             =  5'd6        ;
+  parameter lba_low               =  5'd7        ;
+  parameter lba_mid               =  5'd8        ;
+  parameter lba_high              =  5'd9        ;
+  parameter sect_count            =  5'd10       ;
+
+  parameter IDLE                  =  4'h0        ;
+  parameter WR_FEATURE            =  4'h1        ;
+  parameter WR_HEAD               =  4'h2        ;
+  parameter WR_LBA_LOW            =  4'h3        ;
+  parameter WR_LBA_MID            =  4'h4        ;
+  parameter WR_LBA_HIGH           =  4'h5        ;
+  parameter WR_COUNT              =  4'h6        ;
+  parameter WR_CMD                =  4'h7        ;
+  parameter WAIT_BSY              =  4'h8        ;
+  parameter POLL_STATUS           =  4'h9        ;
+  parameter RD_ERROR              =  4'hA        ;
+  parameter CMD_END               =  4'hB        ;
+
+  reg   [3:0]    state;
+  reg   [7:0]    cmd_code_reg;
+  reg   [15:0]   features_reg;
+  reg   [47:0]   lba_reg;
+  reg   [15:0]   sectors_reg;
+  reg   [7:0]    dev_status;
+  reg   [31:0]   timeout_count;
+  reg            timed_out;
+
+  // status is sampled every idle cycle, so BSY/DRQ are at most one clock old
+  assign CMD_READY = (state == IDLE) && LINKUP && !dev_status[7] && !dev_status[3];
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      state          <= IDLE;
+      cmd_code_reg   <= 8'd0;
+      features_reg   <= 16'd0;
+      lba_reg        <= 48'd0;
+      sectors_reg    <= 16'd0;
+      dev_status     <= 8'h80;
+      timeout_count  <= 32'd0;
+      timed_out      <= 1'b0;
+      HOST_READ_EN   <= 1'b0;
+      HOST_WRITE_EN  <= 1'b0;
+      HOST_ADDR_REG  <= 5'd0;
+      HOST_DATA_IN   <= 32'd0;
+      CMD_DONE       <= 1'b0;
+      CMD_ERROR      <= 1'b0;
+      CMD_STATUS     <= 8'd0;
+      CMD_ERR_REG    <= 8'd0;
+    end
+    else begin
+      CMD_DONE       <= 1'b0;
+      HOST_WRITE_EN  <= 1'b0;
+      case(state)
+        IDLE: begin
+          HOST_READ_EN   <= 1'b1;
+          HOST_ADDR_REG  <= stuts_reg;
+          if(HOST_READ_EN && HOST_ADDR_REG == stuts_reg) begin
+            dev_status   <= HOST_DATA_OUT[7:0];
+          end
+          if(CMD_REQ && CMD_READY) begin
+            cmd_code_reg   <= CMD_CODE;
+            features_reg   <= CMD_FEATURES;
+            lba_reg        <= CMD_LBA;
+            sectors_reg    <= CMD_SECTORS;
+            HOST_READ_EN   <= 1'b0;
+            state          <= WR_FEATURE;
+          end
+        end
+        WR_FEATURE: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= feature_reg;
+          HOST_DATA_IN   <= {16'd0, features_reg};
+          state          <= WR_HEAD;
+        end
+        WR_HEAD: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= head_reg;
+          HOST_DATA_IN   <= 32'h40;                                  // LBA mode
+          state          <= WR_LBA_LOW;
+        end
+        WR_LBA_LOW: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= lba_low;
+          HOST_DATA_IN   <= {16'd0, lba_reg[31:24], lba_reg[7:0]};
+          state          <= WR_LBA_MID;
+        end
+        WR_LBA_MID: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= lba_mid;
+          HOST_DATA_IN   <= {16'd0, lba_reg[39:32], lba_reg[15:8]};
+          state          <= WR_LBA_HIGH;
+        end
+        WR_LBA_HIGH: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= lba_high;
+          HOST_DATA_IN   <= {16'd0, lba_reg[47:40], lba_reg[23:16]};
+          state          <= WR_COUNT;
+        end
+        WR_COUNT: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= sect_count;
+          HOST_DATA_IN   <= {16'd0, sectors_reg};
+          state          <= WR_CMD;
+        end
+        WR_CMD: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= cmd_reg;
+          HOST_DATA_IN   <= {24'd0, cmd_code_reg};
+          timeout_count  <= 32'd0;
+          timed_out      <= 1'b0;
+          state          <= WAIT_BSY;
+        end
+        WAIT_BSY: begin                                              // command write sets BSY in the next clock
+          HOST_READ_EN   <= 1'b1;
+          HOST_ADDR_REG  <= stuts_reg;
+          state          <= POLL_STATUS;
+        end
+        POLL_STATUS: begin
+          timeout_count  <= timeout_count + 1'b1;
+          if(!LINKUP || (CMD_TIMEOUT != 0 && timeout_count == CMD_TIMEOUT)) begin
+            timed_out    <= 1'b1;
+            CMD_STATUS   <= HOST_DATA_OUT[7:0];
+            HOST_ADDR_REG<= error_reg;
+            state        <= RD_ERROR;
+          end
+          else if(!HOST_DATA_OUT[7]) begin
+            CMD_STATUS   <= HOST_DATA_OUT[7:0];
+            HOST_ADDR_REG<= error_reg;
+            state        <= RD_ERROR;
+          end
+        end
+        RD_ERROR: begin
+          CMD_ERR_REG    <= HOST_DATA_OUT[7:0];
+          HOST_ADDR_REG  <= stuts_reg;
+          state          <= CMD_END;
+        end
+        CMD_END: begin
+          CMD_DONE       <= 1'b1;
+          CMD_ERROR      <= timed_out || CMD_STATUS[0] || CMD_STATUS[5];
+          dev_status     <= CMD_STATUS;
+          state          <= IDLE;
+        end
+        default: begin
+          state          <= IDLE;
+        end
+      endcase
+    end
+  end
+
+endmodule
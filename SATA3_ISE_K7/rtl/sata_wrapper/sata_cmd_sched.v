@@ -0,0 +1,295 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : Read / write QoS command scheduler
+//  File name   : sata_cmd_sched.v
+//  Note        : Sits between the wrapper engines and SATA_CMD_ISSUE. Read
+//                and write class requests go to separate queues, each port
+//                looks like SATA_CMD_ISSUE to its engine (REQ/READY, DONE
+//                routed back with the request tag).
+//                Selection when both queues hold a command :
+//                  1. the other class has been passed over QOS_MAX_STARVE
+//                     times in a row         -> other class
+//                  2. priority class has credit -> priority class
+//                  3. other class has credit    -> other class
+//                  4. new round, both classes get their share back
+//                Credit is a per round sector budget (QOS_RD_SHARE /
+//                QOS_WR_SHARE), charged with the sector count of every
+//                issued command (deficit round robin). With one queue
+//                empty the other one is served right away and not
+//                charged, so a long single class run leaves no deficit
+//                behind; a charged credit never goes below -share, so
+//                after contention starts a class waits at most two
+//                rounds even with QOS_MAX_STARVE = 0.
+//                Commands are not preempted (no NCQ), so the read latency
+//                bound is one write command; keep MAX_CMD_SECTORS of the
+//                write engines small where read latency matters.
+//                QOS_RD_MAX_WAIT / QOS_WR_MAX_WAIT keep the longest queue
+//                wait (clocks) seen by each class.
+//  Design ref. : -
+//  Dependencies   : SATA_CMD_ISSUE
+//////////////////////////////////////////////////////////////////////////////
+
+module SATA_CMD_SCHED #(
+    parameter  QUEUE_ADDR_WIDTH = 2                  // 2**QUEUE_ADDR_WIDTH commands per class queue
+    )
+    (
+    input                CLK,                        // controller clock
+    input                RESET,
+
+    // policy
+    input                QOS_READ_PRIO,              // 1 : reads are the priority class, 0 : writes
+    input       [7:0]    QOS_MAX_STARVE,             // commands the other class may be passed over, 0 disables
+    input       [15:0]   QOS_RD_SHARE,               // read sectors per round, 0 is taken as 1
+    input       [15:0]   QOS_WR_SHARE,               // write sectors per round, 0 is taken as 1
+    input                QOS_CLEAR_STATS,
+    output reg  [31:0]   QOS_RD_MAX_WAIT,
+    output reg  [31:0]   QOS_WR_MAX_WAIT,
+
+    // read class port
+    input                RD_CMD_REQ,
+    output               RD_CMD_READY,
+    input       [7:0]    RD_CMD_CODE,
+    input       [15:0]   RD_CMD_FEATURES,
+    input       [47:0]   RD_CMD_LBA,
+    input       [15:0]   RD_CMD_SECTORS,
+    input       [3:0]    RD_CMD_TAG,
+    output reg           RD_CMD_DONE,
+    output reg  [3:0]    RD_CMD_DONE_TAG,
+
+    // write class port
+    input                WR_CMD_REQ,
+    output               WR_CMD_READY,
+    input       [7:0]    WR_CMD_CODE,
+    input       [15:0]   WR_CMD_FEATURES,
+    input       [47:0]   WR_CMD_LBA,
+    input       [15:0]   WR_CMD_SECTORS,
+    input       [3:0]    WR_CMD_TAG,
+    output reg           WR_CMD_DONE,
+    output reg  [3:0]    WR_CMD_DONE_TAG,
+
+    // completion details, valid with RD_CMD_DONE / WR_CMD_DONE
+    output reg           CMD_ERROR_OUT,
+    output reg  [7:0]    CMD_STATUS_OUT,
+    output reg  [7:0]    CMD_ERR_REG_OUT,
+
+    // to SATA_CMD_ISSUE
+    output reg           CMD_REQ,
+    input                CMD_READY,
+    output reg  [7:0]    CMD_CODE,
+    output reg  [15:0]   CMD_FEATURES,
+    output reg  [47:0]   CMD_LBA,
+    output reg  [15:0]   CMD_SECTORS,
+    input                CMD_DONE,
+    input                CMD_ERROR,
+    input       [7:0]    CMD_STATUS,
+    input       [7:0]    CMD_ERR_REG
+    );
+
+  parameter  S_IDLE        = 2'h0;
+  parameter  S_ISSUE       = 2'h1;
+  parameter  S_CMD_WAIT    = 2'h2;
+
+  localparam QDEPTH        = (1 << QUEUE_ADDR_WIDTH);
+
+  // queue entry : {tag, code, features, lba, sectors}
+  reg   [91:0]                 rd_queue [0:QDEPTH-1];
+  reg   [91:0]                 wr_queue [0:QDEPTH-1];
+  reg   [QUEUE_ADDR_WIDTH:0]   rd_wr_ptr, rd_rd_ptr;
+  reg   [QUEUE_ADDR_WIDTH:0]   wr_wr_ptr, wr_rd_ptr;
+  wire                         rd_empty, wr_empty;
+  wire                         rd_push, wr_push;
+  wire  [91:0]                 rd_head, wr_head;
+
+  reg   [1:0]                  state;
+  reg                          cur_class;            // 1 : read, 0 : write
+  reg   [3:0]                  cur_tag;
+  reg   signed [17:0]          rd_credit;
+  reg   signed [17:0]          wr_credit;
+  reg   [7:0]                  rd_starve;            // times read class was passed over
+  reg   [7:0]                  wr_starve;
+  reg   [31:0]                 rd_wait;              // clocks the read head has waited
+  reg   [31:0]                 wr_wait;
+
+  wire                         prio_rd_empty;
+  wire                         pick_read;
+  wire                         rd_starving;
+  wire                         wr_starving;
+  wire                         rd_has_credit;
+  wire                         wr_has_credit;
+  wire                         new_round;
+  wire  signed [17:0]          rd_share;
+  wire  signed [17:0]          wr_share;
+  wire  signed [17:0]          rd_charged;           // credit after the read head, floored at -share
+  wire  signed [17:0]          wr_charged;
+
+  //******************************** queues *********************************************
+  assign rd_empty      = (rd_wr_ptr == rd_rd_ptr);
+  assign wr_empty      = (wr_wr_ptr == wr_rd_ptr);
+  assign RD_CMD_READY  = !((rd_wr_ptr[QUEUE_ADDR_WIDTH] != rd_rd_ptr[QUEUE_ADDR_WIDTH]) &&
+                           (rd_wr_ptr[QUEUE_ADDR_WIDTH-1:0] == rd_rd_ptr[QUEUE_ADDR_WIDTH-1:0]));
+  assign WR_CMD_READY  = !((wr_wr_ptr[QUEUE_ADDR_WIDTH] != wr_rd_ptr[QUEUE_ADDR_WIDTH]) &&
+                           (wr_wr_ptr[QUEUE_ADDR_WIDTH-1:0] == wr_rd_ptr[QUEUE_ADDR_WIDTH-1:0]));
+  assign rd_push       = RD_CMD_REQ && RD_CMD_READY;
+  assign wr_push       = WR_CMD_REQ && WR_CMD_READY;
+  assign rd_head       = rd_queue[rd_rd_ptr[QUEUE_ADDR_WIDTH-1:0]];
+  assign wr_head       = wr_queue[wr_rd_ptr[QUEUE_ADDR_WIDTH-1:0]];
+
+  always @(posedge CLK)
+  begin
+    if(rd_push) begin
+      rd_queue[rd_wr_ptr[QUEUE_ADDR_WIDTH-1:0]] <= {RD_CMD_TAG, RD_CMD_CODE, RD_CMD_FEATURES, RD_CMD_LBA, RD_CMD_SECTORS};
+    end
+    if(wr_push) begin
+      wr_queue[wr_wr_ptr[QUEUE_ADDR_WIDTH-1:0]] <= {WR_CMD_TAG, WR_CMD_CODE, WR_CMD_FEATURES, WR_CMD_LBA, WR_CMD_SECTORS};
+    end
+  end
+
+  //******************************** selection ******************************************
+  assign rd_starving   = (QOS_MAX_STARVE != 8'd0) && (rd_starve >= QOS_MAX_STARVE);
+  assign wr_starving   = (QOS_MAX_STARVE != 8'd0) && (wr_starve >= QOS_MAX_STARVE);
+  assign rd_has_credit = (rd_credit > 0);
+  assign wr_has_credit = (wr_credit > 0);
+
+  // both queues hold a command
+  assign pick_read     = rd_empty    ? 1'b0 :
+                         wr_empty    ? 1'b1 :
+                         QOS_READ_PRIO ? (wr_starving ? 1'b0 : rd_has_credit ? 1'b1 : wr_has_credit ? 1'b0 : 1'b1) :
+                                         (rd_starving ? 1'b1 : wr_has_credit ? 1'b0 : rd_has_credit ? 1'b1 : 1'b0);
+  assign new_round     = !rd_empty && !wr_empty && !rd_starving && !wr_starving && !rd_has_credit && !wr_has_credit;
+
+  assign rd_share      = (QOS_RD_SHARE == 16'd0) ? 18'sd1 : $signed({2'b00, QOS_RD_SHARE});
+  assign wr_share      = (QOS_WR_SHARE == 16'd0) ? 18'sd1 : $signed({2'b00, QOS_WR_SHARE});
+  assign rd_charged    = (rd_credit - $signed({2'b00, rd_head[15:0]}) < -rd_share) ?
+                         -rd_share : rd_credit - $signed({2'b00, rd_head[15:0]});
+  assign wr_charged    = (wr_credit - $signed({2'b00, wr_head[15:0]}) < -wr_share) ?
+                         -wr_share : wr_credit - $signed({2'b00, wr_head[15:0]});
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      state            <= S_IDLE;
+      rd_wr_ptr        <= 'd0;
+      rd_rd_ptr        <= 'd0;
+      wr_wr_ptr        <= 'd0;
+      wr_rd_ptr        <= 'd0;
+      cur_class        <= 1'b0;
+      cur_tag          <= 4'd0;
+      rd_credit        <= 18'sd0;
+      wr_credit        <= 18'sd0;
+      rd_starve        <= 8'd0;
+      wr_starve        <= 8'd0;
+      CMD_REQ          <= 1'b0;
+      CMD_CODE         <= 8'd0;
+      CMD_FEATURES     <= 16'd0;
+      CMD_LBA          <= 48'd0;
+      CMD_SECTORS      <= 16'd0;
+      RD_CMD_DONE      <= 1'b0;
+      RD_CMD_DONE_TAG  <= 4'd0;
+      WR_CMD_DONE      <= 1'b0;
+      WR_CMD_DONE_TAG  <= 4'd0;
+      CMD_ERROR_OUT    <= 1'b0;
+      CMD_STATUS_OUT   <= 8'd0;
+      CMD_ERR_REG_OUT  <= 8'd0;
+    end
+    else begin
+      RD_CMD_DONE      <= 1'b0;
+      WR_CMD_DONE      <= 1'b0;
+      if(rd_push) begin
+        rd_wr_ptr        <= rd_wr_ptr + 1'b1;
+      end
+      if(wr_push) begin
+        wr_wr_ptr        <= wr_wr_ptr + 1'b1;
+      end
+
+      case(state)
+        S_IDLE: begin
+          if(!rd_empty || !wr_empty) begin
+            if(new_round) begin
+              rd_credit        <= (rd_credit + rd_share > rd_share) ? rd_share : rd_credit + rd_share;
+              wr_credit        <= (wr_credit + wr_share > wr_share) ? wr_share : wr_credit + wr_share;
+            end
+            else if(pick_read) begin
+              {cur_tag, CMD_CODE, CMD_FEATURES, CMD_LBA, CMD_SECTORS} <= rd_head;
+              cur_class        <= 1'b1;
+              rd_rd_ptr        <= rd_rd_ptr + 1'b1;
+              if(!wr_empty) begin                        // charged only under contention
+                rd_credit        <= rd_charged;
+              end
+              rd_starve        <= 8'd0;
+              wr_starve        <= wr_empty ? 8'd0 : wr_starve + 1'b1;
+              state            <= S_ISSUE;
+            end
+            else begin
+              {cur_tag, CMD_CODE, CMD_FEATURES, CMD_LBA, CMD_SECTORS} <= wr_head;
+              cur_class        <= 1'b0;
+              wr_rd_ptr        <= wr_rd_ptr + 1'b1;
+              if(!rd_empty) begin
+                wr_credit        <= wr_charged;
+              end
+              wr_starve        <= 8'd0;
+              rd_starve        <= rd_empty ? 8'd0 : rd_starve + 1'b1;
+              state            <= S_ISSUE;
+            end
+          end
+        end
+        S_ISSUE: begin
+          CMD_REQ          <= 1'b1;
+          if(CMD_REQ && CMD_READY) begin
+            CMD_REQ          <= 1'b0;
+            state            <= S_CMD_WAIT;
+          end
+        end
+        S_CMD_WAIT: begin
+          if(CMD_DONE) begin
+            CMD_ERROR_OUT    <= CMD_ERROR;
+            CMD_STATUS_OUT   <= CMD_STATUS;
+            CMD_ERR_REG_OUT  <= CMD_ERR_REG;
+            RD_CMD_DONE      <= cur_class;
+            RD_CMD_DONE_TAG  <= cur_tag;
+            WR_CMD_DONE      <= !cur_class;
+            WR_CMD_DONE_TAG  <= cur_tag;
+            state            <= S_IDLE;
+          end
+        end
+        default: begin
+          state            <= S_IDLE;
+        end
+      endcase
+    end
+  end
+
+  //******************************** queue wait statistics ******************************
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      rd_wait          <= 32'd0;
+      wr_wait          <= 32'd0;
+      QOS_RD_MAX_WAIT  <= 32'd0;
+      QOS_WR_MAX_WAIT  <= 32'd0;
+    end
+    else begin
+      if(rd_empty || (state == S_IDLE && pick_read && !new_round)) begin
+        rd_wait          <= 32'd0;
+      end
+      else begin
+        rd_wait          <= rd_wait + 1'b1;
+      end
+      if(wr_empty || (state == S_IDLE && !pick_read && !new_round)) begin
+        wr_wait          <= 32'd0;
+      end
+      else begin
+        wr_wait          <= wr_wait + 1'b1;
+      end
+      if(QOS_CLEAR_STATS) begin
+        QOS_RD_MAX_WAIT  <= 32'd0;
+        QOS_WR_MAX_WAIT  <= 32'd0;
+      end
+      else begin
+        if(rd_wait > QOS_RD_MAX_WAIT) QOS_RD_MAX_WAIT <= rd_wait;
+        if(wr_wait > QOS_WR_MAX_WAIT) QOS_WR_MAX_WAIT <= wr_wait;
+      end
+    end
+  end
+
+endmodule
@@ -0,0 +1,296 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : Queued drive port
+//  File name   : sata_drive_port.v
+//  Note        : Connects one port of SATA_CONTROLLER(_MP) to an engine
+//                running on its own clock (CLK). Commands and ending status
+//                go through small dual clock queues, data through a staging
+//                FIFO in each direction, so the engine never sees the port
+//                clock, which follows the negotiated GEN.
+//                Command word : {write, LBA[47:0], sectors[15:0]}, sectors
+//                must not be 0. Status word : {error, error register,
+//                status register}, one per command, in order.
+//                A write command must only be queued after all of its data
+//                has been written into the TX staging FIFO; the TX FIFO of
+//                the controller is then filled with exactly that command's
+//                data (a DMA data FIS ends when the TX FIFO runs empty).
+//                If a command fails the rest of its write data is dropped
+//                from the staging FIFO and the rest of its read data is
+//                replaced by zeros, so the data streams of the following
+//                commands stay aligned; the controller FIFOs are reset.
+//                PORT_CLK is CLK_OUT of the port, DMA_CLK_IN of the port
+//                must be driven with the same clock and DMA_RQST held at 1.
+//  Design ref. : -
+//  Dependencies   : SATA_CMD_ISSUE, sata_async_fifo
+//////////////////////////////////////////////////////////////////////////////
+
+module SATA_DRIVE_PORT #(
+    parameter  STAGE_ADDR_WIDTH = 14,                  // staging FIFO depth, 2**STAGE_ADDR_WIDTH words
+    parameter  QUEUE_ADDR_WIDTH = 4                    // command / status queue depth
+    )
+    (
+    input                          CLK,                // engine clock
+    input                          RESET,              // asynchronous, both sides
+
+    // engine side, CLK domain
+    input                          Q_CMD_WEN,
+    input       [64:0]             Q_CMD_DATA,         // {write, lba, sectors}
+    output                         Q_CMD_FULL,
+    input                          Q_STS_REN,
+    output      [16:0]             Q_STS_DATA,         // {error, err_reg, status}
+    output                         Q_STS_EMPTY,
+    input       [31:0]             TX_DATA,
+    input                          TX_WEN,
+    output                         TX_FULL,
+    output      [STAGE_ADDR_WIDTH:0] TX_COUNT,         // words in the TX staging FIFO
+    output      [31:0]             RX_DATA,
+    input                          RX_REN,
+    output                         RX_EMPTY,
+
+    // SATA_CONTROLLER port side, PORT_CLK domain
+    input                          PORT_CLK,           // CLK_OUT of the port
+    input                          LINKUP,
+    output                         HOST_READ_EN,
+    output                         HOST_WRITE_EN,
+    output      [4:0]              HOST_ADDR_REG,
+    output      [31:0]             HOST_DATA_IN,
+    input       [31:0]             HOST_DATA_OUT,
+    output      [31:0]             DMA_TX_DATA_IN,
+    output                         DMA_TX_WEN,
+    input                          WRITE_HOLD_U,
+    input       [31:0]             DMA_RX_DATA_OUT,
+    output                         DMA_RX_REN,
+    input                          READ_HOLD_U,
+    output                         TX_FIFO_RESET,
+    output                         RX_FIFO_RESET
+    );
+
+  parameter  P_IDLE        = 3'h0;
+  parameter  P_ISSUE       = 3'h1;
+  parameter  P_CMD_WAIT    = 3'h2;
+  parameter  P_DRAIN       = 3'h3;
+  parameter  P_STATUS      = 3'h4;
+
+  parameter  READ_DMA_EXT  = 8'h25;
+  parameter  WRITE_DMA_EXT = 8'h35;
+
+  reg   [2:0]                  state;
+  reg                          cmd_write;
+  reg                          cmd_req;
+  reg   [47:0]                 cmd_lba;
+  reg   [15:0]                 cmd_sectors;
+  reg   [22:0]                 tx_left;              // words still to move from TX staging
+  reg   [22:0]                 rx_left;              // words still to put into RX staging
+  reg                          tx_drop;
+  reg                          rx_pad;
+  reg                          sts_wen;
+  reg   [16:0]                 sts_din;
+  reg   [2:0]                  fifo_rst_count;
+
+  wire                         q_cmd_empty;
+  wire  [64:0]                 q_cmd_dout;
+  wire                         q_cmd_ren;
+  wire                         q_sts_full;
+  wire                         cmd_ready;
+  wire                         cmd_done;
+  wire                         cmd_error;
+  wire  [7:0]                  cmd_status;
+  wire  [7:0]                  cmd_err_reg;
+
+  wire  [31:0]                 stg_tx_dout;
+  wire                         stg_tx_empty;
+  wire                         stg_tx_ren;
+  wire                         stg_rx_full;
+  wire                         stg_rx_wen;
+  wire                         rx_take;
+
+  //******************************** queues *********************************************
+  sata_async_fifo #(
+    .DATA_WIDTH  (65),
+    .ADDR_WIDTH  (QUEUE_ADDR_WIDTH)
+    )
+  cmd_queue (
+    .rst         (RESET),
+    .wr_clk      (CLK),
+    .wr_en       (Q_CMD_WEN),
+    .din         (Q_CMD_DATA),
+    .full        (Q_CMD_FULL),
+    .wr_count    (),
+    .rd_clk      (PORT_CLK),
+    .rd_en       (q_cmd_ren),
+    .dout        (q_cmd_dout),
+    .empty       (q_cmd_empty),
+    .rd_count    ()
+    );
+
+  sata_async_fifo #(
+    .DATA_WIDTH  (17),
+    .ADDR_WIDTH  (QUEUE_ADDR_WIDTH)
+    )
+  sts_queue (
+    .rst         (RESET),
+    .wr_clk      (PORT_CLK),
+    .wr_en       (sts_wen),
+    .din         (sts_din),
+    .full        (q_sts_full),
+    .wr_count    (),
+    .rd_clk      (CLK),
+    .rd_en       (Q_STS_REN),
+    .dout        (Q_STS_DATA),
+    .empty       (Q_STS_EMPTY),
+    .rd_count    ()
+    );
+
+  sata_async_fifo #(
+    .DATA_WIDTH  (32),
+    .ADDR_WIDTH  (STAGE_ADDR_WIDTH)
+    )
+  tx_stage (
+    .rst         (RESET),
+    .wr_clk      (CLK),
+    .wr_en       (TX_WEN),
+    .din         (TX_DATA),
+    .full        (TX_FULL),
+    .wr_count    (TX_COUNT),
+    .rd_clk      (PORT_CLK),
+    .rd_en       (stg_tx_ren),
+    .dout        (stg_tx_dout),
+    .empty       (stg_tx_empty),
+    .rd_count    ()
+    );
+
+  sata_async_fifo #(
+    .DATA_WIDTH  (32),
+    .ADDR_WIDTH  (STAGE_ADDR_WIDTH)
+    )
+  rx_stage (
+    .rst         (RESET),
+    .wr_clk      (PORT_CLK),
+    .wr_en       (stg_rx_wen),
+    .din         (rx_pad ? 32'd0 : DMA_RX_DATA_OUT),
+    .full        (stg_rx_full),
+    .wr_count    (),
+    .rd_clk      (CLK),
+    .rd_en       (RX_REN),
+    .dout        (RX_DATA),
+    .empty       (RX_EMPTY),
+    .rd_count    ()
+    );
+
+  //******************************** command execution, port clock *********************
+  SATA_CMD_ISSUE cmd_issue_i (
+    .CLK             (PORT_CLK),
+    .RESET           (RESET),
+    .LINKUP          (LINKUP),
+    .CMD_REQ         (cmd_req),
+    .CMD_READY       (cmd_ready),
+    .CMD_CODE        (cmd_write ? WRITE_DMA_EXT : READ_DMA_EXT),
+    .CMD_FEATURES    (16'd0),
+    .CMD_LBA         (cmd_lba),
+    .CMD_SECTORS     (cmd_sectors),
+    .CMD_DONE        (cmd_done),
+    .CMD_ERROR       (cmd_error),
+    .CMD_STATUS      (cmd_status),
+    .CMD_ERR_REG     (cmd_err_reg),
+    .HOST_READ_EN    (HOST_READ_EN),
+    .HOST_WRITE_EN   (HOST_WRITE_EN),
+    .HOST_ADDR_REG   (HOST_ADDR_REG),
+    .HOST_DATA_IN    (HOST_DATA_IN),
+    .HOST_DATA_OUT   (HOST_DATA_OUT)
+    );
+
+  // one command in flight, its status always fits in the status queue
+  assign q_cmd_ren      = (state == P_IDLE) && !q_cmd_empty && !q_sts_full;
+
+  assign TX_FIFO_RESET  = (fifo_rst_count != 3'd0) && cmd_write;
+  assign RX_FIFO_RESET  = (fifo_rst_count != 3'd0) && !cmd_write;
+
+  always @(posedge PORT_CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      state           <= P_IDLE;
+      cmd_write       <= 1'b0;
+      cmd_req         <= 1'b0;
+      cmd_lba         <= 48'd0;
+      cmd_sectors     <= 16'd0;
+      tx_left         <= 23'd0;
+      rx_left         <= 23'd0;
+      tx_drop         <= 1'b0;
+      rx_pad          <= 1'b0;
+      sts_wen         <= 1'b0;
+      sts_din         <= 17'd0;
+      fifo_rst_count  <= 3'd0;
+    end
+    else begin
+      sts_wen         <= 1'b0;
+      if(fifo_rst_count != 3'd0) begin
+        fifo_rst_count  <= fifo_rst_count - 1'b1;
+      end
+      if(stg_tx_ren) begin
+        tx_left         <= tx_left - 1'b1;
+      end
+      if(stg_rx_wen) begin
+        rx_left         <= rx_left - 1'b1;
+      end
+
+      case(state)
+        P_IDLE: begin
+          tx_drop         <= 1'b0;
+          rx_pad          <= 1'b0;
+          if(q_cmd_ren) begin
+            {cmd_write, cmd_lba, cmd_sectors} <= q_cmd_dout;
+            // TX FIFO is filled from here on, before the command is written
+            if(q_cmd_dout[64]) begin
+              tx_left         <= {q_cmd_dout[15:0], 7'd0};
+            end
+            else begin
+              rx_left         <= {q_cmd_dout[15:0], 7'd0};
+            end
+            state           <= P_ISSUE;
+          end
+        end
+        P_ISSUE: begin
+          cmd_req         <= 1'b1;
+          if(cmd_req && cmd_ready) begin
+            cmd_req         <= 1'b0;
+            state           <= P_CMD_WAIT;
+          end
+        end
+        P_CMD_WAIT: begin
+          if(cmd_done) begin
+            sts_din         <= {cmd_error, cmd_err_reg, cmd_status};
+            if(cmd_error) begin
+              tx_drop         <= 1'b1;
+              rx_pad          <= 1'b1;
+              fifo_rst_count  <= 3'd7;
+            end
+            state           <= P_DRAIN;
+          end
+        end
+        P_DRAIN: begin                                   // read data still in the controller FIFO
+          if((cmd_write ? tx_left : rx_left) == 23'd0 && fifo_rst_count == 3'd0) begin
+            state           <= P_STATUS;
+          end
+        end
+        P_STATUS: begin
+          sts_wen         <= 1'b1;
+          state           <= P_IDLE;
+        end
+        default: begin
+          state           <= P_IDLE;
+        end
+      endcase
+    end
+  end
+
+  //******************************** data pumps *****************************************
+  assign stg_tx_ren     = (tx_left != 23'd0) && !stg_tx_empty && (tx_drop || !WRITE_HOLD_U);
+  assign DMA_TX_WEN     = stg_tx_ren && !tx_drop;
+  assign DMA_TX_DATA_IN = stg_tx_dout;
+
+  assign rx_take        = (rx_left != 23'd0) && !rx_pad && !READ_HOLD_U && !stg_rx_full;
+  assign DMA_RX_REN     = rx_take;
+  assign stg_rx_wen     = rx_take || ((rx_left != 23'd0) && rx_pad && !stg_rx_full);
+
+endmodule
@@ -0,0 +1,293 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : C-SCAN / deadline command scheduler
+//  File name   : sata_elevator.v
+//  Note        : Optional reordering stage in front of SATA_CMD_ISSUE for
+//                rotating disks. Pending (non NCQ) commands are kept in a
+//                small table; the next command is the one with the lowest
+//                LBA at or above the end of the last dispatched command
+//                (C-SCAN, one direction, wrap to the lowest LBA). A
+//                command that has waited ELV_DEADLINE clocks or more goes
+//                first, oldest first. With ELV_ENABLE low commands go out
+//                in arrival order.
+//                The table is scanned one entry per clock before each
+//                dispatch, which is nothing next to a seek.
+//                ELV_DISPATCH / ELV_DISPATCH_TAG tell the requester which
+//                command went to the drive, a write requester must feed
+//                the TX FIFO in that order.
+//                Seek distance |LBA - end of previous command| is summed in
+//                arrival order (ELV_ARR_*) and in dispatch order (ELV_DSP_*);
+//                average distance = DIST_SUM / COUNT, before and after
+//                reordering.
+//  Design ref. : -
+//  Dependencies   : SATA_CMD_ISSUE
+//////////////////////////////////////////////////////////////////////////////
+
+module SATA_ELEVATOR #(
+    parameter  SLOT_ADDR_WIDTH = 3                   // 2**SLOT_ADDR_WIDTH pending commands
+    )
+    (
+    input                CLK,                        // controller clock
+    input                RESET,
+
+    input                ELV_ENABLE,                 // 1 : C-SCAN / deadline, 0 : arrival order
+    input       [31:0]   ELV_DEADLINE,               // clocks, 0 : no deadline
+    input                ELV_CLEAR_STATS,
+    output reg  [63:0]   ELV_ARR_DIST_SUM,           // arrival order seek distance sum (sectors)
+    output reg  [31:0]   ELV_ARR_COUNT,
+    output reg  [63:0]   ELV_DSP_DIST_SUM,           // dispatch order seek distance sum (sectors)
+    output reg  [31:0]   ELV_DSP_COUNT,
+    output reg           ELV_DISPATCH,               // one clock pulse, command handed to the drive
+    output reg  [3:0]    ELV_DISPATCH_TAG,
+
+    // request port, same handshake as SATA_CMD_ISSUE
+    input                IN_CMD_REQ,
+    output               IN_CMD_READY,
+    input       [7:0]    IN_CMD_CODE,
+    input       [15:0]   IN_CMD_FEATURES,
+    input       [47:0]   IN_CMD_LBA,
+    input       [15:0]   IN_CMD_SECTORS,
+    input       [3:0]    IN_CMD_TAG,
+    output reg           IN_CMD_DONE,
+    output reg  [3:0]    IN_CMD_DONE_TAG,
+    output reg           IN_CMD_ERROR,
+    output reg  [7:0]    IN_CMD_STATUS,
+    output reg  [7:0]    IN_CMD_ERR_REG,
+
+    // to SATA_CMD_ISSUE
+    output reg           CMD_REQ,
+    input                CMD_READY,
+    output reg  [7:0]    CMD_CODE,
+    output reg  [15:0]   CMD_FEATURES,
+    output reg  [47:0]   CMD_LBA,
+    output reg  [15:0]   CMD_SECTORS,
+    input                CMD_DONE,
+    input                CMD_ERROR,
+    input       [7:0]    CMD_STATUS,
+    input       [7:0]    CMD_ERR_REG
+    );
+
+  parameter  V_IDLE        = 3'h0;
+  parameter  V_SCAN        = 3'h1;
+  parameter  V_PICK        = 3'h2;
+  parameter  V_ISSUE       = 3'h3;
+  parameter  V_CMD_WAIT    = 3'h4;
+
+  localparam SLOTS         = (1 << SLOT_ADDR_WIDTH);
+
+  // slot : {tag, code, features, lba, sectors}
+  reg   [91:0]                 slot_cmd  [0:SLOTS-1];
+  reg   [31:0]                 slot_time [0:SLOTS-1];
+  reg   [SLOTS-1:0]            slot_valid;
+
+  reg   [2:0]                  state;
+  reg   [31:0]                 now;                  // free running time stamp
+  reg   [47:0]                 head;                 // end LBA of the last dispatched command
+  reg   [47:0]                 arr_prev_end;
+  reg   [SLOT_ADDR_WIDTH:0]    scan_idx;
+  reg   [SLOT_ADDR_WIDTH-1:0]  pick_idx;
+  reg   [3:0]                  cur_tag;
+
+  reg                          ahead_found;
+  reg   [SLOT_ADDR_WIDTH-1:0]  ahead_idx;
+  reg   [47:0]                 ahead_lba;
+  reg                          any_found;
+  reg   [SLOT_ADDR_WIDTH-1:0]  any_idx;
+  reg   [47:0]                 any_lba;
+  reg   [SLOT_ADDR_WIDTH-1:0]  old_idx;
+  reg   [31:0]                 old_age;
+
+  reg   [SLOT_ADDR_WIDTH-1:0]  free_idx;
+  reg                          free_found;
+  integer                      i;
+
+  wire  [SLOT_ADDR_WIDTH-1:0]  scan_slot;
+  wire  [47:0]                 scan_lba;
+  wire  [31:0]                 scan_age;
+  wire  [47:0]                 arr_dist;
+  wire  [47:0]                 dsp_dist;
+  wire  [47:0]                 pick_lba;
+  wire  [15:0]                 pick_sectors;
+  wire                         in_push;
+
+  // first free slot
+  always @(*)
+  begin
+    free_found = 1'b0;
+    free_idx   = {SLOT_ADDR_WIDTH{1'b0}};
+    for(i = SLOTS-1; i >= 0; i = i - 1) begin
+      if(!slot_valid[i]) begin
+        free_found = 1'b1;
+        free_idx   = i;
+      end
+    end
+  end
+
+  assign IN_CMD_READY = free_found;
+  assign in_push      = IN_CMD_REQ && IN_CMD_READY;
+
+  assign scan_slot    = scan_idx[SLOT_ADDR_WIDTH-1:0];
+  assign scan_lba     = slot_cmd[scan_slot][63:16];
+  assign scan_age     = now - slot_time[scan_slot];
+  assign pick_lba     = slot_cmd[pick_idx][63:16];
+  assign pick_sectors = slot_cmd[pick_idx][15:0];
+  assign arr_dist     = (IN_CMD_LBA >= arr_prev_end) ? IN_CMD_LBA - arr_prev_end : arr_prev_end - IN_CMD_LBA;
+  assign dsp_dist     = (pick_lba >= head) ? pick_lba - head : head - pick_lba;
+
+  always @(posedge CLK)
+  begin
+    if(in_push) begin
+      slot_cmd[free_idx]  <= {IN_CMD_TAG, IN_CMD_CODE, IN_CMD_FEATURES, IN_CMD_LBA, IN_CMD_SECTORS};
+      slot_time[free_idx] <= now;
+    end
+  end
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      state            <= V_IDLE;
+      now              <= 32'd0;
+      slot_valid       <= {SLOTS{1'b0}};
+      head             <= 48'd0;
+      scan_idx         <= 'd0;
+      pick_idx         <= 'd0;
+      cur_tag          <= 4'd0;
+      ahead_found      <= 1'b0;
+      ahead_idx        <= 'd0;
+      ahead_lba        <= 48'd0;
+      any_found        <= 1'b0;
+      any_idx          <= 'd0;
+      any_lba          <= 48'd0;
+      old_idx          <= 'd0;
+      old_age          <= 32'd0;
+      CMD_REQ          <= 1'b0;
+      CMD_CODE         <= 8'd0;
+      CMD_FEATURES     <= 16'd0;
+      CMD_LBA          <= 48'd0;
+      CMD_SECTORS      <= 16'd0;
+      IN_CMD_DONE      <= 1'b0;
+      IN_CMD_DONE_TAG  <= 4'd0;
+      IN_CMD_ERROR     <= 1'b0;
+      IN_CMD_STATUS    <= 8'd0;
+      IN_CMD_ERR_REG   <= 8'd0;
+      ELV_DISPATCH     <= 1'b0;
+      ELV_DISPATCH_TAG <= 4'd0;
+    end
+    else begin
+      now              <= now + 1'b1;
+      IN_CMD_DONE      <= 1'b0;
+      ELV_DISPATCH     <= 1'b0;
+      if(in_push) begin
+        slot_valid[free_idx] <= 1'b1;
+      end
+
+      case(state)
+        V_IDLE: begin
+          if(slot_valid != {SLOTS{1'b0}}) begin
+            scan_idx         <= 'd0;
+            ahead_found      <= 1'b0;
+            any_found        <= 1'b0;
+            old_age          <= 32'd0;
+            state            <= V_SCAN;
+          end
+        end
+        V_SCAN: begin
+          if(scan_idx == SLOTS) begin
+            state            <= V_PICK;
+          end
+          else begin
+            scan_idx         <= scan_idx + 1'b1;
+            if(slot_valid[scan_slot]) begin
+              if(scan_age >= old_age) begin
+                old_age          <= scan_age;
+                old_idx          <= scan_slot;
+              end
+              if(!any_found || scan_lba < any_lba) begin
+                any_found        <= 1'b1;
+                any_lba          <= scan_lba;
+                any_idx          <= scan_slot;
+              end
+              if(scan_lba >= head && (!ahead_found || scan_lba < ahead_lba)) begin
+                ahead_found      <= 1'b1;
+                ahead_lba        <= scan_lba;
+                ahead_idx        <= scan_slot;
+              end
+            end
+          end
+        end
+        V_PICK: begin
+          if(!ELV_ENABLE || (ELV_DEADLINE != 32'd0 && old_age >= ELV_DEADLINE)) begin
+            pick_idx         <= old_idx;
+          end
+          else if(ahead_found) begin
+            pick_idx         <= ahead_idx;
+          end
+          else begin
+            pick_idx         <= any_idx;
+          end
+          state            <= V_ISSUE;
+        end
+        V_ISSUE: begin
+          if(!CMD_REQ) begin
+            {cur_tag, CMD_CODE, CMD_FEATURES, CMD_LBA, CMD_SECTORS} <= slot_cmd[pick_idx];
+            CMD_REQ          <= 1'b1;
+          end
+          else if(CMD_READY) begin
+            CMD_REQ          <= 1'b0;
+            slot_valid[pick_idx] <= 1'b0;
+            head             <= CMD_LBA + CMD_SECTORS;
+            ELV_DISPATCH     <= 1'b1;
+            ELV_DISPATCH_TAG <= cur_tag;
+            state            <= V_CMD_WAIT;
+          end
+        end
+        V_CMD_WAIT: begin
+          if(CMD_DONE) begin
+            IN_CMD_DONE      <= 1'b1;
+            IN_CMD_DONE_TAG  <= cur_tag;
+            IN_CMD_ERROR     <= CMD_ERROR;
+            IN_CMD_STATUS    <= CMD_STATUS;
+            IN_CMD_ERR_REG   <= CMD_ERR_REG;
+            state            <= V_IDLE;
+          end
+        end
+        default: begin
+          state            <= V_IDLE;
+        end
+      endcase
+    end
+  end
+
+  //******************************** seek distance statistics ***************************
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      arr_prev_end     <= 48'd0;
+      ELV_ARR_DIST_SUM <= 64'd0;
+      ELV_ARR_COUNT    <= 32'd0;
+      ELV_DSP_DIST_SUM <= 64'd0;
+      ELV_DSP_COUNT    <= 32'd0;
+    end
+    else if(ELV_CLEAR_STATS) begin
+      ELV_ARR_DIST_SUM <= 64'd0;
+      ELV_ARR_COUNT    <= 32'd0;
+      ELV_DSP_DIST_SUM <= 64'd0;
+      ELV_DSP_COUNT    <= 32'd0;
+    end
+    else begin
+      if(in_push) begin
+        arr_prev_end     <= IN_CMD_LBA + IN_CMD_SECTORS;
+        ELV_ARR_DIST_SUM <= ELV_ARR_DIST_SUM + arr_dist;
+        ELV_ARR_COUNT    <= ELV_ARR_COUNT + 1'b1;
+      end
+      if(state == V_PICK) begin
+        ELV_DSP_COUNT    <= ELV_DSP_COUNT + 1'b1;
+      end
+      if(state == V_ISSUE && !CMD_REQ) begin
+        ELV_DSP_DIST_SUM <= ELV_DSP_DIST_SUM + dsp_dist;
+      end
+    end
+  end
+
+endmodule
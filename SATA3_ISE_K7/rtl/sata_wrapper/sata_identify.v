@@ -0,0 +1,342 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : IDENTIFY DEVICE auto configuration
+//  File name   : sata_identify.v
+//  Note        : Runs on the shadow register port of SATA_CONTROLLER
+//                (CLK_OUT domain) when the link comes up (AUTO_IDENTIFY)
+//                or on ID_START :
+//                 1. IDENTIFY DEVICE (ECh), PIO data in. The 128 Dwords are
+//                    read from the data register once the command ends,
+//                    so PIO_CLK_IN must be CLK_OUT and DMA_RQST low while
+//                    ID_BUSY is high. Also holds with DMA_ONLY, which
+//                    keeps the PIO data in path for this command.
+//                 2. SET FEATURES enable write cache (EFh / 02h) when
+//                    WCACHE_ENABLE is set and the drive supports it.
+//                The parsed words are held until the next run or link
+//                loss. DEV_READY is high from the end of a good run until
+//                LINKUP drops, user logic waits on it instead of a fixed
+//                delay after reset.
+//                IDENTIFY words used (Dword k = {word 2k+1, word 2k}) :
+//                  60-61 LBA28 max, 83.10 LBA48, 100-103 LBA48 max,
+//                  75 queue depth, 76 NCQ and Gen1/2/3, 82.5 / 85.5 write
+//                  cache, 106 / 117-118 sector sizes, 169.0 TRIM.
+//  Design ref. : ATA8-ACS, SATA3 Specification
+//  Dependencies   : SATA_CONTROLLER
+//////////////////////////////////////////////////////////////////////////////
+
+module SATA_IDENTIFY #(
+    parameter        AUTO_IDENTIFY = 1,                // start on the rising edge of LINKUP
+    parameter        WCACHE_ENABLE = 1,                // issue SET FEATURES enable write cache
+    parameter        CMD_TIMEOUT   = 32'h0100_0000     // per command watchdog in CLK cycles
+    )
+    (
+    input                CLK,                      // controller clock (CLK_OUT)
+    input                RESET,
+    input                LINKUP,
+
+    input                ID_START,                 // manual start, taken when ID_BUSY is low
+    output reg           ID_BUSY,
+    output reg           ID_DONE,                  // one clock pulse at the end of the sequence
+    output reg           ID_ERROR,                 // IDENTIFY failed or timed out
+    output reg           DEV_READY,                // drive identified, controller ready for I/O
+
+    output reg  [47:0]   ID_MAX_LBA,               // number of user addressable sectors
+    output reg           ID_LBA48,
+    output reg           ID_NCQ,                   // NCQ supported
+    output reg  [5:0]    ID_NCQ_DEPTH,             // 1 .. 32
+    output reg  [31:0]   ID_LOG_SECT_SIZE,         // logical sector size in bytes
+    output reg  [3:0]    ID_PHYS_SECT_SHIFT,       // physical sector = logical << shift
+    output reg           ID_WCACHE_SUP,            // write cache supported
+    output reg           ID_WCACHE_EN,             // write cache enabled
+    output reg           ID_TRIM,                  // DATA SET MANAGEMENT / TRIM supported
+    output reg  [2:0]    ID_GEN_SUP,               // {Gen3, Gen2, Gen1} signalling speeds
+
+    output reg           HOST_READ_EN,             // to SATA_CONTROLLER shadow register port
+    output reg           HOST_WRITE_EN,
+    output reg  [4:0]    HOST_ADDR_REG,
+    output reg  [31:0]   HOST_DATA_IN,
+    input       [31:0]   HOST_DATA_OUT
+    );
+
+  // shadow register addresses, same as sata_transport
+  parameter cmd_reg               =  5'd1        ;
+  parameter feature_reg           =  5'd3        ;
+  parameter stuts_reg             =  5'd4        ;
+  parameter head_reg              =  5'd5        ;
+  parameter lba_low               =  5'd7        ;
+  parameter sect_count            =  5'd10       ;
+  parameter data_reg              =  5'd11       ;
+
+  parameter IDENTIFY_DEVICE       =  8'hEC       ;
+  parameter SET_FEATURES          =  8'hEF       ;
+  parameter SF_WCACHE_ON          =  8'h02       ;
+
+  parameter IDLE                  =  4'h0        ;
+  parameter ID_SIG                =  4'h1        ;
+  parameter ID_CMD                =  4'h2        ;
+  parameter ID_DATA               =  4'h3        ;
+  parameter ID_PARSE              =  4'h4        ;
+  parameter SF_CMD                =  4'h5        ;
+  parameter SF_END                =  4'h6        ;
+  parameter SEQ_END               =  4'h7        ;
+  // non data / PIO in command, returns to ret_state
+  parameter C_FEATURE             =  4'h8        ;
+  parameter C_HEAD                =  4'h9        ;
+  parameter C_COUNT               =  4'hA        ;
+  parameter C_LBA_LOW             =  4'hB        ;
+  parameter C_CMD                 =  4'hC        ;
+  parameter C_WAIT_BSY            =  4'hD        ;
+  parameter C_POLL                =  4'hE        ;
+
+  reg   [3:0]    state;
+  reg   [3:0]    ret_state;
+  reg            linkup_d;
+  reg   [31:0]   cmd_timer;
+  reg   [7:0]    cmd_code;
+  reg   [7:0]    cmd_feature;
+  reg            cmd_fail;
+  reg   [6:0]    dw_count;
+
+  // raw IDENTIFY words kept for the parse step
+  reg   [31:0]   lba28_max;                        // words 60-61
+  reg   [31:0]   lba48_max_lo;                     // words 100-101
+  reg   [15:0]   lba48_max_hi;                     // words 102
+  reg   [15:0]   w75;
+  reg   [15:0]   w76;
+  reg   [15:0]   w82;
+  reg   [15:0]   w83;
+  reg   [15:0]   w85;
+  reg   [15:0]   w106;
+  reg   [31:0]   log_sect_words;                   // words 117-118
+  reg   [15:0]   w169;
+
+  wire           start;
+
+  assign start = ID_START || (AUTO_IDENTIFY && LINKUP && !linkup_d);
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      linkup_d       <= 1'b0;
+    end
+    else begin
+      linkup_d       <= LINKUP;
+    end
+  end
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      state              <= IDLE;
+      ret_state          <= IDLE;
+      cmd_timer          <= 32'd0;
+      cmd_code           <= 8'd0;
+      cmd_feature        <= 8'd0;
+      cmd_fail           <= 1'b0;
+      dw_count           <= 7'd0;
+      lba28_max          <= 32'd0;
+      lba48_max_lo       <= 32'd0;
+      lba48_max_hi       <= 16'd0;
+      w75                <= 16'd0;
+      w76                <= 16'd0;
+      w82                <= 16'd0;
+      w83                <= 16'd0;
+      w85                <= 16'd0;
+      w106               <= 16'd0;
+      log_sect_words     <= 32'd0;
+      w169               <= 16'd0;
+      ID_BUSY            <= 1'b0;
+      ID_DONE            <= 1'b0;
+      ID_ERROR           <= 1'b0;
+      DEV_READY          <= 1'b0;
+      ID_MAX_LBA         <= 48'd0;
+      ID_LBA48           <= 1'b0;
+      ID_NCQ             <= 1'b0;
+      ID_NCQ_DEPTH       <= 6'd0;
+      ID_LOG_SECT_SIZE   <= 32'd0;
+      ID_PHYS_SECT_SHIFT <= 4'd0;
+      ID_WCACHE_SUP      <= 1'b0;
+      ID_WCACHE_EN       <= 1'b0;
+      ID_TRIM            <= 1'b0;
+      ID_GEN_SUP         <= 3'd0;
+      HOST_READ_EN       <= 1'b0;
+      HOST_WRITE_EN      <= 1'b0;
+      HOST_ADDR_REG      <= 5'd0;
+      HOST_DATA_IN       <= 32'd0;
+    end
+    else begin
+      ID_DONE        <= 1'b0;
+      HOST_WRITE_EN  <= 1'b0;
+      if(!LINKUP) begin
+        DEV_READY      <= 1'b0;
+      end
+      case(state)
+        IDLE: begin
+          HOST_READ_EN   <= 1'b0;
+          if(start && LINKUP) begin
+            ID_BUSY        <= 1'b1;
+            ID_ERROR       <= 1'b0;
+            DEV_READY      <= 1'b0;
+            HOST_READ_EN   <= 1'b1;
+            HOST_ADDR_REG  <= stuts_reg;
+            cmd_timer      <= 32'd0;
+            state          <= ID_SIG;
+          end
+        end
+
+        //******************************** IDENTIFY DEVICE **********************************
+        ID_SIG: begin                                                // BSY stays set until the signature FIS
+          cmd_timer      <= cmd_timer + 1'b1;
+          if(!LINKUP || cmd_timer == CMD_TIMEOUT) begin
+            ID_ERROR       <= 1'b1;
+            state          <= SEQ_END;
+          end
+          else if(cmd_timer > 32'd2 && !HOST_DATA_OUT[7]) begin
+            HOST_READ_EN   <= 1'b0;
+            state          <= ID_CMD;
+          end
+        end
+        ID_CMD: begin
+          cmd_code       <= IDENTIFY_DEVICE;
+          cmd_feature    <= 8'd0;
+          ret_state      <= ID_DATA;
+          state          <= C_FEATURE;
+        end
+        ID_DATA: begin
+          if(cmd_fail) begin
+            ID_ERROR       <= 1'b1;
+            state          <= SEQ_END;
+          end
+          else begin                                                 // FWFT receive FIFO, one Dword per read
+            HOST_READ_EN   <= 1'b1;
+            HOST_ADDR_REG  <= data_reg;
+            dw_count       <= 7'd0;
+            state          <= ID_PARSE;
+          end
+        end
+        ID_PARSE: begin
+          dw_count       <= dw_count + 1'b1;
+          case(dw_count)
+            7'd30 : lba28_max      <= HOST_DATA_OUT;
+            7'd37 : w75            <= HOST_DATA_OUT[31:16];
+            7'd38 : w76            <= HOST_DATA_OUT[15:0];
+            7'd41 : begin
+                    w82            <= HOST_DATA_OUT[15:0];
+                    w83            <= HOST_DATA_OUT[31:16];
+                    end
+            7'd42 : w85            <= HOST_DATA_OUT[31:16];
+            7'd50 : lba48_max_lo   <= HOST_DATA_OUT;
+            7'd51 : lba48_max_hi   <= HOST_DATA_OUT[15:0];
+            7'd53 : w106           <= HOST_DATA_OUT[15:0];
+            7'd58 : log_sect_words[15:0]  <= HOST_DATA_OUT[31:16];
+            7'd59 : log_sect_words[31:16] <= HOST_DATA_OUT[15:0];
+            7'd84 : w169           <= HOST_DATA_OUT[31:16];
+            default : ;
+          endcase
+          if(dw_count == 7'd127) begin
+            HOST_READ_EN   <= 1'b0;
+            state          <= SF_CMD;
+          end
+        end
+        SF_CMD: begin                                                // all words captured, publish them
+          ID_LBA48           <= w83[10];
+          ID_MAX_LBA         <= w83[10] ? {lba48_max_hi, lba48_max_lo} : {16'd0, lba28_max};
+          ID_NCQ             <= w76[8];
+          ID_NCQ_DEPTH       <= w76[8] ? ({1'b0, w75[4:0]} + 1'b1) : 6'd1;
+          ID_GEN_SUP         <= w76[3:1];
+          ID_WCACHE_SUP      <= w82[5];
+          ID_WCACHE_EN       <= w85[5];
+          ID_TRIM            <= w169[0];
+          if(w106[15:14] == 2'b01) begin                             // word 106 valid
+            ID_LOG_SECT_SIZE   <= w106[12] ? {log_sect_words[30:0], 1'b0} : 32'd512;
+            ID_PHYS_SECT_SHIFT <= w106[13] ? w106[3:0] : 4'd0;
+          end
+          else begin
+            ID_LOG_SECT_SIZE   <= 32'd512;
+            ID_PHYS_SECT_SHIFT <= 4'd0;
+          end
+          if(WCACHE_ENABLE && w82[5] && !w85[5]) begin
+            cmd_code       <= SET_FEATURES;
+            cmd_feature    <= SF_WCACHE_ON;
+            ret_state      <= SF_END;
+            state          <= C_FEATURE;
+          end
+          else begin
+            state          <= SEQ_END;
+          end
+        end
+        SF_END: begin                                                // a refused SET FEATURES is not fatal
+          if(!cmd_fail) begin
+            ID_WCACHE_EN   <= 1'b1;
+          end
+          state          <= SEQ_END;
+        end
+        SEQ_END: begin
+          HOST_READ_EN   <= 1'b0;
+          ID_BUSY        <= 1'b0;
+          ID_DONE        <= 1'b1;
+          DEV_READY      <= LINKUP && !ID_ERROR;
+          state          <= IDLE;
+        end
+
+        //******************************** command **************************************
+        C_FEATURE: begin
+          HOST_READ_EN   <= 1'b0;
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= feature_reg;
+          HOST_DATA_IN   <= {24'd0, cmd_feature};
+          cmd_fail       <= 1'b0;
+          state          <= C_HEAD;
+        end
+        C_HEAD: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= head_reg;
+          HOST_DATA_IN   <= 32'hA0;
+          state          <= C_COUNT;
+        end
+        C_COUNT: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= sect_count;
+          HOST_DATA_IN   <= 32'd0;
+          state          <= C_LBA_LOW;
+        end
+        C_LBA_LOW: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= lba_low;
+          HOST_DATA_IN   <= 32'd0;
+          state          <= C_CMD;
+        end
+        C_CMD: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= cmd_reg;
+          HOST_DATA_IN   <= {24'd0, cmd_code};
+          state          <= C_WAIT_BSY;
+        end
+        C_WAIT_BSY: begin                                            // command write sets BSY in the next clock
+          HOST_READ_EN   <= 1'b1;
+          HOST_ADDR_REG  <= stuts_reg;
+          cmd_timer      <= 32'd0;
+          state          <= C_POLL;
+        end
+        C_POLL: begin                                                // PIO in : BSY and DRQ both clear at the end
+          cmd_timer      <= cmd_timer + 1'b1;
+          if(!LINKUP || cmd_timer == CMD_TIMEOUT) begin
+            cmd_fail       <= 1'b1;
+            HOST_READ_EN   <= 1'b0;
+            state          <= ret_state;
+          end
+          else if(!HOST_DATA_OUT[7] && !HOST_DATA_OUT[3]) begin
+            cmd_fail       <= HOST_DATA_OUT[0];
+            HOST_READ_EN   <= 1'b0;
+            state          <= ret_state;
+          end
+        end
+        default: begin
+          state          <= IDLE;
+        end
+      endcase
+    end
+  end
+
+endmodule
@@ -0,0 +1,422 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : Port multiplier discovery and port reset
+//  File name   : sata_pm_init.v
+//  Note        : Runs once per PM_START on the shadow register port of
+//                SATA_CONTROLLER (CLK_OUT domain) :
+//                 1. soft reset to the PM control port (15). A PM answers
+//                    with the PM signature (LBA mid 69h, LBA high 96h); no
+//                    answer or another signature means a plain device,
+//                    which then gets the soft reset on port 0.
+//                 2. READ PORT MULTIPLIER of GSCR[2], number of device ports.
+//                 3. per device port : COMRESET through PSCR SControl
+//                    (DET = 1 for RESET_HOLD clocks), poll PSCR SStatus
+//                    until DET = 3 or LINK_TIMEOUT, clear PSCR SError.
+//                PM_PORT_LINKUP has one bit per device port with a drive.
+//                The PM port register is left at 0. Commands to a drive
+//                behind the PM are issued after writing its number to the
+//                PM port register (address 12) of the transport.
+//  Design ref. : SATA Port Multiplier Specification 1.2, SATA3 Specification
+//  Dependencies   : SATA_CONTROLLER
+//////////////////////////////////////////////////////////////////////////////
+
+module SATA_PM_INIT #(
+    parameter        RESET_HOLD   = 32'd150_000,      // SControl DET = 1 time, 1 ms at 150 MHz
+    parameter        SRST_HOLD    = 32'd1_000,        // SRST asserted time in CLK cycles
+    parameter        CMD_TIMEOUT  = 32'h0100_0000,    // soft reset / PM command watchdog
+    parameter        LINK_TIMEOUT = 32'd15_000_000    // device port link up wait, 100 ms at 150 MHz
+    )
+    (
+    input                CLK,                      // controller clock (CLK_OUT)
+    input                RESET,
+    input                LINKUP,
+
+    input                PM_START,                 // start discovery, taken when PM_BUSY is low
+    output reg           PM_BUSY,
+    output reg           PM_DONE,                  // one clock pulse at the end of the sequence
+    output reg           PM_PRESENT,               // a port multiplier answered on port 15
+    output reg  [3:0]    PM_NUM_PORTS,             // device ports of the PM, GSCR[2]
+    output reg  [14:0]   PM_PORT_LINKUP,           // SStatus DET = 3 after the port reset
+    output reg           PM_ERROR,                 // a PM register command failed or timed out
+
+    output reg           HOST_READ_EN,             // to SATA_CONTROLLER shadow register port
+    output reg           HOST_WRITE_EN,
+    output reg  [4:0]    HOST_ADDR_REG,
+    output reg  [31:0]   HOST_DATA_IN,
+    input       [31:0]   HOST_DATA_OUT
+    );
+
+  // shadow register addresses, same as sata_transport
+  parameter cmd_reg               =  5'd1        ;
+  parameter ctrl_reg              =  5'd2        ;
+  parameter feature_reg           =  5'd3        ;
+  parameter stuts_reg             =  5'd4        ;
+  parameter head_reg              =  5'd5        ;
+  parameter lba_low               =  5'd7        ;
+  parameter lba_mid               =  5'd8        ;
+  parameter lba_high              =  5'd9        ;
+  parameter sect_count            =  5'd10       ;
+  parameter pm_port_reg           =  5'd12       ;
+
+  parameter READ_PM               =  8'hE4       ;
+  parameter WRITE_PM              =  8'hE8       ;
+  parameter PM_CTRL_PORT          =  4'hF        ;
+  parameter PSCR_SSTATUS          =  8'd0        ;
+  parameter PSCR_SERROR           =  8'd1        ;
+  parameter PSCR_SCONTROL         =  8'd2        ;
+  parameter GSCR_PORTS            =  8'd2        ;
+
+  parameter IDLE                  =  5'h00       ;
+  parameter SEL_PORT              =  5'h01       ;
+  parameter SRST_ON               =  5'h02       ;
+  parameter SRST_WAIT             =  5'h03       ;
+  parameter SRST_OFF              =  5'h04       ;
+  parameter SIG_POLL              =  5'h05       ;
+  parameter SIG_MID               =  5'h06       ;
+  parameter SIG_HIGH              =  5'h07       ;
+  parameter GSCR_READ             =  5'h08       ;
+  parameter PORT_RST_ON           =  5'h09       ;
+  parameter PORT_RST_WAIT         =  5'h0A       ;
+  parameter PORT_RST_OFF          =  5'h0B       ;
+  parameter PORT_POLL             =  5'h0C       ;
+  parameter PORT_CLR              =  5'h0D       ;
+  parameter PORT_NEXT             =  5'h0E       ;
+  parameter SEQ_END               =  5'h0F       ;
+  // PM register command, returns to ret_state
+  parameter C_FEATURE             =  5'h10       ;
+  parameter C_HEAD                =  5'h11       ;
+  parameter C_COUNT               =  5'h12       ;
+  parameter C_LBA_LOW             =  5'h13       ;
+  parameter C_LBA_MID             =  5'h14       ;
+  parameter C_LBA_HIGH            =  5'h15       ;
+  parameter C_CMD                 =  5'h16       ;
+  parameter C_WAIT_BSY            =  5'h17       ;
+  parameter C_POLL                =  5'h18       ;
+  parameter C_RD_COUNT            =  5'h19       ;
+  parameter C_RD_LOW              =  5'h1A       ;
+  parameter C_RD_MID              =  5'h1B       ;
+  parameter C_RD_HIGH             =  5'h1C       ;
+
+  reg   [4:0]    state;
+  reg   [4:0]    ret_state;
+  reg            plain;                            // no PM, soft reset goes to port 0
+  reg   [31:0]   timer;
+  reg   [31:0]   cmd_timer;
+  reg   [7:0]    sig_mid;
+  reg   [3:0]    port;
+  reg   [7:0]    pm_code;
+  reg   [3:0]    pm_target;
+  reg   [7:0]    pm_reg;
+  reg   [31:0]   pm_value;                         // write value / read result
+  reg            pm_fail;
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      state          <= IDLE;
+      ret_state      <= IDLE;
+      plain          <= 1'b0;
+      timer          <= 32'd0;
+      cmd_timer      <= 32'd0;
+      sig_mid        <= 8'd0;
+      port           <= 4'd0;
+      pm_code        <= 8'd0;
+      pm_target      <= 4'd0;
+      pm_reg         <= 8'd0;
+      pm_value       <= 32'd0;
+      pm_fail        <= 1'b0;
+      PM_BUSY        <= 1'b0;
+      PM_DONE        <= 1'b0;
+      PM_PRESENT     <= 1'b0;
+      PM_NUM_PORTS   <= 4'd0;
+      PM_PORT_LINKUP <= 15'd0;
+      PM_ERROR       <= 1'b0;
+      HOST_READ_EN   <= 1'b0;
+      HOST_WRITE_EN  <= 1'b0;
+      HOST_ADDR_REG  <= 5'd0;
+      HOST_DATA_IN   <= 32'd0;
+    end
+    else begin
+      PM_DONE        <= 1'b0;
+      HOST_WRITE_EN  <= 1'b0;
+      case(state)
+        IDLE: begin
+          HOST_READ_EN   <= 1'b0;
+          if(PM_START && LINKUP) begin
+            PM_BUSY        <= 1'b1;
+            PM_PRESENT     <= 1'b0;
+            PM_NUM_PORTS   <= 4'd0;
+            PM_PORT_LINKUP <= 15'd0;
+            PM_ERROR       <= 1'b0;
+            plain          <= 1'b0;
+            state          <= SEL_PORT;
+          end
+        end
+
+        //******************************** soft reset, signature ****************************
+        SEL_PORT: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= pm_port_reg;
+          HOST_DATA_IN   <= plain ? 32'd0 : {28'd0, PM_CTRL_PORT};
+          state          <= SRST_ON;
+        end
+        SRST_ON: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= ctrl_reg;
+          HOST_DATA_IN   <= 32'h04;                                  // SRST
+          timer          <= 32'd0;
+          state          <= SRST_WAIT;
+        end
+        SRST_WAIT: begin
+          timer          <= timer + 1'b1;
+          if(timer == SRST_HOLD) begin
+            state          <= SRST_OFF;
+          end
+        end
+        SRST_OFF: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= ctrl_reg;
+          HOST_DATA_IN   <= 32'h00;
+          timer          <= 32'd0;
+          state          <= SIG_POLL;
+        end
+        SIG_POLL: begin                                              // BSY cleared by the signature FIS
+          HOST_READ_EN   <= 1'b1;
+          HOST_ADDR_REG  <= stuts_reg;
+          timer          <= timer + 1'b1;
+          if(!LINKUP) begin
+            state          <= SEQ_END;
+          end
+          else if(timer == CMD_TIMEOUT) begin
+            if(plain) begin
+              PM_ERROR       <= 1'b1;
+              state          <= SEQ_END;
+            end
+            else begin
+              plain          <= 1'b1;
+              state          <= SEL_PORT;
+            end
+          end
+          else if(timer > 32'd2 && !HOST_DATA_OUT[7]) begin
+            HOST_ADDR_REG  <= lba_mid;
+            state          <= SIG_MID;
+          end
+        end
+        SIG_MID: begin
+          sig_mid        <= HOST_DATA_OUT[7:0];
+          HOST_ADDR_REG  <= lba_high;
+          state          <= SIG_HIGH;
+        end
+        SIG_HIGH: begin
+          HOST_READ_EN   <= 1'b0;
+          if(plain) begin
+            state          <= SEQ_END;
+          end
+          else if(sig_mid == 8'h69 && HOST_DATA_OUT[7:0] == 8'h96) begin
+            PM_PRESENT     <= 1'b1;
+            pm_code        <= READ_PM;
+            pm_target      <= PM_CTRL_PORT;
+            pm_reg         <= GSCR_PORTS;
+            pm_value       <= 32'd0;
+            ret_state      <= GSCR_READ;
+            state          <= C_FEATURE;
+          end
+          else begin
+            plain          <= 1'b1;
+            state          <= SEL_PORT;
+          end
+        end
+
+        //******************************** device ports *************************************
+        GSCR_READ: begin
+          if(pm_fail) begin
+            PM_ERROR       <= 1'b1;
+            state          <= SEQ_END;
+          end
+          else begin
+            PM_NUM_PORTS   <= pm_value[3:0];
+            port           <= 4'd0;
+            state          <= PORT_NEXT;
+          end
+        end
+        PORT_NEXT: begin
+          if(port == PM_NUM_PORTS) begin
+            state          <= SEQ_END;
+          end
+          else begin
+            state          <= PORT_RST_ON;
+          end
+        end
+        PORT_RST_ON: begin                                           // SControl : IPM = 3, DET = 1
+          pm_code        <= WRITE_PM;
+          pm_target      <= port;
+          pm_reg         <= PSCR_SCONTROL;
+          pm_value       <= 32'h301;
+          timer          <= 32'd0;
+          ret_state      <= PORT_RST_WAIT;
+          state          <= C_FEATURE;
+        end
+        PORT_RST_WAIT: begin
+          timer          <= timer + 1'b1;
+          if(pm_fail) begin
+            PM_ERROR       <= 1'b1;
+            port           <= port + 1'b1;
+            state          <= PORT_NEXT;
+          end
+          else if(timer == RESET_HOLD) begin
+            state          <= PORT_RST_OFF;
+          end
+        end
+        PORT_RST_OFF: begin
+          pm_code        <= WRITE_PM;
+          pm_value       <= 32'h300;
+          timer          <= 32'd0;
+          ret_state      <= PORT_POLL;
+          state          <= C_FEATURE;
+        end
+        PORT_POLL: begin                                             // timer runs over the SStatus reads
+          timer          <= timer + 1'b1;
+          if(pm_fail) begin
+            PM_ERROR       <= 1'b1;
+            port           <= port + 1'b1;
+            state          <= PORT_NEXT;
+          end
+          else if(pm_code == READ_PM && pm_value[3:0] == 4'h3) begin
+            PM_PORT_LINKUP[port] <= 1'b1;
+            state          <= PORT_CLR;
+          end
+          else if(timer >= LINK_TIMEOUT) begin
+            state          <= PORT_CLR;
+          end
+          else begin
+            pm_code        <= READ_PM;
+            pm_reg         <= PSCR_SSTATUS;
+            pm_value       <= 32'd0;
+            ret_state      <= PORT_POLL;
+            state          <= C_FEATURE;
+          end
+        end
+        PORT_CLR: begin                                              // SError is write one to clear
+          pm_code        <= WRITE_PM;
+          pm_reg         <= PSCR_SERROR;
+          pm_value       <= 32'hFFFF_FFFF;
+          port           <= port + 1'b1;
+          ret_state      <= PORT_NEXT;
+          state          <= C_FEATURE;
+        end
+        SEQ_END: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_READ_EN   <= 1'b0;
+          HOST_ADDR_REG  <= pm_port_reg;
+          HOST_DATA_IN   <= 32'd0;
+          PM_BUSY        <= 1'b0;
+          PM_DONE        <= 1'b1;
+          state          <= IDLE;
+        end
+
+        //******************************** PM register command ******************************
+        // features = register, device[3:0] = port, value in count / LBA low, mid, high
+        C_FEATURE: begin
+          HOST_READ_EN   <= 1'b0;
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= feature_reg;
+          HOST_DATA_IN   <= {24'd0, pm_reg};
+          pm_fail        <= 1'b0;
+          state          <= C_HEAD;
+        end
+        C_HEAD: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= head_reg;
+          HOST_DATA_IN   <= {28'd0, pm_target};
+          state          <= C_COUNT;
+        end
+        C_COUNT: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= sect_count;
+          HOST_DATA_IN   <= {24'd0, pm_value[7:0]};
+          state          <= C_LBA_LOW;
+        end
+        C_LBA_LOW: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= lba_low;
+          HOST_DATA_IN   <= {24'd0, pm_value[15:8]};
+          state          <= C_LBA_MID;
+        end
+        C_LBA_MID: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= lba_mid;
+          HOST_DATA_IN   <= {24'd0, pm_value[23:16]};
+          state          <= C_LBA_HIGH;
+        end
+        C_LBA_HIGH: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= lba_high;
+          HOST_DATA_IN   <= {24'd0, pm_value[31:24]};
+          state          <= C_CMD;
+        end
+        C_CMD: begin
+          HOST_WRITE_EN  <= 1'b1;
+          HOST_ADDR_REG  <= cmd_reg;
+          HOST_DATA_IN   <= {24'd0, pm_code};
+          state          <= C_WAIT_BSY;
+        end
+        C_WAIT_BSY: begin                                            // command write sets BSY in the next clock
+          HOST_READ_EN   <= 1'b1;
+          HOST_ADDR_REG  <= stuts_reg;
+          pm_value[31:0] <= 32'd0;
+          cmd_timer      <= 32'd0;
+          state          <= C_POLL;
+        end
+        C_POLL: begin
+          timer          <= timer + 1'b1;
+          cmd_timer      <= cmd_timer + 1'b1;
+          if(!LINKUP || cmd_timer == CMD_TIMEOUT) begin
+            pm_fail        <= 1'b1;
+            HOST_READ_EN   <= 1'b0;
+            state          <= ret_state;
+          end
+          else if(!HOST_DATA_OUT[7]) begin
+            if(HOST_DATA_OUT[0]) begin
+              pm_fail        <= 1'b1;
+              HOST_READ_EN   <= 1'b0;
+              state          <= ret_state;
+            end
+            else if(pm_code == READ_PM) begin
+              HOST_ADDR_REG  <= sect_count;
+              state          <= C_RD_COUNT;
+            end
+            else begin
+              HOST_READ_EN   <= 1'b0;
+              state          <= ret_state;
+            end
+          end
+        end
+        C_RD_COUNT: begin
+          pm_value[7:0]  <= HOST_DATA_OUT[7:0];
+          HOST_ADDR_REG  <= lba_low;
+          state          <= C_RD_LOW;
+        end
+        C_RD_LOW: begin
+          pm_value[15:8] <= HOST_DATA_OUT[7:0];
+          HOST_ADDR_REG  <= lba_mid;
+          state          <= C_RD_MID;
+        end
+        C_RD_MID: begin
+          pm_value[23:16]<= HOST_DATA_OUT[7:0];
+          HOST_ADDR_REG  <= lba_high;
+          state          <= C_RD_HIGH;
+        end
+        C_RD_HIGH: begin
+          pm_value[31:24]<= HOST_DATA_OUT[7:0];
+          HOST_READ_EN   <= 1'b0;
+          state          <= ret_state;
+        end
+        default: begin
+          state          <= IDLE;
+        end
+      endcase
+    end
+  end
+
+endmodule
@@ -0,0 +1,314 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : Stream playback
+//  File name   : stream_playback.v
+//  Note        : Read side twin of STREAM_RECORDER. Reads an LBA range
+//                with READ DMA EXT commands through SATA_CMD_ISSUE, moves
+//                the data from the controller RX FIFO into a dual clock
+//                block RAM ring and plays it out on an AXI-Stream master.
+//                A new command is requested as soon as the ring has room
+//                for it (read ahead), the stream starts after the first
+//                command completed. PB_LOOP replays the range until
+//                PB_STOP. The optional rate limiter lets PB_RATE_BYTES
+//                bytes out every PB_RATE_CLOCKS stream clocks. Clocks in
+//                which the sink was ready but the ring was empty are
+//                counted in PB_UNDERRUN_COUNT. TLAST marks the last word
+//                of each pass through the range.
+//                CLK is the controller clock (CLK_OUT), DMA_CLK_IN of
+//                SATA_CONTROLLER must be driven by the same clock and
+//                DMA_RQST held at 1.
+//                PB_START_LBA / PB_LENGTH / PB_LOOP and the rate settings
+//                must be stable while PB_BUSY is high.
+//  Design ref. : -
+//  Dependencies   : sata_async_fifo, SATA_CMD_ISSUE
+//////////////////////////////////////////////////////////////////////////////
+
+module STREAM_PLAYBACK #(
+    parameter         BUF_ADDR_WIDTH  = 15,          // ring depth 2**BUF_ADDR_WIDTH words (128KB)
+    parameter [15:0]  MAX_CMD_SECTORS = 16'd128      // sectors per read command, MAX_CMD_SECTORS*128 <= ring depth
+    )
+    (
+    input                          CLK,              // controller clock
+    input                          RESET,
+
+    // control / status, CLK domain
+    input                          PB_START,         // pulse, starts playback at PB_START_LBA
+    input                          PB_STOP,          // pulse, no new commands, buffered data is still played out
+    input       [47:0]             PB_START_LBA,
+    input       [47:0]             PB_LENGTH,        // range length in sectors
+    input                          PB_LOOP,          // 1 : replay the range until PB_STOP
+    output reg                     PB_BUSY,
+    output reg                     PB_DONE,          // one clock pulse, range read and ring empty
+    output reg                     PB_ERROR,         // a read command ended with an error, playback aborted
+    output reg  [7:0]              PB_ERR_STATUS,    // ending status of the failing command
+    output reg  [47:0]             PB_LBA,           // next LBA to be read
+    output reg  [31:0]             PB_LOOP_COUNT,    // completed passes through the range
+
+    // stream output and stream side settings / status, M_AXIS_ACLK domain
+    input                          M_AXIS_ACLK,
+    output      [31:0]             M_AXIS_TDATA,
+    output                         M_AXIS_TVALID,
+    input                          M_AXIS_TREADY,
+    output                         M_AXIS_TLAST,
+    input                          PB_RATE_EN,       // 1 : rate limiter on
+    input       [15:0]             PB_RATE_BYTES,    // bytes allowed ...
+    input       [15:0]             PB_RATE_CLOCKS,   // ... per this many M_AXIS_ACLK clocks
+    output reg  [31:0]             PB_UNDERRUN_COUNT,
+
+    // to SATA_CMD_ISSUE
+    output reg                     CMD_REQ,
+    input                          CMD_READY,
+    output      [7:0]              CMD_CODE,
+    output      [15:0]             CMD_FEATURES,
+    output reg  [47:0]             CMD_LBA,
+    output reg  [15:0]             CMD_SECTORS,
+    input                          CMD_DONE,
+    input                          CMD_ERROR,
+    input       [7:0]              CMD_STATUS,
+
+    // from SATA_CONTROLLER DMA read port
+    input       [31:0]             DMA_RX_DATA_OUT,
+    output                         DMA_RX_REN,
+    input                          READ_HOLD_U
+    );
+
+  parameter  P_IDLE        = 2'h0;
+  parameter  P_NEXT_CMD    = 2'h1;
+  parameter  P_ISSUE       = 2'h2;
+  parameter  P_CMD_WAIT    = 2'h3;
+
+  parameter  READ_DMA_EXT  = 8'h25;
+
+  localparam DEPTH         = (1 << BUF_ADDR_WIDTH);
+
+  reg   [1:0]               state;
+  reg                       play_en;                // CLK domain : stream output enabled
+  reg                       stopping;
+  reg                       range_end;              // no more commands to issue
+  reg   [47:0]              region_left;            // sectors left up to the end of the range
+  reg   [23:0]              inflight_words;         // words of issued commands not yet in the ring
+
+  wire  [15:0]              cmd_sectors;
+  wire  [22:0]              cmd_words;
+  wire  [23:0]              ring_used;
+  wire                      ring_full;
+  wire                      ring_empty;
+  wire  [BUF_ADDR_WIDTH:0]  ring_wr_count;
+  wire  [BUF_ADDR_WIDTH:0]  ring_rd_count;
+  wire                      ring_rd_en;
+
+  // stream side
+  reg                       play_s1, play_s2, play_s3;
+  reg                       more_s1, more_s2;       // more data is on its way, an empty ring is an underrun
+  reg   [15:0]              rate_clk_count;
+  reg   [17:0]              rate_credit;            // bytes
+  reg   [54:0]              pass_words;
+  wire                      rate_ok;
+  wire                      rate_tick;
+  wire                      stream_rd;
+  wire  [17:0]              credit_max;
+
+  assign CMD_CODE       = READ_DMA_EXT;
+  assign CMD_FEATURES   = 16'd0;
+
+  assign cmd_sectors    = (region_left < MAX_CMD_SECTORS) ? region_left[15:0] : MAX_CMD_SECTORS;
+  assign cmd_words      = {cmd_sectors, 7'd0};
+  assign ring_used      = ring_wr_count + inflight_words;
+
+  //******************************** command sequencing ********************************
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      state           <= P_IDLE;
+      play_en         <= 1'b0;
+      stopping        <= 1'b0;
+      range_end       <= 1'b0;
+      region_left     <= 48'd0;
+      inflight_words  <= 24'd0;
+      CMD_REQ         <= 1'b0;
+      CMD_LBA         <= 48'd0;
+      CMD_SECTORS     <= 16'd0;
+      PB_BUSY         <= 1'b0;
+      PB_DONE         <= 1'b0;
+      PB_ERROR        <= 1'b0;
+      PB_ERR_STATUS   <= 8'd0;
+      PB_LBA          <= 48'd0;
+      PB_LOOP_COUNT   <= 32'd0;
+    end
+    else begin
+      PB_DONE         <= 1'b0;
+
+      if(PB_STOP && PB_BUSY) begin
+        stopping      <= 1'b1;
+      end
+
+      if(state == P_ISSUE && CMD_REQ && CMD_READY) begin
+        inflight_words <= inflight_words + cmd_words - DMA_RX_REN;
+      end
+      else if(DMA_RX_REN) begin
+        inflight_words <= inflight_words - 1'b1;
+      end
+
+      case(state)
+        P_IDLE: begin
+          if(PB_START) begin
+            PB_BUSY         <= 1'b1;
+            PB_ERROR        <= 1'b0;
+            PB_LOOP_COUNT   <= 32'd0;
+            PB_LBA          <= PB_START_LBA;
+            region_left     <= PB_LENGTH;
+            stopping        <= 1'b0;
+            range_end       <= (PB_LENGTH == 48'd0);
+            inflight_words  <= 24'd0;
+            state           <= P_NEXT_CMD;
+          end
+        end
+        P_NEXT_CMD: begin
+          if(range_end || stopping) begin
+            if(inflight_words == 24'd0 && ring_wr_count == 'd0) begin
+              PB_BUSY         <= 1'b0;
+              PB_DONE         <= 1'b1;
+              play_en         <= 1'b0;
+              state           <= P_IDLE;
+            end
+          end
+          else if(ring_used + cmd_words <= DEPTH) begin
+            CMD_LBA         <= PB_LBA;
+            CMD_SECTORS     <= cmd_sectors;
+            state           <= P_ISSUE;
+          end
+        end
+        P_ISSUE: begin
+          CMD_REQ           <= 1'b1;
+          if(CMD_REQ && CMD_READY) begin
+            CMD_REQ         <= 1'b0;
+            state           <= P_CMD_WAIT;
+          end
+        end
+        P_CMD_WAIT: begin
+          if(CMD_DONE) begin
+            if(CMD_ERROR) begin
+              PB_ERROR        <= 1'b1;
+              PB_ERR_STATUS   <= CMD_STATUS;
+              PB_BUSY         <= 1'b0;
+              PB_DONE         <= 1'b1;
+              play_en         <= 1'b0;
+              state           <= P_IDLE;
+            end
+            else begin
+              play_en         <= 1'b1;                  // read ahead of one command before the stream starts
+              if(region_left == CMD_SECTORS) begin
+                PB_LOOP_COUNT   <= PB_LOOP_COUNT + 1'b1;
+                if(PB_LOOP) begin
+                  PB_LBA          <= PB_START_LBA;
+                  region_left     <= PB_LENGTH;
+                end
+                else begin
+                  PB_LBA          <= PB_LBA + CMD_SECTORS;
+                  region_left     <= 48'd0;
+                  range_end       <= 1'b1;
+                end
+              end
+              else begin
+                PB_LBA          <= PB_LBA + CMD_SECTORS;
+                region_left     <= region_left - CMD_SECTORS;
+              end
+              state           <= P_NEXT_CMD;
+            end
+          end
+        end
+        default: begin
+          state             <= P_IDLE;
+        end
+      endcase
+    end
+  end
+
+  // RX FIFO to ring, the ring always has room for the words of issued commands
+  assign DMA_RX_REN     = !READ_HOLD_U && !ring_full;
+
+  //******************************** stream side ***************************************
+  assign credit_max     = {PB_RATE_BYTES, 1'b0};
+  assign rate_tick      = (rate_clk_count == PB_RATE_CLOCKS - 1'b1) || (PB_RATE_CLOCKS == 16'd0);
+  assign rate_ok        = !PB_RATE_EN || (rate_credit >= 18'd4);
+  assign M_AXIS_TVALID  = play_s2 && !ring_empty && rate_ok;
+  assign M_AXIS_TLAST   = (pass_words == {PB_LENGTH, 7'd0} - 1'b1);
+  assign stream_rd      = M_AXIS_TVALID && M_AXIS_TREADY;
+  assign ring_rd_en     = stream_rd;
+
+  always @(posedge M_AXIS_ACLK, posedge RESET)
+  begin
+    if(RESET) begin
+      play_s1           <= 1'b0;
+      play_s2           <= 1'b0;
+      play_s3           <= 1'b0;
+      more_s1           <= 1'b0;
+      more_s2           <= 1'b0;
+      rate_clk_count    <= 16'd0;
+      rate_credit       <= 18'd0;
+      pass_words        <= 55'd0;
+      PB_UNDERRUN_COUNT <= 32'd0;
+    end
+    else begin
+      play_s1           <= play_en;
+      play_s2           <= play_s1;
+      play_s3           <= play_s2;
+      more_s1           <= play_en && !range_end && !stopping;
+      more_s2           <= more_s1;
+
+      // token bucket, at most two periods worth of credit
+      if(rate_tick) begin
+        rate_clk_count  <= 16'd0;
+      end
+      else begin
+        rate_clk_count  <= rate_clk_count + 1'b1;
+      end
+      if(!play_s2) begin
+        rate_credit     <= 18'd0;
+      end
+      else if(rate_tick) begin
+        if(rate_credit + PB_RATE_BYTES - (stream_rd ? 18'd4 : 18'd0) > credit_max)
+          rate_credit   <= credit_max;
+        else
+          rate_credit   <= rate_credit + PB_RATE_BYTES - (stream_rd ? 18'd4 : 18'd0);
+      end
+      else if(stream_rd && PB_RATE_EN) begin
+        rate_credit     <= rate_credit - 18'd4;
+      end
+
+      if(play_s2 && !play_s3) begin                     // new playback
+        pass_words        <= 55'd0;
+        PB_UNDERRUN_COUNT <= 32'd0;
+      end
+      else begin
+        if(stream_rd) begin
+          pass_words      <= M_AXIS_TLAST ? 55'd0 : pass_words + 1'b1;
+        end
+        if(more_s2 && ring_empty && rate_ok && M_AXIS_TREADY) begin
+          PB_UNDERRUN_COUNT <= PB_UNDERRUN_COUNT + 1'b1;
+        end
+      end
+    end
+  end
+
+  sata_async_fifo #(
+    .DATA_WIDTH   (32),
+    .ADDR_WIDTH   (BUF_ADDR_WIDTH)
+    )
+  RING_BUFFER
+    (
+    .rst          (RESET),
+    .wr_clk       (CLK),
+    .wr_en        (DMA_RX_REN),
+    .din          (DMA_RX_DATA_OUT),
+    .full         (ring_full),
+    .wr_count     (ring_wr_count),
+    .rd_clk       (M_AXIS_ACLK),
+    .rd_en        (ring_rd_en),
+    .dout         (M_AXIS_TDATA),
+    .empty        (ring_empty),
+    .rd_count     (ring_rd_count)
+    );
+
+endmodule
@@ -0,0 +1,302 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : Stream recorder
+//  File name   : stream_recorder.v
+//  Note        : Records a continuous AXI-Stream to disk. Words are
+//                buffered in a dual clock block RAM ring; every time one
+//                command worth of data is buffered a WRITE DMA EXT is
+//                requested from SATA_CMD_ISSUE and the data is pumped into
+//                the controller TX FIFO. The LBA advances by itself and, in
+//                ring mode, wraps back to REC_START_LBA after REC_LENGTH
+//                sectors. The stream is never back pressured: words that
+//                find the ring full are dropped and counted, so
+//                REC_OVERFLOW only comes up when the disk really cannot
+//                keep up. REC_MIN_HEADROOM keeps the lowest free ring space
+//                seen during the recording for margin sizing.
+//                CLK is the controller clock (CLK_OUT), DMA_CLK_IN of
+//                SATA_CONTROLLER must be driven by the same clock and
+//                DMA_RQST held at 1.
+//                REC_START_LBA / REC_LENGTH / REC_RING must be stable while
+//                REC_BUSY is high.
+//  Design ref. : -
+//  Dependencies   : sata_async_fifo, SATA_CMD_ISSUE
+//////////////////////////////////////////////////////////////////////////////
+
+module STREAM_RECORDER #(
+    parameter         BUF_ADDR_WIDTH  = 15,          // ring depth 2**BUF_ADDR_WIDTH words (128KB)
+    parameter [15:0]  MAX_CMD_SECTORS = 16'd128      // sectors per write command, MAX_CMD_SECTORS*128 <= ring depth
+    )
+    (
+    input                          CLK,              // controller clock
+    input                          RESET,
+
+    // control / status, CLK domain
+    input                          REC_START,        // pulse, starts a recording at REC_START_LBA
+    input                          REC_STOP,         // pulse, stops taking stream data and flushes the ring
+    input       [47:0]             REC_START_LBA,
+    input       [47:0]             REC_LENGTH,       // recording length (linear) or ring size (REC_RING) in sectors
+    input                          REC_RING,         // 1 : wrap to REC_START_LBA after REC_LENGTH sectors
+    output reg                     REC_BUSY,
+    output reg                     REC_DONE,         // one clock pulse at the end of the recording
+    output reg                     REC_ERROR,        // a write command ended with an error, recording aborted
+    output reg  [7:0]              REC_ERR_STATUS,   // ending status of the failing command
+    output reg  [47:0]             REC_LBA,          // next LBA to be written
+    output reg  [31:0]             REC_WRAP_COUNT,   // number of ring wraps
+
+    // stream input and stream side status, S_AXIS_ACLK domain
+    input                          S_AXIS_ACLK,
+    input       [31:0]             S_AXIS_TDATA,
+    input                          S_AXIS_TVALID,
+    output                         S_AXIS_TREADY,
+    output reg                     REC_OVERFLOW,     // sticky, set when a word was dropped
+    output reg  [31:0]             REC_DROP_COUNT,   // number of dropped words
+    output reg  [BUF_ADDR_WIDTH:0] REC_MIN_HEADROOM, // lowest free ring space seen, in words
+
+    // to SATA_CMD_ISSUE
+    output reg                     CMD_REQ,
+    input                          CMD_READY,
+    output      [7:0]              CMD_CODE,
+    output      [15:0]             CMD_FEATURES,
+    output reg  [47:0]             CMD_LBA,
+    output reg  [15:0]             CMD_SECTORS,
+    input                          CMD_DONE,
+    input                          CMD_ERROR,
+    input       [7:0]              CMD_STATUS,
+
+    // to SATA_CONTROLLER DMA write port
+    output      [31:0]             DMA_TX_DATA_IN,
+    output                         DMA_TX_WEN,
+    input                          WRITE_HOLD_U
+    );
+
+  parameter  R_IDLE        = 2'h0;
+  parameter  R_WAIT_DATA   = 2'h1;
+  parameter  R_ISSUE       = 2'h2;
+  parameter  R_CMD_WAIT    = 2'h3;
+
+  parameter  WRITE_DMA_EXT = 8'h35;
+
+  localparam DEPTH         = (1 << BUF_ADDR_WIDTH);
+
+  reg   [1:0]               state;
+  reg                       accept_en;              // CLK domain : ring takes stream data
+  reg                       stopping;
+  reg   [4:0]               stop_count;
+  reg   [47:0]              region_left;            // sectors left up to the end of the region
+  reg   [22:0]              pump_left;              // words still to be written to TX FIFO for this command
+  reg   [22:0]              pump_data_left;         // of which taken from the ring, the rest is zero padding
+
+  wire  [15:0]              cmd_sectors;
+  wire  [22:0]              cmd_words;
+  wire  [22:0]              buf_words;
+  wire  [22:0]              flush_sectors;
+  wire                      flush;
+  wire  [31:0]              ring_dout;
+  wire                      ring_empty;
+  wire                      ring_full;
+  wire  [BUF_ADDR_WIDTH:0]  ring_rd_count;
+  wire  [BUF_ADDR_WIDTH:0]  ring_wr_count;
+  wire                      ring_rd_en;
+
+  // stream side
+  reg                       accept_s1, accept_s2, accept_s3;
+  reg   [54:0]              stream_words;
+  wire                      stream_limit;
+  wire                      stream_en;
+  wire                      stream_wr;
+  wire  [BUF_ADDR_WIDTH:0]  ring_free;
+
+  assign CMD_CODE       = WRITE_DMA_EXT;
+  assign CMD_FEATURES   = 16'd0;
+
+  assign cmd_sectors    = (region_left < MAX_CMD_SECTORS) ? region_left[15:0] : MAX_CMD_SECTORS;
+  assign cmd_words      = {cmd_sectors, 7'd0};
+  assign buf_words      = ring_rd_count;
+  assign flush_sectors  = (buf_words + 23'd127) >> 7;   // last, partial command padded up to a sector
+  assign flush          = stopping && (stop_count == 5'h1F);
+
+  //******************************** command sequencing ********************************
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      state           <= R_IDLE;
+      accept_en       <= 1'b0;
+      stopping        <= 1'b0;
+      stop_count      <= 5'd0;
+      region_left     <= 48'd0;
+      pump_left       <= 23'd0;
+      pump_data_left  <= 23'd0;
+      CMD_REQ         <= 1'b0;
+      CMD_LBA         <= 48'd0;
+      CMD_SECTORS     <= 16'd0;
+      REC_BUSY        <= 1'b0;
+      REC_DONE        <= 1'b0;
+      REC_ERROR       <= 1'b0;
+      REC_ERR_STATUS  <= 8'd0;
+      REC_LBA         <= 48'd0;
+      REC_WRAP_COUNT  <= 32'd0;
+    end
+    else begin
+      REC_DONE        <= 1'b0;
+
+      // stream data reaches ring read side a few clocks after the stop
+      if(stopping && stop_count != 5'h1F) begin
+        stop_count    <= stop_count + 1'b1;
+      end
+      if(REC_STOP && REC_BUSY) begin
+        accept_en     <= 1'b0;
+        stopping      <= 1'b1;
+      end
+
+      // ring to TX FIFO pump, zero padding after the ring data
+      if(DMA_TX_WEN) begin
+        pump_left     <= pump_left - 1'b1;
+        if(pump_data_left != 23'd0) begin
+          pump_data_left <= pump_data_left - 1'b1;
+        end
+      end
+
+      case(state)
+        R_IDLE: begin
+          if(REC_START) begin
+            REC_BUSY        <= 1'b1;
+            REC_ERROR       <= 1'b0;
+            REC_WRAP_COUNT  <= 32'd0;
+            REC_LBA         <= REC_START_LBA;
+            region_left     <= REC_LENGTH;
+            accept_en       <= 1'b1;
+            stopping        <= 1'b0;
+            stop_count      <= 5'd0;
+            state           <= R_WAIT_DATA;
+          end
+        end
+        R_WAIT_DATA: begin
+          if(region_left == 48'd0 || (flush && buf_words == 23'd0)) begin
+            REC_BUSY        <= 1'b0;
+            REC_DONE        <= 1'b1;
+            accept_en       <= 1'b0;
+            state           <= R_IDLE;
+          end
+          else if(buf_words >= cmd_words) begin
+            CMD_LBA         <= REC_LBA;
+            CMD_SECTORS     <= cmd_sectors;
+            pump_left       <= cmd_words;
+            pump_data_left  <= cmd_words;
+            state           <= R_ISSUE;
+          end
+          else if(flush) begin
+            CMD_LBA         <= REC_LBA;
+            CMD_SECTORS     <= flush_sectors[15:0];
+            pump_left       <= {flush_sectors[15:0], 7'd0};
+            pump_data_left  <= buf_words;
+            state           <= R_ISSUE;
+          end
+        end
+        R_ISSUE: begin
+          CMD_REQ           <= 1'b1;
+          if(CMD_REQ && CMD_READY) begin
+            CMD_REQ         <= 1'b0;
+            state           <= R_CMD_WAIT;
+          end
+        end
+        R_CMD_WAIT: begin
+          if(CMD_DONE) begin
+            if(CMD_ERROR) begin
+              REC_ERROR       <= 1'b1;
+              REC_ERR_STATUS  <= CMD_STATUS;
+              REC_BUSY        <= 1'b0;
+              REC_DONE        <= 1'b1;
+              accept_en       <= 1'b0;
+              pump_left       <= 23'd0;
+              pump_data_left  <= 23'd0;
+              state           <= R_IDLE;
+            end
+            else begin
+              if(region_left == CMD_SECTORS && REC_RING) begin
+                REC_LBA         <= REC_START_LBA;
+                region_left     <= REC_LENGTH;
+                REC_WRAP_COUNT  <= REC_WRAP_COUNT + 1'b1;
+              end
+              else begin
+                REC_LBA         <= REC_LBA + CMD_SECTORS;
+                region_left     <= region_left - CMD_SECTORS;
+              end
+              state           <= R_WAIT_DATA;
+            end
+          end
+        end
+        default: begin
+          state             <= R_IDLE;
+        end
+      endcase
+    end
+  end
+
+  assign DMA_TX_WEN     = (pump_left != 23'd0) && !WRITE_HOLD_U && (pump_data_left == 23'd0 || !ring_empty);
+  assign DMA_TX_DATA_IN = (pump_data_left != 23'd0) ? ring_dout : 32'd0;
+  assign ring_rd_en     = DMA_TX_WEN && (pump_data_left != 23'd0);
+
+  //******************************** stream side ***************************************
+  assign stream_limit   = !REC_RING && (stream_words == {REC_LENGTH, 7'd0});
+  assign stream_en      = accept_s2 && !stream_limit;
+  assign S_AXIS_TREADY  = stream_en;
+  assign stream_wr      = stream_en && S_AXIS_TVALID;
+  assign ring_free      = DEPTH - ring_wr_count;
+
+  always @(posedge S_AXIS_ACLK, posedge RESET)
+  begin
+    if(RESET) begin
+      accept_s1         <= 1'b0;
+      accept_s2         <= 1'b0;
+      accept_s3         <= 1'b0;
+      stream_words      <= 55'd0;
+      REC_OVERFLOW      <= 1'b0;
+      REC_DROP_COUNT    <= 32'd0;
+      REC_MIN_HEADROOM  <= DEPTH;
+    end
+    else begin
+      accept_s1         <= accept_en;
+      accept_s2         <= accept_s1;
+      accept_s3         <= accept_s2;
+      if(accept_s2 && !accept_s3) begin                 // new recording
+        stream_words      <= 55'd0;
+        REC_OVERFLOW      <= 1'b0;
+        REC_DROP_COUNT    <= 32'd0;
+        REC_MIN_HEADROOM  <= DEPTH;
+      end
+      else begin
+        if(stream_wr && ring_full) begin
+          REC_OVERFLOW    <= 1'b1;
+          REC_DROP_COUNT  <= REC_DROP_COUNT + 1'b1;
+        end
+        else if(stream_wr) begin
+          stream_words    <= stream_words + 1'b1;
+        end
+        if(accept_s2 && ring_free < REC_MIN_HEADROOM) begin
+          REC_MIN_HEADROOM <= ring_free;
+        end
+      end
+    end
+  end
+
+  sata_async_fifo #(
+    .DATA_WIDTH   (32),
+    .ADDR_WIDTH   (BUF_ADDR_WIDTH)
+    )
+  RING_BUFFER
+    (
+    .rst          (RESET),
+    .wr_clk       (S_AXIS_ACLK),
+    .wr_en        (stream_wr),
+    .din          (S_AXIS_TDATA),
+    .full         (ring_full),
+    .wr_count     (ring_wr_count),
+    .rd_clk       (CLK),
+    .rd_en        (ring_rd_en),
+    .dout         (ring_dout),
+    .empty        (ring_empty),
+    .rd_count     (ring_rd_count)
+    );
+
+endmodule
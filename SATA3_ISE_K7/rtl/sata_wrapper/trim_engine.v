@@ -0,0 +1,252 @@
+`timescale 1ns / 1ps
+//////////////////////////////////////////////////////////////////////////////
+//  Project     : SATA Host controller
+//  Title       : TRIM (DATA SET MANAGEMENT) engine
+//  File name   : trim_engine.v
+//  Note        : Freed LBA ranges are pushed into a range FIFO (TRIM_WEN).
+//                The packer splits them into range entries of at most
+//                65535 sectors and fills a 512 byte block of 64 entries :
+//                  Dword 2n   : LBA[31:0]
+//                  Dword 2n+1 : {range length[15:0], LBA[47:32]}
+//                A block is sent when it is full, on TRIM_FLUSH, or when
+//                the FIFO stayed empty for FLUSH_DELAY clocks; unused
+//                entries are zero (length 0 is ignored by the drive).
+//                Sending a block is DATA SET MANAGEMENT (06h, TRIM bit in
+//                features) with a count of one block, DMA out.
+//                Rate limiter : a block is only sent when FG_BUSY is low
+//                and at least TRIM_GAP clocks passed since the previous
+//                DSM ended, so trimming runs in the gaps of foreground
+//                I/O. The CMD_* and DMA_TX_* ports are meant to be muxed
+//                with the foreground engine on TRIM_ACTIVE.
+//                All ports are in the controller clock (CLK_OUT) domain,
+//                DMA_CLK_IN of SATA_CONTROLLER must be driven by the same
+//                clock and DMA_RQST held at 1.
+//  Design ref. : ATA8-ACS DATA SET MANAGEMENT
+//  Dependencies   : SATA_CMD_ISSUE
+//////////////////////////////////////////////////////////////////////////////
+
+module TRIM_ENGINE #(
+    parameter        RANGE_ADDR_WIDTH = 4,                 // range FIFO depth 2**RANGE_ADDR_WIDTH
+    parameter        FLUSH_DELAY      = 32'd1_500_000      // partial block flush, 10 ms at 150 MHz
+    )
+    (
+    input                CLK,                      // controller clock
+    input                RESET,
+
+    // freed ranges
+    input                TRIM_WEN,
+    input       [47:0]   TRIM_LBA,
+    input       [31:0]   TRIM_COUNT,               // sectors, split into 65535 sector entries
+    output               TRIM_FULL,
+    input                TRIM_FLUSH,               // send the partial block now
+
+    // rate limiter / status
+    input                FG_BUSY,                  // foreground I/O pending, hold off
+    input       [31:0]   TRIM_GAP,                 // minimum idle clocks between DSM commands
+    output reg           TRIM_ACTIVE,              // engine owns the CMD_* and DMA_TX_* ports
+    output               TRIM_IDLE,                // nothing queued or packed
+    output reg  [31:0]   TRIM_CMDS,                // DSM commands completed
+    output reg           TRIM_ERROR,               // a DSM command failed, cleared by reset
+
+    // to SATA_CMD_ISSUE
+    output reg           CMD_REQ,
+    input                CMD_READY,
+    output      [7:0]    CMD_CODE,
+    output      [15:0]   CMD_FEATURES,
+    output      [47:0]   CMD_LBA,
+    output      [15:0]   CMD_SECTORS,
+    input                CMD_DONE,
+    input                CMD_ERROR,
+
+    // to SATA_CONTROLLER DMA write port
+    output      [31:0]   DMA_TX_DATA_IN,
+    output               DMA_TX_WEN,
+    input                WRITE_HOLD_U
+    );
+
+  parameter  T_FETCH       = 4'h0;
+  parameter  T_PACK_LO     = 4'h1;
+  parameter  T_PACK_HI     = 4'h2;
+  parameter  T_PAD         = 4'h3;
+  parameter  T_GAP         = 4'h4;
+  parameter  T_PUSH        = 4'h5;
+  parameter  T_ISSUE       = 4'h6;
+  parameter  T_CMD_WAIT    = 4'h7;
+
+  parameter  DATA_SET_MGMT = 8'h06;
+
+  // range FIFO
+  reg   [47:0]                 rq_lba [0:(1<<RANGE_ADDR_WIDTH)-1];
+  reg   [31:0]                 rq_cnt [0:(1<<RANGE_ADDR_WIDTH)-1];
+  reg   [RANGE_ADDR_WIDTH:0]   rq_wr_ptr;
+  reg   [RANGE_ADDR_WIDTH:0]   rq_rd_ptr;
+  wire                         rq_empty;
+
+  // one 512 byte payload block
+  reg   [31:0]                 blk [0:127];
+  reg   [6:0]                  blk_addr;
+  wire                         blk_wen;
+  wire  [31:0]                 blk_din;
+
+  reg   [3:0]                  state;
+  reg   [47:0]                 cur_lba;
+  reg   [31:0]                 cur_cnt;
+  wire  [15:0]                 cur_len;
+  reg   [31:0]                 idle_timer;
+  reg   [31:0]                 gap_timer;
+  reg                          flush_req;
+
+  assign rq_empty       = (rq_wr_ptr == rq_rd_ptr);
+  assign TRIM_FULL      = (rq_wr_ptr[RANGE_ADDR_WIDTH] != rq_rd_ptr[RANGE_ADDR_WIDTH]) &&
+                          (rq_wr_ptr[RANGE_ADDR_WIDTH-1:0] == rq_rd_ptr[RANGE_ADDR_WIDTH-1:0]);
+  assign TRIM_IDLE      = rq_empty && (state == T_FETCH) && (blk_addr == 7'd0);
+  assign cur_len        = (cur_cnt > 32'd65535) ? 16'hFFFF : cur_cnt[15:0];
+
+  assign CMD_CODE       = DATA_SET_MGMT;
+  assign CMD_FEATURES   = 16'h0001;                // TRIM
+  assign CMD_LBA        = 48'd0;
+  assign CMD_SECTORS    = 16'd1;                   // one 512 byte block
+
+  assign DMA_TX_DATA_IN = blk[blk_addr];
+  assign DMA_TX_WEN     = (state == T_PUSH) && !WRITE_HOLD_U;
+
+  //******************************** range FIFO *****************************************
+  always @(posedge CLK)
+  begin
+    if(TRIM_WEN && !TRIM_FULL) begin
+      rq_lba[rq_wr_ptr[RANGE_ADDR_WIDTH-1:0]] <= TRIM_LBA;
+      rq_cnt[rq_wr_ptr[RANGE_ADDR_WIDTH-1:0]] <= TRIM_COUNT;
+    end
+  end
+
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      rq_wr_ptr      <= 'd0;
+    end
+    else if(TRIM_WEN && !TRIM_FULL && TRIM_COUNT != 32'd0) begin
+      rq_wr_ptr      <= rq_wr_ptr + 1'b1;
+    end
+  end
+
+  //******************************** block RAM ******************************************
+  assign blk_wen        = (state == T_PACK_LO) || (state == T_PACK_HI) || (state == T_PAD);
+  assign blk_din        = (state == T_PACK_LO) ? cur_lba[31:0] :
+                          (state == T_PACK_HI) ? {cur_len, cur_lba[47:32]} : 32'd0;
+
+  always @(posedge CLK)
+  begin
+    if(blk_wen) begin
+      blk[blk_addr]  <= blk_din;
+    end
+  end
+
+  //******************************** packer / sender ************************************
+  always @(posedge CLK, posedge RESET)
+  begin
+    if(RESET) begin
+      state          <= T_FETCH;
+      rq_rd_ptr      <= 'd0;
+      blk_addr       <= 7'd0;
+      cur_lba        <= 48'd0;
+      cur_cnt        <= 32'd0;
+      idle_timer     <= 32'd0;
+      gap_timer      <= 32'd0;
+      flush_req      <= 1'b0;
+      CMD_REQ        <= 1'b0;
+      TRIM_ACTIVE    <= 1'b0;
+      TRIM_CMDS      <= 32'd0;
+      TRIM_ERROR     <= 1'b0;
+    end
+    else begin
+      if(TRIM_FLUSH) begin
+        flush_req      <= 1'b1;
+      end
+      if(gap_timer != 32'hFFFF_FFFF) begin
+        gap_timer      <= gap_timer + 1'b1;
+      end
+      case(state)
+        T_FETCH: begin
+          if(!rq_empty) begin
+            cur_lba        <= rq_lba[rq_rd_ptr[RANGE_ADDR_WIDTH-1:0]];
+            cur_cnt        <= rq_cnt[rq_rd_ptr[RANGE_ADDR_WIDTH-1:0]];
+            rq_rd_ptr      <= rq_rd_ptr + 1'b1;
+            idle_timer     <= 32'd0;
+            state          <= T_PACK_LO;
+          end
+          else if(blk_addr != 7'd0) begin                // partial block waiting
+            idle_timer     <= idle_timer + 1'b1;
+            if(flush_req || idle_timer >= FLUSH_DELAY) begin
+              state          <= T_PAD;
+            end
+          end
+          else begin
+            flush_req      <= 1'b0;
+            idle_timer     <= 32'd0;
+          end
+        end
+        T_PACK_LO: begin                                 // entry LBA[31:0]
+          blk_addr       <= blk_addr + 1'b1;
+          state          <= T_PACK_HI;
+        end
+        T_PACK_HI: begin                                 // entry {length, LBA[47:32]}
+          blk_addr       <= blk_addr + 1'b1;
+          cur_lba        <= cur_lba + cur_len;
+          cur_cnt        <= cur_cnt - cur_len;
+          if(blk_addr == 7'd127) begin                   // block full, the rest of the range waits
+            state          <= T_GAP;
+          end
+          else if(cur_cnt == {16'd0, cur_len}) begin
+            state          <= T_FETCH;
+          end
+          else begin
+            state          <= T_PACK_LO;
+          end
+        end
+        T_PAD: begin                                     // zero entries up to the end of the block
+          blk_addr       <= blk_addr + 1'b1;
+          if(blk_addr == 7'd127) begin
+            state          <= T_GAP;
+          end
+        end
+        T_GAP: begin                                     // blk_addr is 0 here
+          flush_req      <= 1'b0;
+          if(!FG_BUSY && CMD_READY && gap_timer >= TRIM_GAP) begin
+            TRIM_ACTIVE    <= 1'b1;
+            state          <= T_PUSH;
+          end
+        end
+        T_PUSH: begin
+          if(!WRITE_HOLD_U) begin
+            blk_addr       <= blk_addr + 1'b1;
+            if(blk_addr == 7'd127) begin
+              state          <= T_ISSUE;
+            end
+          end
+        end
+        T_ISSUE: begin
+          CMD_REQ        <= 1'b1;
+          if(CMD_REQ && CMD_READY) begin
+            CMD_REQ        <= 1'b0;
+            state          <= T_CMD_WAIT;
+          end
+        end
+        T_CMD_WAIT: begin
+          if(CMD_DONE) begin
+            TRIM_ACTIVE    <= 1'b0;
+            TRIM_CMDS      <= TRIM_CMDS + 1'b1;
+            if(CMD_ERROR) begin
+              TRIM_ERROR     <= 1'b1;
+            end
+            gap_timer      <= 32'd0;
+            state          <= (cur_cnt != 32'd0) ? T_PACK_LO : T_FETCH;
+          end
+        end
+        default: begin
+          state          <= T_FETCH;
+        end
+      endcase
+    end
+  end
+
+endmodule
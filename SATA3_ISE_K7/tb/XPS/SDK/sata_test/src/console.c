@@ -30,6 +30,13 @@
 
 #define SECTOR_COUNT 128
 
+// test logic tuning registers
+#define REG_TX_PROG_FULL            (0x100030)     // 0 : build default
+#define REG_RX_PROG_FULL            (0x100034)     // 0 : build default
+#define REG_XFER_SECTORS            (0x100038)     // sectors per command, 1 - 128
+
+#define AUTOTUNE_BYTES              (0x4000000)    // 64 MB written and read back per run
+
 void PrintMessage(TyMessageType tyMessageType, const char * pszToFormat, ...);
 int GetCommand(char * pszCommand, unsigned short usMAxLength);
 void FilterInputString(char *pszInputString);
@@ -42,6 +49,8 @@ void TTest(void);
 void WriteData(void);
 void ReadData(char *pszParams);
 void Test(void);
+int TuneRun(u32 uTxFull, u32 uRxFull, u32 uSectors, u32 *puBytes, u64 *pullTime);
+void AutoTune(void);
 
 void RunConsole(void)
 {
@@ -149,6 +158,10 @@ void DoConsoleCommand(const char *pszCommandLine)
     {
     	Test();
     }
+    else if (!strcmp(pszParsedCommandLine,"AUTOTUNE"))
+    {
+    	AutoTune();
+    }
     else if (!strcmp(pszParsedCommandLine,"HELP"))
     {
     	xil_printf("\n\r READ        : read from read_address");
@@ -162,6 +175,8 @@ void DoConsoleCommand(const char *pszCommandLine)
 	    xil_printf("\n\r READDATA    : Reads data from 0x80002xxx memory");
 	    xil_printf("\n\r               Parameters [print] [compare]");
 	    xil_printf("\n\r               print = 1 for print data compare = 1 for compare");
+		xil_printf("\n\r AUTOTUNE    : Sweep transfer size and FIFO thresholds, keep the fastest");
+		xil_printf("\n\r               Parameters NIL");
 		xil_printf("\n\r HELP        : Diplay this help command");
 		xil_printf("\n\r               Parameters NIL");
     }
@@ -228,7 +243,7 @@ void TTest(void)
 	u32 expected_data_reg,read_data_reg;
 
 
-	const u32 SECTORS   = 128; //sectors per read/write
+	u32 SECTORS   = Xil_In32(SATA_BASEADDR + REG_XFER_SECTORS); //sectors per read/write
 	u32 cmd_complete;
 	u32 i;
 	u32 * initial_value = (u32 *)0x8010001C;
@@ -419,6 +434,138 @@ void TTest(void)
 	}
 }
 
+/****************************************************************************
+     Function: TuneRun
+        Input: u32 uTxFull, uRxFull : FIFO thresholds in Dwords (0 : default)
+               u32 uSectors         : sectors per command
+       Output: int - 1 run completed, 0 compare error, -1 time out
+               u32 *puBytes         : bytes written (and read back)
+               u64 *pullTime        : write + read time in MB clocks
+  Description: one write / read back test run with the given settings
+*****************************************************************************/
+int TuneRun(u32 uTxFull, u32 uRxFull, u32 uSectors, u32 *puBytes, u64 *pullTime)
+{
+	u32 status_reg, timer_status, iterations;
+	u64 write_count, read_count;
+
+	iterations = AUTOTUNE_BYTES / (uSectors * 512);
+
+	Xil_Out32(SATA_BASEADDR + REG_TX_PROG_FULL, uTxFull);
+	Xil_Out32(SATA_BASEADDR + REG_RX_PROG_FULL, uRxFull);
+	Xil_Out32(SATA_BASEADDR + REG_XFER_SECTORS, uSectors);
+	Xil_Out32(SATA_BASEADDR + (0x100000), iterations);
+	Xil_Out32(SATA_BASEADDR + (0x100004), 0x1);
+
+	// one timer period is far longer than a run
+	Xil_Out32(XPS_TIMER_BASEADDR + (0),0x120); // To disable timer and interrupt
+	Xil_Out32(XPS_TIMER_BASEADDR + (4),0);     // Load value 0
+	Xil_Out32(XPS_TIMER_BASEADDR + (0),0x4c0); // To enable timer and interrupt
+	do
+	{
+		status_reg = Xil_In32(SATA_BASEADDR + (0x100008));
+		timer_status = Xil_In32(XPS_TIMER_BASEADDR + (0));
+	}while(((status_reg & 0x1) == 0x1) && ((timer_status & 0x100) == 0));
+	Xil_Out32(XPS_TIMER_BASEADDR + (0),0x120);
+	Xil_Out32(XPS_TIMER_BASEADDR + (4),0);
+
+	if ((status_reg & 0x1) == 0x1)
+	{
+		xil_printf("time out, status reg.: 0x%x", status_reg);
+		return -1;
+	}
+	if (((status_reg & 0x2) == 0x2) || ((Xil_In32(SATA_BASEADDR + (0x100018)) & 0x1) == 0))
+	{
+		xil_printf("compare error, status reg.: 0x%x", status_reg);
+		return 0;
+	}
+
+	write_count = Xil_In32(SATA_BASEADDR + (0x100010));
+	write_count = (write_count << 32) | Xil_In32(SATA_BASEADDR + (0x10000C));
+	read_count  = Xil_In32(SATA_BASEADDR + (0x100024));
+	read_count  = (read_count << 32) | Xil_In32(SATA_BASEADDR + (0x100020));
+
+	*puBytes  = iterations * uSectors * 512;
+	*pullTime = write_count + read_count;
+	return 1;
+}
+
+/****************************************************************************
+     Function: AutoTune
+       Output: none
+  Description: sweeps the sectors per command, then the TX and then the RX
+               FIFO threshold, one parameter at a time with the best values
+               found so far, and leaves the fastest setting in the test logic
+               registers. The thresholds assume the default 2048 Dword
+               transport FIFOs (FIFO_AWIDTH = 11).
+*****************************************************************************/
+void AutoTune(void)
+{
+	static const u32 auSectors[] = {16, 32, 64, 128};
+	static const u32 auTxFull[]  = {0, 256, 512, 1024, 1536};
+	static const u32 auRxFull[]  = {0, 256, 512, 1024, 1536};
+	u32 uBestTx = 0, uBestRx = 0, uBestSectors = 128;
+	u32 uBestBytes = 0, uBytes, uPass, i, uCount, uTx, uRx, uSectors;
+	int iResult;
+	u64 ullBestTime = 0, ullTime;
+	u32 uSavedIterations = Xil_In32(SATA_BASEADDR + (0x100000));
+	const u32 *puValues;
+
+	xil_printf("\n\r Auto tune, %d MB per run", AUTOTUNE_BYTES >> 20);
+
+	for (uPass = 0; uPass < 3; uPass++)
+	{
+		puValues = (uPass == 0) ? auSectors : (uPass == 1) ? auTxFull : auRxFull;
+		uCount   = (uPass == 0) ? (sizeof(auSectors) / sizeof(u32)) :
+		           (uPass == 1) ? (sizeof(auTxFull) / sizeof(u32)) : (sizeof(auRxFull) / sizeof(u32));
+
+		for (i = 0; i < uCount; i++)
+		{
+			uSectors = (uPass == 0) ? puValues[i] : uBestSectors;
+			uTx      = (uPass == 1) ? puValues[i] : uBestTx;
+			uRx      = (uPass == 2) ? puValues[i] : uBestRx;
+
+			xil_printf("\n\r sectors %3d  tx_prog_full %4d  rx_prog_full %4d : ", uSectors, uTx, uRx);
+			iResult = TuneRun(uTx, uRx, uSectors, &uBytes, &ullTime);
+			if (iResult < 0)
+			{
+				// test logic still busy, registers can not be written any more
+				xil_printf("\n\r Auto tune aborted, reset the board");
+				return;
+			}
+			if ((iResult == 0) || (ullTime == 0))
+				continue;
+			xil_printf("%d MB/s", (u32)(((u64)uBytes * 400) / ullTime));   // 5 ns clock, written and read back
+
+			// bytes / time, compared by cross multiplication
+			if ((uBestBytes == 0) || ((u64)uBytes * ullBestTime > (u64)uBestBytes * ullTime))
+			{
+				uBestBytes   = uBytes;
+				ullBestTime  = ullTime;
+				uBestSectors = uSectors;
+				uBestTx      = uTx;
+				uBestRx      = uRx;
+			}
+		}
+	}
+
+	Xil_Out32(SATA_BASEADDR + (0x100000), uSavedIterations);
+	Xil_Out32(SATA_BASEADDR + REG_TX_PROG_FULL, uBestTx);
+	Xil_Out32(SATA_BASEADDR + REG_RX_PROG_FULL, uBestRx);
+	Xil_Out32(SATA_BASEADDR + REG_XFER_SECTORS, uBestSectors);
+
+	if (uBestBytes == 0)
+	{
+		xil_printf("\n\r Auto tune failed, no run completed");
+		return;
+	}
+	// kept until the next MicroBlaze reset, reapply with the WRITE commands below
+	xil_printf("\n\r Best: sectors %d  tx_prog_full %d  rx_prog_full %d",
+			uBestSectors, uBestTx, uBestRx);
+	xil_printf("\n\r   WRITE 0x%x %d", REG_XFER_SECTORS, uBestSectors);
+	xil_printf("\n\r   WRITE 0x%x %d", REG_TX_PROG_FULL, uBestTx);
+	xil_printf("\n\r   WRITE 0x%x %d", REG_RX_PROG_FULL, uBestRx);
+}
+
 void ReadRegisters(char *pszParams)
 {
 	unsigned long uladdress;
@@ -14,4 +14,6 @@
 #define SATA_BASEADDR 		XPAR_SATA_TEST_LOGIC_0_BASEADDR
 #define XPS_TIMER_BASEADDR 	XPAR_AXI_TIMER_0_BASEADDR
 
+#define DEV_READY_TIMEOUT	0x1000000
+
 #endif /* GLOBAL_H_ */
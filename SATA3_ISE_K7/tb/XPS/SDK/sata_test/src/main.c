@@ -51,11 +51,18 @@ int main()
     // show program title and version
     PrintTitleAndVersion();
 
-    //reset sata controller
+    //reset sata controller, hold it at least the original time, then
+    //until DEV_READY drops with the reset
     Xil_Out32(SATA_BASEADDR + (0),1);
     for (i=0 ; i < 0xFFFFF; i++);
+    for (i=0 ; (i < DEV_READY_TIMEOUT) && (Xil_In32(SATA_BASEADDR + (4)) & 1); i++);
     Xil_Out32(SATA_BASEADDR + (0),0);
 
+    //wait for link up and IDENTIFY DEVICE
+    for (i=0 ; (i < DEV_READY_TIMEOUT) && !(Xil_In32(SATA_BASEADDR + (4)) & 1); i++);
+    if (i == DEV_READY_TIMEOUT)
+    	xil_printf("No drive ready\n\r");
+
     RunConsole();
     return 0;
 }
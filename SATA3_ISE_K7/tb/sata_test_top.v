@@ -71,7 +71,12 @@ module sata_test_top(
   wire         usr_clock;
   wire         usr_reset;
   wire         wr_done;
+  wire         dev_ready;
   wire         sata_ctrl_reset_out;
+  wire [15:0]  tx_prog_full;
+  wire [15:0]  rx_prog_full;
+  wire [7:0]   xfer_sectors;
+  wire         buf_rx_alloc;
     
  /* always @(posedge fpga_0_clk_1_sys_clk_pin)
   begin
@@ -144,6 +149,11 @@ module sata_test_top(
     .WR_HOLD_OUT            (wr_hold_out),  
     .RD_HOLD_OUT            (rd_hold_out),
     .WR_DONE                (wr_done),
+    .DEV_READY              (dev_ready),
+    .TX_PROG_FULL           (tx_prog_full),         // to SATA_CONTROLLER TX_PROG_FULL
+    .RX_PROG_FULL           (rx_prog_full),         // to SATA_CONTROLLER RX_PROG_FULL
+    .XFER_SECTORS           (xfer_sectors),         // sectors per READ/WRITE DMA command
+    .BUF_RX_ALLOC           (buf_rx_alloc),         // to SATA_CONTROLLER BUF_RX_ALLOC (SHARED_FIFO)
     .OOB_reset_IN           (OOB_reset_IN),
     .RX_FSM_reset_IN        (RX_FSM_reset_IN),
 		.TX_FSM_reset_IN        (TX_FSM_reset_IN)    
@@ -164,6 +174,11 @@ TEST_LOGIC TEST_LOGIC1(
   .WR_HOLD_OUT         (wr_hold_out),
   .RD_HOLD_OUT         (rd_hold_out),
   .WR_DONE             (wr_done),
+  .DEV_READY           (dev_ready),
+  .TX_PROG_FULL        (tx_prog_full),
+  .RX_PROG_FULL        (rx_prog_full),
+  .XFER_SECTORS        (xfer_sectors),
+  .BUF_RX_ALLOC        (buf_rx_alloc),
   .ADDRESS_IN          (address_in),
   .DATA_IN             (data_in),
   .DATA_OUT            (data_out),
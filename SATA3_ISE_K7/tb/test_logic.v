@@ -31,7 +31,12 @@ module TEST_LOGIC(
     input                WR_HOLD_OUT,
     input                RD_HOLD_OUT,
     input                WR_DONE,
-    input       [31:0]   DATA_OUT
+    input                DEV_READY,            // drive identified after link up (SATA_IDENTIFY)
+    input       [31:0]   DATA_OUT,
+    output      [15:0]   TX_PROG_FULL,         // transport TX FIFO threshold, 0 : build default
+    output      [15:0]   RX_PROG_FULL,         // transport RX FIFO threshold, 0 : build default
+    output      [7:0]    XFER_SECTORS,         // sectors per command, 1 - 128
+    output reg           BUF_RX_ALLOC          // shared FIFO pool to RX, changed while USR_RESET is high
   );
    
   reg      [2 :0]   state;
@@ -61,6 +66,12 @@ module TEST_LOGIC(
   reg      [1:0]    user_reset_int_count;
   reg      [31:0]   expected_data_reg;
   reg      [31:0]   read_data_reg;
+  reg               dev_ready_1;
+  reg               dev_ready_2;
+  reg      [15:0]   tx_prog_full;
+  reg      [15:0]   rx_prog_full;
+  reg      [7:0]    xfer_sectors;
+  wire     [15:0]   buffer_max;
 
   parameter      WAIT_FOR_CMD        = 3'b000;
   parameter      USER_RESET1         = 3'b001;
@@ -71,12 +82,18 @@ module TEST_LOGIC(
   parameter      FIRST_READ          = 3'b110;  
   parameter      READ_OPERATION      = 3'b111;  
 
-  parameter      BUFFER_MAX          = 16'hFFFC;
+  parameter      XFER_SECTORS_MAX    = 8'd128;        // 64 KB buffer
 
   assign MB_RD_ACK            = (mb_cs_delayed && mb_rnw_delayed);  
   assign USR_CLOCK            = MB_CLK;
   assign USR_RESET            = (MB_RESET || USR_RESET_int);
   assign SATA_CTRL_RESET_OUT  = (GTX_RESET_IN || sata_ctrl_reset_reg);
+  assign TX_PROG_FULL         = tx_prog_full;
+  assign RX_PROG_FULL         = rx_prog_full;
+  assign XFER_SECTORS         = xfer_sectors;
+
+  // last Dword address of a command, the next command starts at the next 64 KB
+  assign buffer_max           = {xfer_sectors, 9'h0} - 3'b100;
 
   assign status_reg[0]   = cmd_enable;
   assign status_reg[1]   = cmp_error;
@@ -96,6 +113,19 @@ module TEST_LOGIC(
     end
   end
   
+  //DEV_READY comes from the SATA clock domain
+  always @(posedge MB_CLK, posedge MB_RESET)
+  begin
+    if (MB_RESET) begin
+      dev_ready_1 <= 1'b 0;
+      dev_ready_2 <= 1'b 0;
+    end
+    else begin
+      dev_ready_1 <= DEV_READY;
+      dev_ready_2 <= dev_ready_1;
+    end
+  end
+  
   //Reading status reg and throughput count
   always @(posedge MB_CLK, posedge MB_RESET) 
   begin
@@ -108,6 +138,9 @@ module TEST_LOGIC(
           24'h 000000: begin
             MB_DATA_OUT <= {31'b0,sata_ctrl_reset_reg};
           end 
+          24'h 000004: begin
+            MB_DATA_OUT <= {31'b0,dev_ready_2};
+          end 
           24'h 100000: begin
             MB_DATA_OUT <= total_iteration;
           end
@@ -144,6 +177,15 @@ module TEST_LOGIC(
           24'h 10002C: begin
             MB_DATA_OUT <= read_data_reg;
           end
+          24'h 100030: begin
+            MB_DATA_OUT <= {16'b0,tx_prog_full};
+          end
+          24'h 100034: begin
+            MB_DATA_OUT <= {16'b0,rx_prog_full};
+          end
+          24'h 100038: begin
+            MB_DATA_OUT <= {24'b0,xfer_sectors};
+          end
           default: begin
             MB_DATA_OUT <= MB_DATA_OUT;
           end
@@ -163,6 +205,9 @@ module TEST_LOGIC(
       cmd_reg             <=  1'b 0;
       sata_ctrl_reset_reg <=  1'b 0;
       init_data           <= 32'b 0;
+      tx_prog_full        <= 16'h 0;
+      rx_prog_full        <= 16'h 0;
+      xfer_sectors        <= XFER_SECTORS_MAX;
     end
     else begin
       if (MB_CS && !MB_RNW) begin
@@ -179,6 +224,23 @@ module TEST_LOGIC(
           24'h 10001C: begin
             init_data       <=  MB_DATA_IN;
           end           
+          // tuning registers, only taken while no test is running
+          24'h 100030: begin
+            if (!cmd_enable) begin
+              tx_prog_full  <= MB_DATA_IN[15:0];
+            end
+          end
+          24'h 100034: begin
+            if (!cmd_enable) begin
+              rx_prog_full  <= MB_DATA_IN[15:0];
+            end
+          end
+          24'h 100038: begin
+            if (!cmd_enable) begin
+              xfer_sectors  <= (MB_DATA_IN[7:0] == 8'd0 || MB_DATA_IN[7:0] > XFER_SECTORS_MAX) ?
+                               XFER_SECTORS_MAX : MB_DATA_IN[7:0];
+            end
+          end
         endcase
       end
     end  
@@ -267,6 +329,7 @@ module TEST_LOGIC(
       state           <= WAIT_FOR_CMD;
       first_read_en   <=  1'b 0;
       USR_RESET_int   <= 1'b0;
+      BUF_RX_ALLOC    <= 1'b0;
     end
     else begin
       case (state)
@@ -276,6 +339,7 @@ module TEST_LOGIC(
             if ((cmd_reg == 4'b0001) && (total_iteration != 32'b0)) begin
               state           <= USER_RESET1;
               USR_RESET_int   <= 1'b1;
+              BUF_RX_ALLOC    <= 1'b0;
               ADDRESS_IN      <= 57'b0;
               DATA_IN         <= init_data;
               iteration_count <= 32'b 0;
@@ -322,14 +386,14 @@ module TEST_LOGIC(
         end 
         
         WRITE_OPERATION : begin
-          if (ADDRESS_IN [15:0] < BUFFER_MAX) begin            //checking buffer full during write
+          if (ADDRESS_IN [15:0] < buffer_max) begin            //checking buffer full during write
             WR_EN_IN        <=  1'b 1;
             ADDRESS_IN      <= ADDRESS_IN + 3'b 100;
             DATA_IN         <= DATA_IN + 1;
             state           <= WRITE_OPERATION;
             iteration_count <= iteration_count;
           end
-          else if (ADDRESS_IN [15:0] == BUFFER_MAX) begin      //checking buffer full during write
+          else if (ADDRESS_IN [15:0] == buffer_max) begin      //checking buffer full during write
             
             iteration_count <= iteration_count + 1;
             WR_EN_IN        <=  1'b 0;
@@ -340,7 +404,7 @@ module TEST_LOGIC(
             end
             else begin
               state           <= CHECK_WR_HOLD;
-              ADDRESS_IN      <= ADDRESS_IN + 3'b 100;
+              ADDRESS_IN      <= {ADDRESS_IN[56:16] + 1'b1, 16'h0};
               DATA_IN         <= DATA_IN +1;
             end
           end
@@ -357,6 +421,7 @@ module TEST_LOGIC(
           if(WR_DONE)begin
             state           <= USER_RESET2;
             USR_RESET_int   <= 1'b1;
+            BUF_RX_ALLOC    <= 1'b1;
           end
           else begin
             state           <= WR_DONE_CHECK;
@@ -420,12 +485,13 @@ module TEST_LOGIC(
           else if (iteration_count < total_iteration) begin
             ADDRESS_IN <= ADDRESS_IN + 3'b 100;
             state      <= READ_OPERATION;
-            if (ADDRESS_IN [15:0] == BUFFER_MAX) begin           //checking buffer full during read                
+            if (ADDRESS_IN [15:0] == buffer_max) begin           //checking buffer full during read                
+              ADDRESS_IN      <= {ADDRESS_IN[56:16] + 1'b1, 16'h0};
               RD_EN_IN        <= 1'b 1; 
               data_reg_en     <= 1'b 1;
               iteration_count <= iteration_count + 1;
             end
-            else if (ADDRESS_IN [15:0] < BUFFER_MAX) begin            
+            else if (ADDRESS_IN [15:0] < buffer_max) begin            
               RD_EN_IN        <= 1'b 1;
               data_reg_en     <= 1'b 1;
             end